@@ -0,0 +1,138 @@
+/**
+ * @file bench_harness.hpp
+ * @brief This file contains a small benchmark harness shared by the benchmark binaries.
+ * @details Each benchmark is calibrated until one batch runs long enough to time reliably,
+ * then timed over several batches, and the median is reported as one JSON object per line
+ * (or one CSV row) so results can be diffed and graphed between builds.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Benchmarking Documentation=============================================================
+// https://github.com/google/benchmark/blob/main/docs/user_guide.md#preventing-optimization |
+// ==========================================================================================
+
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+    /**
+     * @brief Options shared by every benchmark in a run.
+     */
+    struct Options {
+        bool csv = false;     // CSV rows instead of JSON lines
+        std::string filter;   // Only run benchmarks whose name contains this
+    };
+
+    /**
+     * @brief The Result struct holds the timing of one benchmark over one corpus.
+     */
+    struct Result {
+        std::string name;
+        std::string corpus;
+        uint64_t iterations = 0; // Per timed batch
+        double nsPerOp = 0.0;    // Median over the batches
+        double bytesPerOp = 0.0; // Input bytes handled per operation, 0 if not meaningful
+    };
+
+    /**
+     * @brief Keeps the compiler from optimizing away a value that is never used.
+     * @param value The value to keep.
+     */
+    template<typename T>
+    inline void doNotOptimize(const T& value) noexcept {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Constants //
+    constexpr std::chrono::milliseconds MIN_BATCH_TIME(20);
+    constexpr int BATCH_COUNT = 5;
+
+    /**
+     * @brief Parses the command line shared by every benchmark binary.
+     * @param argc The number of arguments.
+     * @param argv The arguments: `[--csv] [filter]`.
+     * @return The parsed options.
+     */
+    inline Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        for(int i = 1; i < argc; i++) {
+            std::string_view arg(argv[i]);
+            if(arg == "--csv") options.csv = true;
+            else options.filter = std::string(arg);
+        }
+        return options;
+    }
+
+    /**
+     * @brief Prints the CSV header row, if CSV output was requested.
+     * @param options The options of the run.
+     */
+    inline void printHeader(const Options& options) {
+        if(options.csv) std::printf("benchmark,corpus,iterations,ns_per_op,mb_per_s\n");
+    }
+
+    /**
+     * @brief Prints one result as a JSON line or a CSV row.
+     * @param options The options of the run.
+     * @param result The result to print.
+     */
+    inline void print(const Options& options, const Result& result) {
+        double mbPerSec = (result.bytesPerOp > 0 && result.nsPerOp > 0) ? result.bytesPerOp / result.nsPerOp * 1e3 : 0.0;
+        if(options.csv) {
+            std::printf("%s,%s,%llu,%.2f,%.2f\n", result.name.c_str(), result.corpus.c_str(),
+                        static_cast<unsigned long long>(result.iterations), result.nsPerOp, mbPerSec);
+        }
+        else {
+            std::printf("{\"benchmark\": \"%s\", \"corpus\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"mb_per_s\": %.2f}\n",
+                        result.name.c_str(), result.corpus.c_str(),
+                        static_cast<unsigned long long>(result.iterations), result.nsPerOp, mbPerSec);
+        }
+        std::fflush(stdout);
+    }
+
+    /**
+     * @brief Times a function and prints the result, unless the filter skips it.
+     * @param options The options of the run.
+     * @param name The benchmark name.
+     * @param corpus The name of the input the function runs over.
+     * @param bytesPerOp The input bytes handled per call, for throughput. 0 to report none.
+     * @param func The function to time. It is called many times.
+     */
+    template<typename Func>
+    void run(const Options& options, const std::string& name, const std::string& corpus, size_t bytesPerOp, Func&& func) {
+        if(!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+        using Clock = std::chrono::steady_clock;
+        auto timeBatch = [&](uint64_t iterations) {
+            auto start = Clock::now();
+            for(uint64_t i = 0; i < iterations; i++) func();
+            return Clock::now() - start;
+        };
+
+        // Double the batch until it is long enough to time, which also warms the caches
+        uint64_t iterations = 1;
+        while(timeBatch(iterations) < MIN_BATCH_TIME) iterations *= 2;
+
+        std::vector<double> samples;
+        for(int batch = 0; batch < BATCH_COUNT; batch++) {
+            std::chrono::duration<double, std::nano> elapsed = timeBatch(iterations);
+            samples.push_back(elapsed.count() / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        print(options, Result{name, corpus, iterations, samples[samples.size() / 2], static_cast<double>(bytesPerOp)});
+    }
+}
+
+#endif // BENCH_HARNESS_HPP
@@ -0,0 +1,389 @@
+/**
+ * @file loopback_bench.cpp
+ * @brief This file contains the loopback end-to-end throughput benchmark.
+ * @details It starts an epoll HTTP server in-process on loopback and drives the real
+ * Socket, ConnectionManager and HttpClient stack against it through the ConnectionEngine,
+ * sweeping connection counts, pipeline depths, keep-alive and body sizes. The same requests are
+ * also fanned out as coroutines on an AsyncClient.
+ * Usage: `loopback_bench [--csv] [filter]`, where the filter matches the case name.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "async_client.hpp"
+#include "bench_harness.hpp"
+#include "config.hpp"
+#include "connection_engine.hpp"
+#include "event_loop.hpp"
+#include "http_method.hpp"
+#include "http_request.hpp"
+#include "logger.hpp"
+#include "request_metrics.hpp"
+#include "socket.hpp"
+#include "task.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Globals the linked objects expect from main.cpp
+volatile std::sig_atomic_t signal_received = 0;
+volatile std::sig_atomic_t metrics_requested = 0;
+
+namespace {
+    // Constants //
+    constexpr size_t BYTES_PER_CASE = 128 * 1024 * 1024; // 128MB of bodies per case at most
+    constexpr size_t FANOUT_WINDOW = 32; // Requests awaited together by the async cases
+
+    /**
+     * @brief The MockServer class is a minimal HTTP/1.1 server on its own thread.
+     * @details A GET for `/<n>` is answered with an `n` byte body, keeping the connection
+     * alive unless the request says `Connection: close`. Responses are built once up front and
+     * queued by pointer, so the server costs as little as possible per request and the
+     * benchmark mostly measures the client.
+     */
+    class MockServer {
+    public:
+        // Constructors //
+        explicit MockServer(const std::vector<size_t>& bodySizes) : listener(AF_INET, SOCK_STREAM, 0), stopping(false) {
+            for(size_t size : bodySizes) {
+                for(bool close : {false, true}) responses[{size, close}] = buildResponse(size, close);
+            }
+            notFound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+
+            int enable = 1;
+            setsockopt(listener.get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            struct sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0; // Any free port
+            socklen_t length = sizeof(addr);
+            if(bind(listener.get(), (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener.get(), SOMAXCONN) < 0 ||
+               getsockname(listener.get(), (struct sockaddr*)&addr, &length) < 0) {
+                throw std::runtime_error("Failed to start the mock server: " + std::string(std::strerror(errno)));
+            }
+            port = ntohs(addr.sin_port);
+
+            worker = std::thread([this] { run(); });
+        }
+
+        ~MockServer() noexcept {
+            stopping.store(true, std::memory_order_relaxed);
+            if(worker.joinable()) worker.join();
+        }
+
+        MockServer(const MockServer&) = delete;
+        MockServer& operator=(const MockServer&) = delete;
+
+        // Getters //
+        uint16_t getPort() const noexcept { return port; }
+
+    private:
+        // Types //
+        struct Connection {
+            Socket socket;
+            std::string incoming;
+            std::deque<const std::string*> outgoing; // Prebuilt responses, in request order
+            size_t sentOfFront = 0;
+            bool closeAfterSend = false;
+        };
+
+        // Helpers //
+        static std::string buildResponse(size_t size, bool close) {
+            return "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: application/octet-stream\r\n"
+                   "Content-Length: " + std::to_string(size) + "\r\n" +
+                   (close ? "Connection: close\r\n" : "") +
+                   "\r\n" + std::string(size, 'b');
+        }
+
+        void run() {
+            listener.setNonBlocking(true);
+            loop.add(listener.get(), EPOLLIN, [this](uint32_t) { acceptAll(); });
+            while(!stopping.load(std::memory_order_relaxed)) loop.poll(POLL_INTERVAL_MS);
+            for(auto& [fd, connection] : connections) loop.remove(fd);
+            loop.remove(listener.get());
+        }
+
+        void acceptAll() {
+            while(true) {
+                int fd = accept4(listener.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if(fd < 0) return; // Drained, or out of descriptors until a connection closes
+
+                // Like production servers, so pipelined responses are not held back by Nagle's algorithm
+                int enable = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                auto connection = std::make_unique<Connection>(Connection{Socket(fd)});
+                connections[fd] = std::move(connection);
+                loop.add(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, [this, fd](uint32_t events) { handle(fd, events); });
+            }
+        }
+
+        void handle(int fd, uint32_t events) {
+            Connection& connection = *connections[fd];
+            bool peerClosed = (events & (EPOLLHUP | EPOLLERR)) != 0;
+
+            // Read everything, as the registration is edge-triggered
+            char chunk[16 * 1024];
+            while(!peerClosed) {
+                ssize_t bytesRead = ::recv(fd, chunk, sizeof(chunk), 0);
+                if(bytesRead > 0) connection.incoming.append(chunk, bytesRead);
+                else if(bytesRead == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) peerClosed = true;
+                else break;
+            }
+
+            // Answer every complete request, pipelined ones included
+            size_t end;
+            while(!connection.closeAfterSend && (end = connection.incoming.find("\r\n\r\n")) != std::string::npos) {
+                std::string_view head(connection.incoming.data(), end);
+                bool close = head.find("onnection: close") != std::string_view::npos;
+                size_t uri = head.find(" /");
+                size_t size = (uri == std::string_view::npos) ? 0 : std::strtoull(head.data() + uri + 2, nullptr, 10);
+                auto it = responses.find({size, close});
+                connection.outgoing.push_back((it != responses.end()) ? &it->second : &notFound);
+                connection.closeAfterSend = close;
+                connection.incoming.erase(0, end + 4);
+            }
+
+            bool healthy = flush(connection);
+            if(peerClosed || !healthy || (connection.outgoing.empty() && connection.closeAfterSend)) {
+                loop.remove(fd);
+                connections.erase(fd);
+            }
+        }
+
+        bool flush(Connection& connection) {
+            while(!connection.outgoing.empty()) {
+                const std::string& response = *connection.outgoing.front();
+                ssize_t sent = ::send(connection.socket.get(), response.data() + connection.sentOfFront,
+                                      response.size() - connection.sentOfFront, MSG_NOSIGNAL);
+                if(sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK; // Resumed on the next EPOLLOUT edge
+                connection.sentOfFront += sent;
+                if(connection.sentOfFront == response.size()) {
+                    connection.outgoing.pop_front();
+                    connection.sentOfFront = 0;
+                }
+            }
+            return true;
+        }
+
+        // Constants //
+        static constexpr int POLL_INTERVAL_MS = 20;
+
+        // Variables //
+        Socket listener;
+        EventLoop loop;
+        uint16_t port = 0;
+        std::map<std::pair<size_t, bool>, std::string> responses; // By body size and Connection: close
+        std::string notFound;
+        std::map<int, std::unique_ptr<Connection>> connections;
+        std::atomic<bool> stopping;
+        std::thread worker;
+    };
+
+    /**
+     * @brief The Case struct describes one point of the sweep.
+     */
+    struct Case {
+        size_t connections;
+        size_t pipelineDepth;
+        bool keepAlive;
+        size_t bodySize;
+
+        std::string name() const {
+            return std::string(keepAlive ? "keep-alive" : "close") + "/c" + std::to_string(connections) +
+                   "/p" + std::to_string(pipelineDepth) + "/" + std::to_string(bodySize) + "B";
+        }
+    };
+
+    /**
+     * @brief Picks how many requests a case sends, so every case moves a similar amount of data
+     * without small bodies finishing too quickly to time.
+     * @param benchCase The case.
+     * @return The number of requests.
+     */
+    size_t requestCount(const Case& benchCase) {
+        size_t byVolume = BYTES_PER_CASE / std::max<size_t>(benchCase.bodySize, 1);
+        size_t ceiling = benchCase.keepAlive ? 20000 : 2000; // Each close case reconnects per request
+        return std::clamp<size_t>(byVolume, 200, ceiling);
+    }
+
+    /**
+     * @brief Runs one case against the server and prints its throughput.
+     * @param options The options of the run.
+     * @param benchCase The case to run.
+     * @param port The port of the mock server.
+     */
+    void runCase(const bench::Options& options, const Case& benchCase, uint16_t port) {
+        std::vector<Endpoint> targets = {{"127.0.0.1", std::to_string(port)}};
+        const std::string uri = "/" + std::to_string(benchCase.bodySize);
+        const char* connectionHeader = benchCase.keepAlive ? "keep-alive" : "close";
+        size_t total = requestCount(benchCase);
+
+        // Zero threads gives one HttpClient and ConnectionManager per connection
+        ConnectionEngine engine(targets, benchCase.connections, 0, benchCase.pipelineDepth);
+        auto start = std::chrono::steady_clock::now();
+        auto results = engine.run(total, [&](const Endpoint& target, size_t) {
+            HttpRequest request;
+            request.setMethod(http::method::Method::GET)
+                   .setURI(uri)
+                   .setHeader("Host", target.ip + ":" + target.port)
+                   .setHeader("Connection", connectionHeader);
+            return request;
+        });
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        RequestMetrics metrics;
+        size_t failures = 0;
+        for(const auto& result : results) {
+            metrics.merge(result.metrics);
+            failures += result.failures;
+        }
+        const LatencyHistogram& latency = metrics.get(RequestMetrics::Phase::TOTAL);
+        double seconds = elapsed.count();
+        double reqPerSec = latency.getCount() / seconds;
+        double mbPerSec = latency.getCount() * static_cast<double>(benchCase.bodySize) / seconds / 1e6;
+        double p50 = latency.getValueAtPercentile(50.0) / 1e3;
+        double p99 = latency.getValueAtPercentile(99.0) / 1e3;
+
+        if(options.csv) {
+            std::printf("%s,%zu,%zu,%s,%zu,%llu,%zu,%.3f,%.1f,%.2f,%.1f,%.1f\n", benchCase.name().c_str(),
+                        benchCase.connections, benchCase.pipelineDepth, benchCase.keepAlive ? "true" : "false",
+                        benchCase.bodySize, static_cast<unsigned long long>(latency.getCount()), failures,
+                        seconds, reqPerSec, mbPerSec, p50, p99);
+        }
+        else {
+            std::printf("{\"benchmark\": \"loopback\", \"case\": \"%s\", \"connections\": %zu, \"pipeline\": %zu, "
+                        "\"keep_alive\": %s, \"body_bytes\": %zu, \"requests\": %llu, \"failures\": %zu, "
+                        "\"seconds\": %.3f, \"req_per_s\": %.1f, \"mb_per_s\": %.2f, \"p50_us\": %.1f, \"p99_us\": %.1f}\n",
+                        benchCase.name().c_str(), benchCase.connections, benchCase.pipelineDepth,
+                        benchCase.keepAlive ? "true" : "false", benchCase.bodySize,
+                        static_cast<unsigned long long>(latency.getCount()), failures,
+                        seconds, reqPerSec, mbPerSec, p50, p99);
+        }
+        std::fflush(stdout);
+    }
+
+
+    /**
+     * @brief Fetches a URI repeatedly, awaiting the requests one window at a time.
+     * @param client The client to send with.
+     * @param target The server.
+     * @param uri The URI to request.
+     * @param total The number of requests.
+     * @return The number of responses received.
+     */
+    Task<size_t> fanOut(AsyncClient& client, Endpoint target, std::string uri, size_t total) {
+        HttpRequest request;
+        request.setMethod(http::method::Method::GET)
+               .setURI(uri)
+               .setHeader("Host", target.ip + ":" + target.port)
+               .setHeader("Connection", "keep-alive");
+
+        size_t received = 0;
+        for(size_t first = 0; first < total; first += FANOUT_WINDOW) {
+            std::vector<Task<AsyncClient::Response>> window;
+            for(size_t i = first; i < std::min(total, first + FANOUT_WINDOW); i++) window.push_back(client.fetch(request, target));
+            for(const auto& response : co_await whenAll(std::move(window))) {
+                if(response) received++;
+            }
+        }
+        co_return received;
+    }
+
+    /**
+     * @brief Runs the keep-alive requests of a body size as coroutines on one AsyncClient and
+     * prints its throughput. Latencies are not recorded.
+     * @param options The options of the run.
+     * @param name The case name.
+     * @param bodySize The body size to request.
+     * @param port The port of the mock server.
+     */
+    void runAsyncCase(const bench::Options& options, const std::string& name, size_t bodySize, uint16_t port) {
+        Endpoint target{"127.0.0.1", std::to_string(port)};
+        size_t total = requestCount(Case{AsyncClient::DEFAULT_CONNECTIONS_PER_HOST, 1, true, bodySize});
+
+        AsyncClient client;
+        auto start = std::chrono::steady_clock::now();
+        size_t received = client.run(fanOut(client, target, "/" + std::to_string(bodySize), total));
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double seconds = elapsed.count();
+        double reqPerSec = received / seconds;
+        double mbPerSec = received * static_cast<double>(bodySize) / seconds / 1e6;
+        if(options.csv) {
+            std::printf("%s,%zu,1,true,%zu,%zu,%zu,%.3f,%.1f,%.2f,,\n", name.c_str(), AsyncClient::DEFAULT_CONNECTIONS_PER_HOST,
+                        bodySize, received, total - received, seconds, reqPerSec, mbPerSec);
+        }
+        else {
+            std::printf("{\"benchmark\": \"loopback\", \"case\": \"%s\", \"connections\": %zu, \"pipeline\": 1, "
+                        "\"keep_alive\": true, \"body_bytes\": %zu, \"requests\": %zu, \"failures\": %zu, "
+                        "\"seconds\": %.3f, \"req_per_s\": %.1f, \"mb_per_s\": %.2f}\n",
+                        name.c_str(), AsyncClient::DEFAULT_CONNECTIONS_PER_HOST, bodySize, received, total - received,
+                        seconds, reqPerSec, mbPerSec);
+        }
+        std::fflush(stdout);
+    }
+}
+
+/**
+ * @brief Runs every case of the sweep that matches the filter.
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments: `[--csv] [filter]`.
+ */
+int main(int argc, char* argv[]) {
+    bench::Options options = bench::parseOptions(argc, argv);
+    Logger::getInstance().setLogLevel(Logger::LogLevel::WARN); // Every reconnect logs at INFO
+
+    const std::vector<size_t> connectionCounts = {1, 4, 16};
+    const std::vector<size_t> pipelineDepths = {1, 8};
+    const std::vector<size_t> bodySizes = {128, 16 * 1024, 1024 * 1024};
+
+    MockServer server(bodySizes);
+    if(options.csv) std::printf("case,connections,pipeline,keep_alive,body_bytes,requests,failures,seconds,req_per_s,mb_per_s,p50_us,p99_us\n");
+
+    for(bool keepAlive : {true, false}) {
+        for(size_t bodySize : bodySizes) {
+            for(size_t connections : connectionCounts) {
+                for(size_t depth : pipelineDepths) {
+                    if(!keepAlive && depth > 1) continue; // The server closes after the first response
+                    Case benchCase{connections, depth, keepAlive, bodySize};
+                    if(!options.filter.empty() && benchCase.name().find(options.filter) == std::string::npos) continue;
+                    runCase(options, benchCase, server.getPort());
+                }
+            }
+        }
+    }
+
+    // Deeper than the engine claims from its request counter at once (64), so whole batches come from one claim
+    Case deepPipeline{4, 128, true, bodySizes.front()};
+    if(options.filter.empty() || deepPipeline.name().find(options.filter) != std::string::npos) {
+        runCase(options, deepPipeline, server.getPort());
+    }
+
+    for(size_t bodySize : bodySizes) {
+        std::string name = "async/c" + std::to_string(AsyncClient::DEFAULT_CONNECTIONS_PER_HOST) + "/" + std::to_string(bodySize) + "B";
+        if(!options.filter.empty() && name.find(options.filter) == std::string::npos) continue;
+        runAsyncCase(options, name, bodySize, server.getPort());
+    }
+    return 0;
+}
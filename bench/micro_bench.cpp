@@ -0,0 +1,313 @@
+/**
+ * @file micro_bench.cpp
+ * @brief This file contains the microbenchmarks for the parsing and encoding hot paths.
+ * @details It times response parsing, trace recording, request serialization (plain, from a prepared
+ * template and replayed from a mapped corpus), percent encoding and the header, status and method lookups over realistic inputs.
+ * Usage: `micro_bench [--csv] [filter]`.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "bench_harness.hpp"
+#include "http_client.hpp"
+#include "http_encoding.hpp"
+#include "http_method.hpp"
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "http_status.hpp"
+#include "n_utils.hpp"
+#include "prepared_request.hpp"
+#include "request_corpus.hpp"
+#include "response_parser.hpp"
+#include "trace_ring.hpp"
+
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Globals the linked objects expect from main.cpp
+volatile std::sig_atomic_t signal_received = 0;
+volatile std::sig_atomic_t metrics_requested = 0;
+
+namespace {
+    // Corpora //
+
+    struct Corpus {
+        std::string name;
+        std::string data;
+    };
+
+    /**
+     * @brief Builds a fixed-length response with typical headers.
+     * @param bodySize The size of the body.
+     * @return The raw response.
+     */
+    std::string fixedResponse(size_t bodySize) {
+        return "HTTP/1.1 200 OK\r\n"
+               "Content-Type: text/html; charset=utf-8\r\n"
+               "Content-Length: " + std::to_string(bodySize) + "\r\n"
+               "Connection: keep-alive\r\n"
+               "\r\n" + std::string(bodySize, 'x');
+    }
+
+    /**
+     * @brief Builds a response with the headers a CDN-fronted site sends (about 4KB).
+     * @return The raw response with a 1KB body.
+     */
+    std::string largeHeaderResponse() {
+        std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Date: Sun, 23 Feb 2025 12:00:00 GMT\r\n"
+                               "Content-Type: application/json; charset=utf-8\r\n"
+                               "Cache-Control: private, max-age=0, must-revalidate\r\n"
+                               "Content-Security-Policy: default-src 'self'; script-src 'self' https://cdn.example.com; "
+                               "style-src 'self' 'unsafe-inline'; img-src * data:; frame-ancestors 'none'\r\n"
+                               "Strict-Transport-Security: max-age=63072000; includeSubDomains; preload\r\n"
+                               "Vary: Accept-Encoding, Origin\r\n"
+                               "ETag: \"33a64df551425fcc55e4d42a148795d9f25f89d4\"\r\n"
+                               "Server: nginx\r\n";
+        for(int i = 0; i < 12; i++) {
+            response += "Set-Cookie: session_" + std::to_string(i) + "=" + std::string(200, 'a' + i) +
+                        "; Path=/; Secure; HttpOnly; SameSite=Lax\r\n";
+        }
+        for(int i = 0; i < 8; i++) {
+            response += "X-Trace-" + std::to_string(i) + ": " + std::string(40, '0' + i) + "\r\n";
+        }
+        response += "Content-Length: 1024\r\nConnection: keep-alive\r\n\r\n" + std::string(1024, 'x');
+        return response;
+    }
+
+    /**
+     * @brief Builds a chunked response.
+     * @param chunkCount The number of chunks.
+     * @param chunkSize The size of each chunk.
+     * @return The raw response.
+     */
+    std::string chunkedResponse(size_t chunkCount, size_t chunkSize) {
+        std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/plain\r\n"
+                               "Transfer-Encoding: chunked\r\n"
+                               "Connection: keep-alive\r\n"
+                               "\r\n";
+        char sizeLine[32];
+        std::snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", chunkSize);
+        for(size_t i = 0; i < chunkCount; i++) {
+            response += sizeLine;
+            response += std::string(chunkSize, 'y');
+            response += "\r\n";
+        }
+        response += "0\r\n\r\n";
+        return response;
+    }
+
+    std::vector<Corpus> responseCorpora() {
+        return {
+            {"small", fixedResponse(128)},
+            {"large-headers", largeHeaderResponse()},
+            {"chunked", chunkedResponse(16, 1024)},
+            {"large-body", fixedResponse(256 * 1024)}
+        };
+    }
+
+    /**
+     * @brief Builds the requests to serialize.
+     * @return Named requests.
+     */
+    std::vector<std::pair<std::string, HttpRequest>> requestCorpora() {
+        std::vector<std::pair<std::string, HttpRequest>> requests;
+
+        HttpRequest small;
+        small.setMethod(http::method::Method::GET)
+             .setURI("/index.html")
+             .setHeader("Host", "127.0.0.1:60001")
+             .setHeader("User-Agent", "HTTP Client/1.1")
+             .setHeader("Accept", "*/*")
+             .setHeader("Connection", "keep-alive");
+        requests.emplace_back("small-get", std::move(small));
+
+        HttpRequest large;
+        large.setMethod(http::method::Method::GET).setURI("/api/v2/search?q=latency%20histogram&page=3&sort=desc");
+        large.setHeader("Host", "api.example.com");
+        large.setHeader("Accept", "application/json, text/plain, */*");
+        large.setHeader("Accept-Language", "en-US,en;q=0.9");
+        large.setHeader("Authorization", "Bearer " + std::string(600, 't'));
+        large.setHeader("Cookie", std::string(1500, 'c'));
+        for(int i = 0; i < 10; i++) large.setHeader("X-Request-Field-" + std::to_string(i), std::string(32, 'a' + i));
+        requests.emplace_back("large-headers", std::move(large));
+
+        HttpRequest post;
+        post.setMethod(http::method::Method::POST).setURI("/submit");
+        post.setHeader("Host", "127.0.0.1:60001");
+        post.setHeader("Content-Type", "application/x-www-form-urlencoded");
+        post.setHeader("Content-Length", "4096");
+        post.setBody(std::string(4096, 'p'));
+        requests.emplace_back("post-4k", std::move(post));
+
+        return requests;
+    }
+
+    std::vector<Corpus> encodingCorpora() {
+        std::string mixed;
+        while(mixed.size() < 4096) mixed += "name=Jane Doe&city=New York, NY&note=50% off (today!)&path=/a/b?c=d;";
+        return {
+            {"path", "/search results/2025 report (final).pdf"},
+            {"plain", std::string(4096, 'a')},
+            {"mixed-4k", mixed}
+        };
+    }
+
+    // Benchmarks //
+
+    void benchResponseParse(const bench::Options& options) {
+        for(const auto& corpus : responseCorpora()) {
+            bench::run(options, "http_response_parse", corpus.name, corpus.data.size(), [&] {
+                HttpResponse response;
+                bench::doNotOptimize(response.parse(corpus.data));
+            });
+        }
+    }
+
+    void benchResponseParserFeed(const bench::Options& options) {
+        ResponseParser parser;
+        for(const auto& corpus : responseCorpora()) {
+            bench::run(options, "response_parser_feed", corpus.name, corpus.data.size(), [&] {
+                parser.reset();
+                bench::doNotOptimize(parser.feed(corpus.data));
+            });
+        }
+    }
+
+    void benchTraceRecord(const bench::Options& options) {
+        // Never dumped, so the path is not written
+        TraceRing& trace = TraceRing::getInstance();
+        trace.enable("micro_bench.trace");
+        ResponseParser parser;
+        RequestTiming timing;
+        timing.start = timing.sent = timing.firstByte = timing.complete = RequestTiming::Clock::now();
+        for(const auto& corpus : responseCorpora()) {
+            parser.reset();
+            parser.feed(corpus.data);
+            bench::run(options, "trace_record", corpus.name, sizeof(TraceRing::Record), [&] {
+                trace.record(timing, &parser, 1, 0);
+            });
+        }
+    }
+
+    void benchSerializeRequest(const bench::Options& options) {
+        for(const auto& [name, request] : requestCorpora()) {
+            size_t size = HttpClient::serializeRequest(request).size();
+            bench::run(options, "serialize_request", name, size, [&] {
+                bench::doNotOptimize(HttpClient::serializeRequest(request));
+            });
+        }
+    }
+
+    void benchPreparedRequest(const bench::Options& options) {
+        // The batch runner's request, rebuilt and serialized per request as before templates
+        const std::string uri = "/index.html";
+        auto build = [&] {
+            HttpRequest request;
+            request.setMethod(http::method::Method::GET)
+                   .setURI(uri)
+                   .setHeader("Host", "127.0.0.1:60001")
+                   .setHeader("User-Agent", "HTTP Client/1.1")
+                   .setHeader("Accept", "*/*")
+                   .setHeader("Connection", "keep-alive");
+            return request;
+        };
+        size_t size = HttpClient::serializeRequest(build()).size();
+        bench::run(options, "prepared_request", "build-serialize", size, [&] {
+            bench::doNotOptimize(HttpClient::serializeRequest(build()));
+        });
+
+        PreparedRequest prepared(build());
+        std::string out;
+        bench::run(options, "prepared_request", "append", size, [&] {
+            out.clear();
+            prepared.appendTo(out, uri);
+            bench::doNotOptimize(out);
+        });
+
+        struct iovec iov[PreparedRequest::MAX_IOV];
+        bench::run(options, "prepared_request", "fill-iov", size, [&] {
+            bench::doNotOptimize(prepared.fill(iov, uri));
+        });
+
+        // Replayed, the request is already serialized and only looked up in the mapping
+        const std::string path = "micro_bench.hrq";
+        RequestCorpus::Writer writer(path);
+        RequestCorpus corpus;
+        if(writer.add(HttpClient::serializeRequest(build())) && writer.finish() && corpus.load(path)) {
+            size_t next = 0;
+            bench::run(options, "prepared_request", "corpus-view", size, [&] {
+                bench::doNotOptimize(corpus.get(next++ % corpus.size()));
+            });
+        }
+        unlink(path.c_str());
+    }
+
+    void benchEncoding(const bench::Options& options) {
+        for(const auto& corpus : encodingCorpora()) {
+            bench::run(options, "encoding_encode", corpus.name, corpus.data.size(), [&] {
+                bench::doNotOptimize(http::encoding::encode(corpus.data));
+            });
+
+            std::string encoded = http::encoding::encode(corpus.data);
+            bench::run(options, "encoding_decode", corpus.name, encoded.size(), [&] {
+                bench::doNotOptimize(http::encoding::decode(encoded));
+            });
+        }
+    }
+
+    void benchParseHeaderValue(const bench::Options& options) {
+        for(const auto& corpus : responseCorpora()) {
+            if(corpus.name == "large-body") continue; // Same headers as "small"
+            std::string headers = corpus.data.substr(0, corpus.data.find("\r\n\r\n") + 4);
+            bench::run(options, "parse_header_value", corpus.name, headers.size(), [&] {
+                bench::doNotOptimize(n_utils::str_manip::parseHeaderValue(headers, "Connection"));
+            });
+        }
+    }
+
+    void benchStatusFromString(const bench::Options& options) {
+        const std::vector<std::string> codes = {"200", "204", "301", "304", "404", "500", "503", "299"};
+        size_t next = 0;
+        bench::run(options, "status_from_string", "mixed", 3, [&] {
+            bench::doNotOptimize(http::status::fromString(codes[next++ % codes.size()]));
+        });
+    }
+
+    void benchMethodFromString(const bench::Options& options) {
+        const std::vector<std::string> methods = {"GET", "POST", "PUT", "DELETE", "HEAD", "OPTIONS", "PATCH", "BREW"};
+        size_t next = 0;
+        bench::run(options, "method_from_string", "mixed", 4, [&] {
+            bench::doNotOptimize(http::method::fromString(methods[next++ % methods.size()]));
+        });
+    }
+}
+
+/**
+ * @brief Runs every microbenchmark that matches the filter.
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments: `[--csv] [filter]`.
+ */
+int main(int argc, char* argv[]) {
+    bench::Options options = bench::parseOptions(argc, argv);
+    bench::printHeader(options);
+
+    benchResponseParse(options);
+    benchResponseParserFeed(options);
+    benchTraceRecord(options);
+    benchSerializeRequest(options);
+    benchPreparedRequest(options);
+    benchEncoding(options);
+    benchParseHeaderValue(options);
+    benchStatusFromString(options);
+    benchMethodFromString(options);
+    return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file batch_runner.hpp
+ * @brief This file contains the declaration of the BatchRunner class.
+ * @details This class is responsible for driving the HttpClient without the interactive menus,
+ * so the client can be used as a load generator against a server.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include "config.hpp"
+#include "connection_engine.hpp"
+#include "request_corpus.hpp"
+#include "request_metrics.hpp"
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Forward Declarations //
+class HttpRequest;
+
+/**
+ * @brief The BatchRunner class sends a fixed number of requests built from a URI list
+ * through a ConnectionEngine, then reports throughput and latency percentiles.
+ * @details With a metrics file configured, the per-host phase histograms are also written there
+ * as JSON (or CSV for a `.csv` path) at the end of the run and on every SIGUSR1. With a rate
+ * configured, requests are sent open-loop at that rate and latency counts time spent queued.
+ * With a corpus to replay, its pre-serialized requests are sent as recorded instead.
+ */
+class BatchRunner {
+public:
+    // Constructors //
+    explicit BatchRunner(const ConfigData& config);
+
+    // Lifecycle //
+    bool run();
+
+private:
+    // Types //
+    using WorkerResult = ConnectionEngine::WorkerResult;
+
+    // Setup //
+    bool loadURIs();
+    bool loadCorpus();
+
+    // Request Building //
+    HttpRequest buildTemplate(const Endpoint& target) const;
+
+    // Reporting //
+    void printReport(const std::vector<WorkerResult>& results, std::chrono::duration<double> elapsed) const;
+    bool exportMetrics(const std::vector<WorkerResult>& results) const;
+    std::vector<RequestMetrics> mergeByTarget(const std::vector<WorkerResult>& results) const;
+    std::vector<size_t> failuresByTarget(const std::vector<WorkerResult>& results) const;
+    void writeJson(std::ostream& out, const std::vector<RequestMetrics>& perTarget, const std::vector<size_t>& failures) const;
+    void writeCsv(std::ostream& out, const std::vector<RequestMetrics>& perTarget) const;
+    std::string hostName(size_t targetIndex) const;
+
+    // Dependencies //
+    const ConfigData& config;
+
+    // Constants //
+    static constexpr const char* DEFAULT_URI = "/";
+
+    // Variables //
+    std::vector<std::string> uris;
+    RequestCorpus corpus; // Mapped for the whole run when replaying
+};
+
+#endif // BATCH_RUNNER_HPP
\ No newline at end of file
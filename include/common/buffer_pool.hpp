@@ -0,0 +1,109 @@
+/**
+ * @file buffer_pool.hpp
+ * @brief This file contains the declaration of the BufferPool and ByteBuffer classes.
+ * @details The BufferPool recycles receive buffer memory per thread, and the ByteBuffer
+ * is a growable receive buffer built on the pool's slabs.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The BufferPool class keeps freed slabs of memory so they can be reused without
+ * going back to the allocator. There is one pool per thread, so it takes no locks.
+ * @details Slab capacities are powers of two, and each size class keeps a few free slabs.
+ * Slabs are not zero-filled.
+ */
+class BufferPool {
+public:
+    // Types //
+    struct Slab {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+    };
+
+    // Singleton //
+    static BufferPool& local() {
+        thread_local BufferPool instance;
+        return instance;
+    }
+
+    // Constructors //
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Functions //
+    Slab acquire(size_t minCapacity);
+    void recycle(Slab&& slab) noexcept;
+
+    // Constants //
+    static constexpr size_t MIN_SLAB_SIZE = 16 * 1024;        // 16KB
+    static constexpr size_t MAX_POOLED_SIZE = 16 * 1024 * 1024; // 16MB, larger slabs are freed
+
+private:
+    // Constructors //
+    BufferPool() = default;
+
+    // Helpers //
+    static size_t sizeClass(size_t capacity) noexcept;
+
+    // Constants //
+    static constexpr size_t CLASS_COUNT = 11; // 16KB to 16MB
+    static constexpr size_t MAX_FREE_PER_CLASS = 8;
+
+    // Variables //
+    std::array<std::vector<Slab>, CLASS_COUNT> freeSlabs;
+};
+
+/**
+ * @brief The ByteBuffer class is a growable byte buffer for received data, backed by pooled slabs.
+ * @details Data is written straight into the free space at the end (`prepare()` then `commit()`),
+ * so nothing is copied through a temporary buffer. Consuming from the front only moves an offset,
+ * and the live bytes are moved back to the start of the slab only when more room is needed.
+ * The slab goes back to the pool of the destroying thread.
+ */
+class ByteBuffer {
+public:
+    // Constructors //
+    ByteBuffer() noexcept : start(0), finish(0) {}
+    ~ByteBuffer() noexcept { release(); }
+    ByteBuffer(ByteBuffer&& other) noexcept;
+    ByteBuffer& operator=(ByteBuffer&& other) noexcept;
+    ByteBuffer(const ByteBuffer&) = delete;
+    ByteBuffer& operator=(const ByteBuffer&) = delete;
+
+    // Getters //
+    const char* data() const noexcept { return slab.data.get() + start; }
+    size_t size() const noexcept { return finish - start; }
+    bool empty() const noexcept { return start == finish; }
+    size_t writable() const noexcept { return slab.capacity - finish; }
+    std::string_view view() const noexcept { return std::string_view(data(), size()); }
+    operator std::string_view() const noexcept { return view(); }
+
+    // Functions //
+    char* prepare(size_t minWritable);
+    void commit(size_t length) noexcept { finish += length; }
+    void append(const char* bytes, size_t length);
+    void consume(size_t length) noexcept;
+    void erase(size_t offset, size_t length) noexcept;
+    void clear() noexcept { start = finish = 0; }
+    void release() noexcept;
+
+private:
+    // Variables //
+    BufferPool::Slab slab;
+    size_t start;  // Offset of the first live byte
+    size_t finish; // Offset past the last live byte
+};
+
+#endif // BUFFER_POOL_HPP
@@ -18,13 +18,65 @@
 
 #include "logger.hpp"
 
+#include <cstddef>
 #include <string>
+#include <vector>
+
+/**
+ * @brief The Endpoint struct holds the address of a single target server.
+ */
+struct Endpoint {
+    std::string ip; // IPv4 or IPv6 address, or host name
+    std::string port;
+    bool tls = false; // Connect with HTTPS
+};
+
+/**
+ * @brief The Timeouts struct holds the deadlines of a connection, in milliseconds.
+ * @details The connect timeout is an upper limit that adapts to each server's connect times.
+ * The read timeout always applies in full.
+ */
+struct Timeouts {
+    int connectMs = 5000; // Connect, including any TLS handshake
+    int readMs = 5000;    // Waiting for a response to make progress
+    int idleMs = 15000;   // Keeping an unused keep-alive connection open
+};
 
 /**
  * @brief The ConfigData struct contains the configuration settings for the client.
  */
 struct ConfigData {
     bool debug = false;
+
+    // TLS //
+    bool tls = false;          // Use HTTPS for the interactive server and for targets without a scheme
+    bool verifyPeer = true;    // Verify server certificates and host names
+    std::string caFile;        // Extra CA certificates to trust (PEM)
+    bool ktls = false;         // Offload TLS records to the kernel when it supports them
+
+    // Response Cache //
+    bool cache = true;         // Answer repeated GETs from the cache in interactive mode
+    std::string cacheDir;      // Also keep cached responses in this directory, across runs
+
+    // Timeouts //
+    Timeouts timeouts;         // Connect, read and idle limits, for every connection
+
+    // Tracing //
+    std::string traceFile;     // Recent requests are recorded and dumped here on SIGUSR1 and at exit
+
+    // Batch Mode //
+    std::vector<Endpoint> targets; // Target servers, enables batch mode when set
+    std::string port = "60001";    // Default port for targets without one
+    std::string uriFile;           // File with one URI per line
+    std::string replayFile;        // Request corpus to replay instead of building requests from URIs
+    size_t requestCount = 0;       // Total requests to send (0 = one pass over the URIs or corpus)
+    size_t concurrency = 1;        // Number of concurrent connections
+    size_t threads = 0;            // Worker threads (0 = one per connection, or one per core when pinned)
+    bool pin = false;              // Pin each worker thread to its own CPU core
+    size_t pipelineDepth = 1;      // Requests written back-to-back per connection
+    size_t rate = 0;               // Requests per second for an open-loop run (0 = as fast as responses return)
+    bool poisson = false;          // Space open-loop arrivals as a Poisson process instead of evenly
+    std::string metricsFile;       // Latency histograms are written here (.csv for CSV, otherwise JSON)
 };
 
 /**
@@ -47,6 +99,8 @@ public:
 
     // Getters //
     bool isDebug() const noexcept { return data.debug; }
+    bool isBatch() const noexcept { return !data.targets.empty(); }
+    const ConfigData& getData() const noexcept { return data; }
     Logger::LogLevel determineLogLevel() const;
     
     // Functions //
@@ -63,6 +117,10 @@ private:
     // Parsing //
     void parseCommandLine(int argc, char* argv[]);
     void handleInvalidOption(int optopt, char* argv[]);
+    size_t parseCount(const char* arg, const std::string& option) const;
+    int parseMilliseconds(const char* arg, const std::string& option) const;
+    bool parseArrival(const char* arg) const;
+    std::vector<Endpoint> parseTargets(const std::string& hosts, const std::string& defaultPort, bool defaultTls) const;
 };
 
 #endif // CONFIG_HPP
\ No newline at end of file
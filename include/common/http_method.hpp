@@ -2,6 +2,8 @@
  * @file http_method.hpp
  * @brief This file contains constants and utility functions for 
  * working with HTTP methods.
+ * @details Method names are looked up through a constexpr perfect hash, so parsing a method
+ * costs one hash, at most one string compare, and no static initialization.
  * 
  * @author Noah Nickles
  * @date 2/2/2025
@@ -15,9 +17,9 @@
 #ifndef HTTP_METHOD_HPP
 #define HTTP_METHOD_HPP
 
-#include <string>
+#include <array>
+#include <cstddef>
 #include <string_view>
-#include <unordered_map>
 
 namespace http::method {
     enum class Method {
@@ -34,47 +36,107 @@ namespace http::method {
         INVALID
     };
 
-    inline const std::unordered_map<Method, std::string_view> METHOD_MAP {
-        {Method::GET,     "GET"},
-        {Method::POST,    "POST"},
-        {Method::PUT,     "PUT"},
-        {Method::DELETE,  "DELETE"},
-        {Method::HEAD,    "HEAD"},
-        {Method::OPTIONS, "OPTIONS"},
-        {Method::TRACE,   "TRACE"},
-        {Method::CONNECT, "CONNECT"}
+    /**
+     * @brief The name of each method, indexed by its enum value.
+     */
+    inline constexpr std::array<std::string_view, static_cast<size_t>(Method::INVALID)> METHOD_NAMES {
+        "GET",
+        "POST",
+        "PUT",
+        "DELETE",
+        "HEAD",
+        "OPTIONS",
+        "TRACE",
+        "CONNECT"
     };
 
+    namespace detail {
+        // Constants //
+        constexpr size_t HASH_SLOTS = 16;
+        constexpr size_t MIN_LENGTH = 3;
+        constexpr size_t MAX_LENGTH = 7;
+
+        /**
+         * @brief Hashes a method name. The hash has no collisions between the known methods.
+         * @param str The method name, at least two characters long.
+         * @return A slot index below `HASH_SLOTS`.
+         */
+        constexpr size_t hash(std::string_view str) noexcept {
+            return (static_cast<unsigned char>(str[0]) + static_cast<unsigned char>(str[1]) + 5 * str.size()) & (HASH_SLOTS - 1);
+        }
+
+        /**
+         * @brief Maps each hash slot to the method that hashes to it, or `Method::INVALID`.
+         */
+        inline constexpr std::array<Method, HASH_SLOTS> HASH_TABLE = [] {
+            std::array<Method, HASH_SLOTS> table{};
+            for(auto& slot : table) slot = Method::INVALID;
+            for(size_t i = 0; i < METHOD_NAMES.size(); i++) table[hash(METHOD_NAMES[i])] = static_cast<Method>(i);
+            return table;
+        }();
+
+        /**
+         * @brief Checks that no two methods share a hash slot.
+         */
+        constexpr bool isPerfect() noexcept {
+            for(size_t i = 0; i < METHOD_NAMES.size(); i++) {
+                if(HASH_TABLE[hash(METHOD_NAMES[i])] != static_cast<Method>(i)) return false;
+            }
+            return true;
+        }
+        static_assert(isPerfect(), "Method hash has collisions, adjust hash()");
+    }
+
     /**
      * @brief Converts a string to an HTTP method.
      * @param str The string to convert.
      * @return The HTTP method enum.
      */
-    inline Method fromString(const std::string_view& str) noexcept {
-        for(const auto& [method, methodStr] : METHOD_MAP) {
-            if(methodStr == str) return method;
-        }
-        return Method::INVALID;
+    constexpr Method fromString(std::string_view str) noexcept {
+        if(str.size() < detail::MIN_LENGTH || str.size() > detail::MAX_LENGTH) return Method::INVALID;
+
+        Method method = detail::HASH_TABLE[detail::hash(str)];
+        if(method == Method::INVALID || METHOD_NAMES[static_cast<size_t>(method)] != str) return Method::INVALID;
+        return method;
     }
 
     /**
-     * @brief Converts an HTTP method to a string.
-     * @param method The HTTP method to convert.
-     * @return The string representation of the method.
+     * @brief Checks if an HTTP method is valid.
+     * @param method The HTTP method to check.
+     * @return `true` if valid, `false` otherwise.
      */
-    inline const std::string toString(const Method& method) noexcept {
-        auto it = METHOD_MAP.find(method);
-        return (it != METHOD_MAP.end()) ? std::string(it->second) : "INVALID";
+    constexpr bool isValid(const Method& method) noexcept {
+        return static_cast<size_t>(method) < METHOD_NAMES.size();
     }
 
     /**
-     * @brief Checks if an HTTP method is valid.
+     * @brief Checks if an HTTP method is idempotent, so a request that may not have reached
+     * the server can safely be sent again (RFC 9110, section 9.2.2).
      * @param method The HTTP method to check.
-     * @return `true` if valid, `false` otherwise.
+     * @return `true` for GET, PUT, DELETE, HEAD, OPTIONS and TRACE, `false` otherwise.
+     */
+    constexpr bool isIdempotent(const Method& method) noexcept {
+        return isValid(method) && method != Method::POST && method != Method::CONNECT;
+    }
+
+    /**
+     * @brief Checks if an HTTP method is safe, so its request leaves the resource unchanged
+     * and cached responses for it stay valid (RFC 9110, section 9.2.1).
+     * @param method The HTTP method to check.
+     * @return `true` for GET, HEAD, OPTIONS and TRACE, `false` otherwise.
+     */
+    constexpr bool isSafe(const Method& method) noexcept {
+        return method == Method::GET || method == Method::HEAD || method == Method::OPTIONS || method == Method::TRACE;
+    }
+
+    /**
+     * @brief Converts an HTTP method to a string.
+     * @param method The HTTP method to convert.
+     * @return The string representation of the method.
      */
-    inline bool isValid(const Method& method) noexcept {
-        return METHOD_MAP.find(method) != METHOD_MAP.end();
+    constexpr std::string_view toString(const Method& method) noexcept {
+        return isValid(method) ? METHOD_NAMES[static_cast<size_t>(method)] : "INVALID";
     }
 }
 
-#endif // HTTP_METHOD_HPP
\ No newline at end of file
+#endif // HTTP_METHOD_HPP
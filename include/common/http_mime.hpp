@@ -2,6 +2,8 @@
  * @file http_mime.hpp
  * @brief This file contains constants and utility functions for 
  * working with MIME types.
+ * @details The type names are a constexpr array indexed by enum value, and extensions are
+ * found in an open-addressed hash table that is built at compile time.
  * 
  * @author Noah Nickles
  * @date 2/2/2025
@@ -11,9 +13,11 @@
 #ifndef HTTP_MIME_HPP
 #define HTTP_MIME_HPP
 
-#include <string>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string_view>
-#include <unordered_map>
 
 namespace http::mime {
     enum class Media {
@@ -61,55 +65,46 @@ namespace http::mime {
     };
 }
 
-namespace std {
+namespace http::mime {
     /**
-     * @brief The hash specialization for the http::mime::Media enum class.
-     * @details This allows the enum value to be used as a key in an unordered_map due
-     * to it being an enum class.
-     * @remark Normal enums leak their values into the surrounding scope, which can cause
-     * collisions in the hash map, so this is a safer alternative.
-     * @note Hash functions have to be defined in the std namespace.
+     * @brief The MIME type of each media, indexed by its enum value.
      */
-    template<> struct hash<http::mime::Media> {
-        size_t operator()(const http::mime::Media& c) const noexcept {
-            return static_cast<size_t>(c);
-        }
+    inline constexpr std::array<std::string_view, static_cast<size_t>(Media::INVALID)> MIME_NAMES {
+        "application/x-www-form-urlencoded",
+        "application/json",
+        "application/javascript",
+        "application/octet-stream",
+        "application/xml",
+        "application/zip",
+        "audio/mpeg",
+        "audio/ogg",
+        "audio/wav",
+        "font/otf",
+        "font/ttf",
+        "font/woff",
+        "font/woff2",
+        "image/gif",
+        "image/jpeg",
+        "image/png",
+        "image/svg+xml",
+        "image/webp",
+        "text/css",
+        "text/csv",
+        "text/html",
+        "text/plain",
+        "text/xml",
+        "video/mp4",
+        "video/mpeg",
+        "video/ogg",
+        "video/webm"
     };
-}
 
-namespace http::mime {
-    inline const std::unordered_map<Media, std::string_view> MIME_MAP {
-        {Media::APP_FORM,         "application/x-www-form-urlencoded"},
-        {Media::APP_JAVASCRIPT,   "application/javascript"},
-        {Media::APP_JSON,         "application/json"},
-        {Media::APP_OCTET_STREAM, "application/octet-stream"},
-        {Media::APP_XML,          "application/xml"},
-        {Media::APP_ZIP,          "application/zip"},
-        {Media::AUDIO_MPEG,       "audio/mpeg"},
-        {Media::AUDIO_OGG,        "audio/ogg"},
-        {Media::AUDIO_WAV,        "audio/wav"},
-        {Media::FONT_OTF,         "font/otf"},
-        {Media::FONT_TTF,         "font/ttf"},
-        {Media::FONT_WOFF,        "font/woff"},
-        {Media::FONT_WOFF2,       "font/woff2"},
-        {Media::IMAGE_GIF,        "image/gif"},
-        {Media::IMAGE_JPEG,       "image/jpeg"},
-        {Media::IMAGE_PNG,        "image/png"},
-        {Media::IMAGE_SVG_XML,    "image/svg+xml"},
-        {Media::IMAGE_WEBP,       "image/webp"},
-        {Media::TEXT_CSS,         "text/css"},
-        {Media::TEXT_CSV,         "text/csv"},
-        {Media::TEXT_HTML,        "text/html"},
-        {Media::TEXT_PLAIN,       "text/plain"},
-        {Media::TEXT_XML,         "text/xml"},
-        {Media::VIDEO_MP4,        "video/mp4"},
-        {Media::VIDEO_MPEG,       "video/mpeg"},
-        {Media::VIDEO_OGG,        "video/ogg"},
-        {Media::VIDEO_WEBM,       "video/webm"},
-        {Media::INVALID,          "Invalid"}
+    struct Extension {
+        std::string_view extension;
+        Media media;
     };
 
-    inline const std::unordered_map<std::string, Media> EXTENSION_MAP {
+    inline constexpr Extension EXTENSION_TABLE[] {
         {".bin",   Media::APP_OCTET_STREAM},
         {".css",   Media::TEXT_CSS},
         {".csv",   Media::TEXT_CSV},
@@ -140,25 +135,63 @@ namespace http::mime {
         {".zip",   Media::APP_ZIP}
     };
 
+    namespace detail {
+        // Constants //
+        constexpr size_t HASH_SLOTS = 64; // Power of two, at least twice the extension count
+        constexpr uint8_t EMPTY_SLOT = 0xFF;
+        static_assert(std::size(EXTENSION_TABLE) * 2 <= HASH_SLOTS, "Extension table is too full");
+
+        /**
+         * @brief Hashes a string with 32-bit FNV-1a.
+         * @param str The string to hash.
+         * @return The hash.
+         */
+        constexpr uint32_t hash(std::string_view str) noexcept {
+            uint32_t hash = 2166136261u;
+            for(char c : str) hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+            return hash;
+        }
+
+        /**
+         * @brief Maps hash slots to entries of `EXTENSION_TABLE`, or `EMPTY_SLOT`.
+         * Collisions are resolved by probing the following slots.
+         */
+        inline constexpr std::array<uint8_t, HASH_SLOTS> HASH_TABLE = [] {
+            std::array<uint8_t, HASH_SLOTS> table{};
+            for(auto& slot : table) slot = EMPTY_SLOT;
+            for(size_t i = 0; i < std::size(EXTENSION_TABLE); i++) {
+                size_t slot = hash(EXTENSION_TABLE[i].extension) & (HASH_SLOTS - 1);
+                while(table[slot] != EMPTY_SLOT) slot = (slot + 1) & (HASH_SLOTS - 1);
+                table[slot] = static_cast<uint8_t>(i);
+            }
+            return table;
+        }();
+    }
+
     /**
      * @brief Converts a MIME type to a string.
      * @param mime The MIME type to convert.
      * @return The string representation of the MIME type.
      */
-    inline std::string toString(Media mime) noexcept {
-        auto it = MIME_MAP.find(mime);
-        return (it != MIME_MAP.end()) ? std::string(it->second) : "Invalid";
+    constexpr std::string_view toString(Media mime) noexcept {
+        size_t index = static_cast<size_t>(mime);
+        return (index < MIME_NAMES.size()) ? MIME_NAMES[index] : "Invalid";
     }
 
     /**
      * @brief Converts a file extension to a MIME type.
-     * @param extension The file extension to convert.
+     * @param extension The file extension to convert, including the leading '.'.
      * @return The MIME type.
      */
-    inline Media fromExtension(const std::string& extension) noexcept {
-        auto it = EXTENSION_MAP.find(extension);
-        return (it != EXTENSION_MAP.end()) ? it->second : Media::INVALID;
+    constexpr Media fromExtension(std::string_view extension) noexcept {
+        size_t slot = detail::hash(extension) & (detail::HASH_SLOTS - 1);
+        while(detail::HASH_TABLE[slot] != detail::EMPTY_SLOT) {
+            const Extension& entry = EXTENSION_TABLE[detail::HASH_TABLE[slot]];
+            if(entry.extension == extension) return entry.media;
+            slot = (slot + 1) & (detail::HASH_SLOTS - 1);
+        }
+        return Media::INVALID;
     }
 }
 
-#endif // HTTP_MIME_HPP
\ No newline at end of file
+#endif // HTTP_MIME_HPP
@@ -2,6 +2,8 @@
  * @file http_status.hpp
  * @brief This file contains constants and utility functions for 
  * working with HTTP status codes.
+ * @details The reason phrases live in a constexpr table indexed directly by code value,
+ * so lookups need no static initialization and no hashing.
  * 
  * @author Noah Nickles
  * @date 2/2/2025
@@ -15,10 +17,12 @@
 #ifndef HTTP_STATUS_HPP
 #define HTTP_STATUS_HPP
 
-#include <functional>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 
 namespace http::status {
     enum class Code {
@@ -95,24 +99,13 @@ namespace http::status {
     };
 }
 
-namespace std {
-    /**
-     * @brief The hash specialization for the http::status::Code enum class.
-     * @details This allows the enum value to be used as a key in an unordered_map due
-     * to it being an enum class.
-     * @remark Normal enums leak their values into the surrounding scope, which can cause
-     * collisions in the hash map, so this is a safer alternative.
-     * @note Hash functions have to be defined in the std namespace.
-     */
-    template<> struct hash<http::status::Code> {
-        size_t operator()(const http::status::Code& c) const noexcept {
-            return static_cast<size_t>(c);
-        }
+namespace http::status {
+    struct Reason {
+        Code code;
+        std::string_view phrase;
     };
-}
 
-namespace http::status {
-    inline const std::unordered_map<Code, std::string_view> REASON_MAP {
+    inline constexpr Reason REASON_TABLE[] {
         // 1xx Informational
         {Code::CONTINUE, "Continue"},
         {Code::SWITCHING_PROTOCOLS, "Switching Protocols"},
@@ -185,43 +178,47 @@ namespace http::status {
         {Code::INVALID, "Invalid"}
     };
 
+    // Constants //
+    constexpr int MAX_CODE = 599;
+    constexpr uint8_t NO_REASON = 0xFF;
+    static_assert(std::size(REASON_TABLE) < NO_REASON, "REASON_INDEX entries must fit in a byte");
+
+    /**
+     * @brief Maps every code value from 0 to `MAX_CODE` straight to its entry in `REASON_TABLE`,
+     * or to `NO_REASON` if it is not a known status.
+     */
+    inline constexpr std::array<uint8_t, MAX_CODE + 1> REASON_INDEX = [] {
+        std::array<uint8_t, MAX_CODE + 1> index{};
+        for(auto& slot : index) slot = NO_REASON;
+        for(size_t i = 0; i < std::size(REASON_TABLE); i++) index[static_cast<int>(REASON_TABLE[i].code)] = static_cast<uint8_t>(i);
+        return index;
+    }();
+
     /**
      * @brief Converts an HTTP status code to a string.
      * @param code The HTTP status code to convert.
-     * @return The string representation of the status code.
+     * @return The reason phrase of the status code.
      */
-    inline std::string toString(Code code) noexcept {
-        auto it = REASON_MAP.find(code);
-        return (it != REASON_MAP.end()) ? std::string(it->second) : "Invalid";
+    constexpr std::string_view toString(Code code) noexcept {
+        int value = static_cast<int>(code);
+        if(value < 0 || value > MAX_CODE || REASON_INDEX[value] == NO_REASON) return "Invalid";
+        return REASON_TABLE[REASON_INDEX[value]].phrase;
     }
 
     /**
      * @brief Converts an HTTP status code string to its corresponding enum.
-     * @param str The HTTP status code string.
-     * @return The corresponding HTTP status code enum.
+     * @param str The HTTP status code string, one to three decimal digits.
+     * @return The corresponding HTTP status code enum, or `Code::INVALID` if it is not a known code.
      */
-    inline Code fromString(const std::string& str) noexcept {
-        int codeValue;
-        try {
-            codeValue = std::stoi(str);
-        }
-        catch(const std::invalid_argument& ia) {
-            return Code::INVALID;
-        } 
-        catch(const std::out_of_range& oor) {
-            return Code::INVALID;
+    constexpr Code fromString(std::string_view str) noexcept {
+        if(str.empty() || str.size() > 3) return Code::INVALID;
+
+        int value = 0;
+        for(char c : str) {
+            if(c < '0' || c > '9') return Code::INVALID;
+            value = value * 10 + (c - '0');
         }
-        
-        static const std::unordered_map<int, Code> reverseMap = [] {
-            std::unordered_map<int, Code> map;
-            for(const auto& pair : REASON_MAP) {
-                map.emplace(static_cast<int>(pair.first), pair.first);
-            }
-            return map;
-        }();
-
-        auto it = reverseMap.find(codeValue);
-        return (it != reverseMap.end()) ? it->second : Code::INVALID;
+        return (value <= MAX_CODE && REASON_INDEX[value] != NO_REASON) ? REASON_TABLE[REASON_INDEX[value]].code : Code::INVALID;
     }
 
     /**
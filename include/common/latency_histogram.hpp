@@ -0,0 +1,79 @@
+/**
+ * @file latency_histogram.hpp
+ * @brief This file contains the declaration of the LatencyHistogram class.
+ * @details It is a fixed-size, log-linear histogram of durations in the style of
+ * HdrHistogram, so percentiles cost nothing to record and no samples are kept.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief The LatencyHistogram class counts durations in nanoseconds into log-linear buckets.
+ * @details Values below 128ns are counted exactly. Above that, every power of two is split into
+ * 64 buckets, so a reported value is never more than 1/64 (about 1.6%) above the true one.
+ * Values past about 18 minutes land in the last bucket.
+ *
+ * Each histogram has a single writer and takes no locks. Counters are relaxed atomics that the
+ * writer updates with a plain load and store, so other threads can read a snapshot while it records.
+ */
+class LatencyHistogram {
+public:
+    // Constructors //
+    LatencyHistogram();
+    LatencyHistogram(LatencyHistogram&& other) noexcept;
+    LatencyHistogram& operator=(LatencyHistogram&&) = delete;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Getters //
+    uint64_t getCount() const noexcept { return count.load(std::memory_order_relaxed); }
+    uint64_t getMin() const noexcept { return getCount() ? min.load(std::memory_order_relaxed) : 0; }
+    uint64_t getMax() const noexcept { return max.load(std::memory_order_relaxed); }
+    double getMean() const noexcept;
+    uint64_t getValueAtPercentile(double pct) const noexcept;
+
+    // Functions //
+    void record(uint64_t nanoseconds) noexcept;
+    void record(std::chrono::steady_clock::duration duration) noexcept;
+    void merge(const LatencyHistogram& other) noexcept;
+    void localize();
+
+private:
+    // Types //
+    using Counter = std::atomic<uint64_t>;
+
+    // Helpers //
+    static size_t bucketIndex(uint64_t value) noexcept;
+    static uint64_t bucketUpperBound(size_t index) noexcept;
+    static void add(Counter& counter, uint64_t amount) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // Constants //
+    static constexpr unsigned SUB_BUCKET_BITS = 6;
+    static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;      // Buckets per power of two
+    static constexpr size_t LINEAR_BUCKETS = 2 * SUB_BUCKETS;                // Exact buckets for 0-127
+    static constexpr unsigned FIRST_EXPONENT = SUB_BUCKET_BITS + 1;          // 2^7 = 128ns
+    static constexpr unsigned LAST_EXPONENT = 39;                            // 2^40ns is about 18 minutes
+    static constexpr size_t BUCKET_COUNT = LINEAR_BUCKETS + (LAST_EXPONENT - FIRST_EXPONENT + 1) * SUB_BUCKETS;
+
+    // Variables //
+    std::unique_ptr<Counter[]> buckets;
+    Counter count;
+    Counter sum;
+    Counter min;
+    Counter max;
+};
+
+#endif // LATENCY_HISTOGRAM_HPP
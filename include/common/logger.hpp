@@ -12,12 +12,25 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <iosfwd>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 /**
  * @brief The Logger class is a singleton class that provides logging functionality.
+ * @details By default every message is written and flushed before `log()` returns. In async mode,
+ * each thread formats its messages into its own lock-free ring, and a background writer drains
+ * the rings and writes them in batches, so logging never waits on the terminal.
+ * The level and async flag that every call reads sit on cache lines no lock writes to, so
+ * filtered or queued messages touch nothing shared between threads.
  */
 class Logger {
 public:
@@ -36,31 +49,87 @@ public:
     }
 
     // Constructors //
+    ~Logger() noexcept { stopAsync(); }
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
     // Getters //
-    LogLevel getLogLevel() const noexcept { return currentLevel; }
+    LogLevel getLogLevel() const noexcept { return currentLevel.load(std::memory_order_relaxed); }
+    bool isEnabled(const LogLevel& level) const noexcept { return level >= getLogLevel(); }
 
     // Setters //
-    void setLogLevel(const LogLevel& level) noexcept { currentLevel = level; }
-    
+    void setLogLevel(const LogLevel& level) noexcept { currentLevel.store(level, std::memory_order_relaxed); }
+
+    // Lifecycle //
+    void startAsync();
+    void stopAsync() noexcept;
+
     // Logging //
     void log(std::string_view message, const LogLevel& level) noexcept;
     void log(std::string_view message, const LogLevel& level, std::ostream& out) noexcept;
     void print(std::string_view message) noexcept;
 
+    /**
+     * @brief Logs a message that is only built if the level is enabled.
+     * @param level The log level of the message.
+     * @param makeMessage Returns the message. Not called when the level is filtered out.
+     */
+    template<typename MessageFactory, typename = std::enable_if_t<std::is_invocable_v<MessageFactory&>>>
+    void log(const LogLevel& level, MessageFactory&& makeMessage) noexcept {
+        if(!isEnabled(level)) return;
+        try {
+            log(std::string_view(makeMessage()), level);
+        }
+        catch(...) {} // Logging must never throw
+    }
+
     // Helpers //
     std::string toString(const LogLevel& level) noexcept;
     LogLevel toEnum(const std::string& level) noexcept;
 
 private:
+    // Types //
+    struct Entry {
+        std::string line;
+        bool toError = false; // std::cerr instead of std::cout
+    };
+
+    /**
+     * @brief Single producer, single consumer ring of formatted lines. One per logging thread.
+     */
+    struct Ring {
+        Ring() : slots(RING_CAPACITY), head(0), tail(0) {}
+        std::vector<Entry> slots;
+        alignas(64) std::atomic<size_t> head; // Next slot to drain, written by the writer thread
+        alignas(64) std::atomic<size_t> tail; // Next slot to fill, written by the owning thread
+    };
+
     // Constructors //
-    Logger(LogLevel level = LogLevel::INFO) noexcept : currentLevel(level) {};
-    
+    Logger(LogLevel level = LogLevel::INFO) noexcept : currentLevel(level), asyncEnabled(false), writerRunning(false) {};
+
+    // Helpers //
+    std::string formatLine(std::string_view message, const LogLevel& level) const;
+    static std::string_view cachedTimestamp() noexcept;
+    void enqueue(std::string&& line, bool toError) noexcept;
+    Ring* localRing();
+    bool drain();
+    void runWriter();
+
+    // Constants //
+    static constexpr size_t RING_CAPACITY = 4096; // Must be a power of two
+    static constexpr int FLUSH_INTERVAL_MS = 10;
+
     // Variables //
-    std::mutex logMutex;
-    LogLevel currentLevel;
+    alignas(64) std::atomic<LogLevel> currentLevel; // Read by every log call, so kept off the lines that are written
+    alignas(64) std::mutex logMutex;
+
+    // Async Variables //
+    std::atomic<bool> asyncEnabled;
+    std::atomic<bool> writerRunning;
+    std::thread writer;
+    alignas(64) std::mutex ringsMutex; // Guards `rings` while threads register, not the rings themselves
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::condition_variable wakeWriter;
 };
 
-#endif // LOGGER_HPP
\ No newline at end of file
+#endif // LOGGER_HPP
@@ -19,6 +19,7 @@
 #include <iomanip>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <sstream>
 
 namespace n_utils {
@@ -120,6 +121,23 @@ namespace n_utils {
             return std::nullopt;
         }
 
+        /**
+         * @brief Compares two strings ignoring ASCII case, without allocating.
+         * @param a The first string.
+         * @param b The second string.
+         * @return `true` if the strings are equal ignoring case, otherwise `false`.
+         */
+        inline bool iequals(std::string_view a, std::string_view b) noexcept {
+            if(a.size() != b.size()) return false;
+            for(size_t i = 0; i < a.size(); i++) {
+                char ca = a[i], cb = b[i];
+                if(ca >= 'A' && ca <= 'Z') ca += 'a' - 'A';
+                if(cb >= 'A' && cb <= 'Z') cb += 'a' - 'A';
+                if(ca != cb) return false;
+            }
+            return true;
+        }
+
         /**
          * @brief Converts a string to lowercase.
          * @param str The string to convert.
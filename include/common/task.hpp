@@ -0,0 +1,187 @@
+/**
+ * @file task.hpp
+ * @brief This file contains the Task coroutine type and the whenAll() combinator.
+ * @details A Task is a lazily started coroutine whose result is awaited by another coroutine,
+ * or collected with `AsyncClient::run()` at the top level.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Coroutine Documentation================================================
+// https://en.cppreference.com/w/cpp/language/coroutines                  |
+// https://lewissbaker.github.io/2020/05/11/understanding_symmetric_transfer |
+// ========================================================================
+
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Forward Declarations //
+template<typename T> class Task;
+
+namespace detail {
+    /**
+     * @brief The promise parts every Task shares: who to resume when it finishes, and its exception.
+     */
+    struct TaskPromiseBase {
+        /**
+         * @brief Resumes the awaiting coroutine, if any, directly from the final suspend point.
+         * @note Symmetric transfer keeps long chains of completions from growing the stack.
+         */
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                std::coroutine_handle<> continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+        std::coroutine_handle<> continuation; // Resumed once the task finishes
+        std::exception_ptr exception;
+        bool started = false;
+    };
+
+    /**
+     * @brief The promise of a Task that produces a value.
+     */
+    template<typename T>
+    struct TaskPromise : TaskPromiseBase {
+        Task<T> get_return_object() noexcept;
+        template<typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+        T take() {
+            if(exception) std::rethrow_exception(exception);
+            return std::move(*value);
+        }
+
+        std::optional<T> value;
+    };
+
+    /**
+     * @brief The promise of a Task that produces nothing.
+     */
+    template<>
+    struct TaskPromise<void> : TaskPromiseBase {
+        Task<void> get_return_object() noexcept;
+        void return_void() const noexcept {}
+        void take() const {
+            if(exception) std::rethrow_exception(exception);
+        }
+    };
+}
+
+/**
+ * @brief The Task class is a coroutine that produces a `T` (or nothing for `void`).
+ * @details Tasks start lazily: the body runs once the task is awaited or `start()`ed, up to its
+ * first suspension. Starting several tasks before awaiting any of them lets them run concurrently,
+ * which is what `whenAll()` does. A task is owned by one Task object and awaited at most once.
+ * An exception thrown in the body is rethrown to the awaiting coroutine.
+ * @note Destroying a task that is suspended mid-request abandons it, so keep tasks alive until they finish.
+ */
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    // Types //
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /**
+     * @brief Suspends the awaiting coroutine until the task finishes, starting the task if needed.
+     */
+    struct Awaiter {
+        Handle handle;
+
+        bool await_ready() const noexcept { return handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            promise_type& promise = handle.promise();
+            promise.continuation = awaiting;
+            if(promise.started) return std::noop_coroutine(); // Already running, it resumes us when done
+            promise.started = true;
+            return handle;
+        }
+        T await_resume() { return handle.promise().take(); }
+    };
+
+    // Constructors //
+    explicit Task(Handle handle) noexcept : handle(handle) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if(this != &other) {
+            if(handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() noexcept {
+        if(handle) handle.destroy();
+    }
+
+    // Getters //
+    bool done() const noexcept { return !handle || handle.done(); }
+
+    // Functions //
+
+    /**
+     * @brief Runs the task up to its first suspension without waiting for it.
+     */
+    void start() {
+        if(!handle || handle.promise().started) return;
+        handle.promise().started = true;
+        handle.resume();
+    }
+
+    /**
+     * @brief Takes the result of a finished task.
+     * @return The value the task returned.
+     * @throws Whatever the task threw.
+     */
+    T result() { return handle.promise().take(); }
+
+    // Operators //
+    Awaiter operator co_await() && noexcept { return Awaiter{handle}; }
+    Awaiter operator co_await() & noexcept { return Awaiter{handle}; }
+
+private:
+    // Variables //
+    Handle handle;
+};
+
+namespace detail {
+    template<typename T>
+    Task<T> TaskPromise<T>::get_return_object() noexcept { return Task<T>(Task<T>::Handle::from_promise(*this)); }
+
+    inline Task<void> TaskPromise<void>::get_return_object() noexcept { return Task<void>(Task<void>::Handle::from_promise(*this)); }
+}
+
+/**
+ * @brief Runs tasks concurrently and collects their results.
+ * @details Every task is started first, so all of them are in flight before the first is awaited.
+ * @param tasks The tasks, which must produce a value.
+ * @return A task producing the results, in the order of `tasks`.
+ */
+template<typename T>
+Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks) {
+    for(auto& task : tasks) task.start();
+
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for(auto& task : tasks) results.push_back(co_await task);
+    co_return results;
+}
+
+#endif // TASK_HPP
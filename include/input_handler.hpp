@@ -50,6 +50,7 @@ private:
         ENTER_PORT,
         ENTER_URI,
         ENTER_POST_BODY,
+        ENTER_DOWNLOAD,
         EXIT
     };
     void switchToState(const InputState& state);
@@ -74,9 +75,10 @@ private:
     bool readPort();
     bool readURI();
     bool readPostBody();
+    bool readDownload();
 
     // Input Validators //
-    bool checkValidIP(const std::string& ip);
+    bool checkValidHost(const std::string& host);
     bool checkValidPort(const std::string& port);
     bool checkValidURI(const std::string& uri);
 
@@ -88,10 +90,10 @@ private:
     void quickConnect();
     void clearConnection();
     bool checkConnection();
-    bool sendAndValidate(const http::method::Method& method, const std::string& uri, const std::string& body = "");
+    bool sendAndValidate(const http::method::Method& method, const std::string& uri, std::string body = "");
 
     // Request Building //
-    HttpRequest buildRequest(const http::method::Method& method, const std::string& uri, const std::string& body) const;
+    HttpRequest buildRequest(const http::method::Method& method, const std::string& uri, std::string body) const;
 
     // Dependencies //
     HttpClient& client;
@@ -0,0 +1,94 @@
+/**
+ * @file content_decoder.hpp
+ * @brief This file contains the declaration of the ContentDecoder class.
+ * @details It removes the content coding (gzip, deflate or Brotli) of a response body
+ * piece by piece, as the body arrives.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Content Coding Documentation=====================================================
+// https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Content-Encoding       |
+// https://www.rfc-editor.org/rfc/rfc9110#name-content-codings                      |
+// https://www.zlib.net/manual.html                                                 |
+// https://github.com/google/brotli/blob/master/c/include/brotli/decode.h           |
+// ==================================================================================
+
+#ifndef CONTENT_DECODER_HPP
+#define CONTENT_DECODER_HPP
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Forward Declarations //
+struct BrotliDecoderStateStruct;
+
+/**
+ * @brief The ContentDecoder class decompresses one body at a time, without buffering it whole.
+ * @details Each call to `decode()` takes the next piece of the encoded body and hands the decoded
+ * bytes on in pieces of at most `OUTPUT_SIZE`, so a highly compressed body never needs more memory
+ * than that. The zlib stream is reset rather than freed between bodies.
+ *
+ * "deflate" is meant to be zlib-wrapped, but some servers send a raw deflate stream; the first
+ * bytes tell which. Concatenated gzip members are decoded one after another.
+ */
+class ContentDecoder {
+public:
+    // Types //
+    enum class Coding {
+        IDENTITY,
+        GZIP,
+        DEFLATE,
+        BROTLI,
+
+        // Unknown coding, or several
+        UNSUPPORTED
+    };
+    using Output = std::function<void(std::string_view data)>;
+
+    // Constants //
+    static constexpr std::string_view ACCEPTED = "gzip, deflate, br"; // Accept-Encoding value
+    static constexpr size_t OUTPUT_SIZE = 16 * 1024; // 16KB
+
+    // Constructors //
+    ContentDecoder() noexcept;
+    ~ContentDecoder() noexcept;
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+    // Getters //
+    bool isActive() const noexcept { return coding != Coding::IDENTITY; }
+    bool isFinished() const noexcept { return finished; } // The whole encoded stream was decoded
+    size_t getDecodedSize() const noexcept { return decodedSize; }
+
+    // Functions //
+    bool begin(Coding coding);
+    bool decode(std::string_view input, const Output& output, std::string& kept);
+    void reset() noexcept;
+    static Coding parseCoding(std::string_view contentEncoding) noexcept;
+
+private:
+    // Helpers //
+    bool inflateZlib(std::string_view input, const Output& output, std::string& kept);
+    bool decodeBrotli(std::string_view input, const Output& output, std::string& kept);
+    void emit(size_t length, const Output& output, std::string& kept);
+
+    // Variables //
+    Coding coding;
+    z_stream zlib;
+    bool zlibReady;         // `zlib` holds an initialized stream
+    bool probing;           // No deflate bytes decoded yet, so it may still be raw deflate
+    BrotliDecoderStateStruct* brotli;
+    bool finished;
+    size_t decodedSize;
+    std::unique_ptr<char[]> buffer; // OUTPUT_SIZE bytes, allocated with the first body
+};
+
+#endif // CONTENT_DECODER_HPP
@@ -0,0 +1,75 @@
+/**
+ * @file http_headers.hpp
+ * @brief This file contains the declaration of the HttpHeaders class.
+ * @details It is a flat, insertion-ordered header container with inline storage for a
+ * typical message's headers and case-insensitive lookups that never allocate.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef HTTP_HEADERS_HPP
+#define HTTP_HEADERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The HttpHeaders class holds the headers of an HTTP message in the order they were set.
+ * @details Names keep the case they were set with and are compared ignoring ASCII case.
+ * The first `INLINE_CAPACITY` headers live inside the object, and more spill into a vector.
+ * Cleared slots keep their strings, so refilling a container reuses their memory.
+ */
+class HttpHeaders {
+public:
+    // Types //
+    struct Header {
+        std::string name;
+        std::string value;
+    };
+    using const_iterator = const Header*;
+
+    // Constants //
+    static constexpr size_t INLINE_CAPACITY = 12;
+
+    // Constructors //
+    HttpHeaders() noexcept = default;
+    HttpHeaders(const HttpHeaders& other);
+    HttpHeaders(HttpHeaders&& other) noexcept;
+    HttpHeaders& operator=(const HttpHeaders& other);
+    HttpHeaders& operator=(HttpHeaders&& other) noexcept;
+
+    // Getters //
+    std::optional<std::string_view> get(std::string_view name) const noexcept;
+    bool contains(std::string_view name) const noexcept { return indexOf(name) < count; }
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    const_iterator begin() const noexcept { return slots(); }
+    const_iterator end() const noexcept { return slots() + count; }
+
+    // Setters //
+    void set(std::string_view name, std::string_view value);
+    void add(std::string_view name, std::string_view value);
+    bool remove(std::string_view name) noexcept;
+    void clear() noexcept { count = 0; }
+
+private:
+    // Helpers //
+    Header* slots() noexcept { return spilled.empty() ? inlineSlots.data() : spilled.data(); }
+    const Header* slots() const noexcept { return spilled.empty() ? inlineSlots.data() : spilled.data(); }
+    size_t capacity() const noexcept { return spilled.empty() ? INLINE_CAPACITY : spilled.size(); }
+    size_t indexOf(std::string_view name) const noexcept;
+    Header& nextSlot();
+
+    // Variables //
+    std::array<Header, INLINE_CAPACITY> inlineSlots;
+    std::vector<Header> spilled; // Every slot once the inline ones run out, all constructed
+    size_t count = 0;
+};
+
+#endif // HTTP_HEADERS_HPP
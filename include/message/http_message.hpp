@@ -2,6 +2,8 @@
  * @file http_message.hpp
  * @brief This file contains the declaration of the HttpMessage class.
  * @details It is an abstract class that represents an HTTP message.
+ * Getters return views into the message, and the start line is composed whenever one
+ * of its parts changes, so reading a message never allocates.
  * 
  * @author Noah Nickles
  * @date 2/2/2025
@@ -11,12 +13,12 @@
 #ifndef HTTP_MESSAGE_HPP
 #define HTTP_MESSAGE_HPP
 
-#include "n_utils.hpp"
+#include "http_headers.hpp"
 
 #include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 
 /**
  * @brief This class is an abstract class that represents an HTTP message.
@@ -28,43 +30,38 @@ public:
     virtual ~HttpMessage() noexcept = default;
 
     // Getters //
-    std::string getVersion() const noexcept { return version; }
-    std::optional<std::string> getHeader(std::string_view key) const {
-        std::string lowerKey(key);
-        lowerKey = n_utils::str_manip::toLower(lowerKey);
-        auto it = headers.find(lowerKey);
-        if(it != headers.end()) return it->second;
-        return std::nullopt;
-    }
-    const std::unordered_map<std::string, std::string>& getAllHeaders() const noexcept { return headers; }
-    std::string getBody() const noexcept { return body; }
+    std::string_view getVersion() const noexcept { return version; }
+    std::string_view getStatusLine() const noexcept { return startLine; }
+    std::optional<std::string_view> getHeader(std::string_view key) const noexcept { return headers.get(key); }
+    const HttpHeaders& getAllHeaders() const noexcept { return headers; }
+    std::string_view getBody() const noexcept { return body; }
 
     // Setters //
-    void setVersion(std::string_view version) noexcept { this->version = version; }
+    void setVersion(std::string_view version) {
+        this->version = version;
+        composeStartLine();
+    }
     HttpMessage& setHeader(std::string_view key, std::string_view value) {
-        std::string lowerKey(key);
-        lowerKey = n_utils::str_manip::toLower(lowerKey);
-        headers[lowerKey] = value;
+        headers.set(key, value);
         return *this;
     }
-    bool removeHeader(std::string_view key) { 
-        std::string lowerKey(key);
-        lowerKey = n_utils::str_manip::toLower(lowerKey);
-        return headers.erase(lowerKey) > 0;
-    }
-    HttpMessage& setBody(std::string_view body) noexcept { 
-        this->body = body;
+    bool removeHeader(std::string_view key) noexcept { return headers.remove(key); }
+    HttpMessage& setBody(std::string body) noexcept {
+        this->body = std::move(body); // Takes ownership, so pass an rvalue to avoid a copy
         return *this;
     }
 
     // Interface //
-    virtual std::string getStatusLine() const noexcept = 0;
     virtual void display() const = 0;
 
 protected:
+    // Interface //
+    virtual void composeStartLine() = 0; // Rebuilds startLine from its parts
+
     // Variables //
     std::string version;
-    std::unordered_map<std::string, std::string> headers;
+    std::string startLine; // Request or status line, without the CRLF
+    HttpHeaders headers;
     std::string body;
 };
 
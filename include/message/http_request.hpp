@@ -22,6 +22,8 @@
 #include "http_method.hpp"
 
 #include <string>
+#include <string_view>
+#include <utility>
 
 /**
  * @brief Represents an HTTP request.
@@ -29,28 +31,42 @@
  */
 class HttpRequest : public HttpMessage {
 public:
+    // Constructors //
+    HttpRequest() { composeStartLine(); }
+
     // Getters //
-    std::string getMethod() const noexcept { return method; }
-    std::string getURI() const noexcept { return uri; }
+    std::string_view getMethod() const noexcept { return method; }
+    std::string_view getURI() const noexcept { return uri; }
+    const std::string& getBodyFile() const noexcept { return bodyFile; }
 
     // Setters //
     HttpRequest& setMethod(const http::method::Method& method) { 
         this->method = http::method::toString(method); 
+        composeStartLine();
+        return *this;
+    }
+    HttpRequest& setURI(std::string uri) {
+        this->uri = std::move(uri); 
+        composeStartLine();
         return *this;
     }
-    HttpRequest& setURI(const std::string& uri) {
-        this->uri = uri; 
+    HttpRequest& setBodyFile(std::string path) {
+        this->bodyFile = std::move(path); // Sent in place of the body, straight from the file
         return *this;
     }
     
     // Overrides //
-    std::string getStatusLine() const noexcept override;
     void display() const override;
 
+protected:
+    // Overrides //
+    void composeStartLine() override;
+
 private:
     // Variables //
     std::string method;
     std::string uri;
+    std::string bodyFile;
 };
 
 #endif // HTTP_REQUEST_HPP
\ No newline at end of file
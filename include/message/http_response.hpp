@@ -14,9 +14,13 @@
 #include "http_message.hpp"
 #include "http_status.hpp"
 
+#include <optional>
 #include <string>
 #include <string_view>
 
+// Forward Declarations //
+class ResponseParser;
+
 /**
  * @brief Represents an HTTP response.
  * @note Inherits from HttpMessage.
@@ -24,24 +28,30 @@
 class HttpResponse : public HttpMessage {
 public:
     // Constructors //
-    HttpResponse() noexcept;
+    HttpResponse();
 
     // Getters //
     http::status::Code getStatus() const noexcept { return status; }
     bool isKeepAlive() const noexcept { return keepAlive; }
     
     // Setters //
-    HttpResponse& setStatus(http::status::Code status) noexcept {
+    HttpResponse& setStatus(http::status::Code status) {
         this->status = status;
+        composeStartLine();
         return *this;
     }
 
     // Overrides //
-    std::string getStatusLine() const noexcept override;
     void display() const override;
 
     // Functions //
     bool parse(std::string_view rawData);
+    bool parse(const ResponseParser& parser);
+    static std::optional<size_t> messageLength(std::string_view rawData);
+
+protected:
+    // Overrides //
+    void composeStartLine() override;
 
 private:
     // Variables //
@@ -49,9 +59,6 @@ private:
     bool keepAlive;
 
     // Functions //
-    bool parseStartLine(std::string_view line);
-    void parseHeaders(std::string_view headersBlock);
-    bool parseBody(std::string_view rawData, const size_t& bodyStart);
     void determineKeepAlive();
 };
 
@@ -0,0 +1,62 @@
+/**
+ * @file prepared_request.hpp
+ * @brief This file contains the declaration of the PreparedRequest class.
+ * @details It serializes the constant part of a request once, so requests that only
+ * differ by URI (and optionally one header) can be sent without rebuilding them.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef PREPARED_REQUEST_HPP
+#define PREPARED_REQUEST_HPP
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Forward Declarations //
+class HttpRequest;
+
+/**
+ * @brief The PreparedRequest class holds the wire bytes of a request template.
+ * @details The template's request line is split around its URI, and its headers and body are
+ * serialized up front. Per send, only the URI and the value of the variable header (if one was
+ * named) are filled in, either as iovecs pointing into the template or appended to a buffer.
+ * The template's own URI and variable header value are not used.
+ */
+class PreparedRequest {
+public:
+    // Constants //
+    static constexpr size_t MAX_IOV = 7;
+
+    // Constructors //
+    explicit PreparedRequest(const HttpRequest& base, std::string_view variableHeader = {});
+
+    // Getters //
+    bool isPipelinable() const noexcept { return pipelinable; }
+    bool isIdempotent() const noexcept { return idempotent; }
+    bool hasVariableHeader() const noexcept { return !headerPrefix.empty(); }
+
+    // Functions //
+    int fill(struct iovec (&iov)[MAX_IOV], std::string_view uri, std::string_view headerValue = {}) const noexcept;
+    void appendTo(std::string& out, std::string_view uri, std::string_view headerValue = {}) const;
+    size_t size(std::string_view uri, std::string_view headerValue = {}) const noexcept;
+
+private:
+    // Helpers //
+    std::string_view headerEnd(std::string_view headerValue) const noexcept;
+
+    // Variables //
+    std::string prefix;       // Method and space, up to the URI
+    std::string suffix;       // Version and constant headers, plus the blank line without a variable header
+    std::string headerPrefix; // "Name: " of the variable header, empty if there is none
+    std::string body;
+    bool pipelinable;
+    bool idempotent;
+};
+
+#endif // PREPARED_REQUEST_HPP
@@ -0,0 +1,127 @@
+/**
+ * @file request_corpus.hpp
+ * @brief This file contains the declaration of the RequestCorpus class.
+ * @details The RequestCorpus class memory-maps a file of pre-serialized requests so captured
+ * traffic can be replayed straight from the page cache, without parsing or copying it.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Mmap Man Pages===========================================
+// https://man7.org/linux/man-pages/man2/mmap.2.html       |
+// https://man7.org/linux/man-pages/man2/madvise.2.html    |
+// ==========================================================
+
+#ifndef REQUEST_CORPUS_HPP
+#define REQUEST_CORPUS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The RequestCorpus class gives the wire bytes of each request in a corpus file, as
+ * views into a read-only mapping of it.
+ * @details A corpus is a FileHeader, the serialized requests back-to-back, padding to 8 bytes,
+ * then `count + 1` offsets of where each request starts in the data, the last being its end.
+ * Loading only checks the header and the ends of the offset table, so it takes the same time
+ * whatever the size of the file; pages are read in as requests are first sent. Offsets are
+ * clamped to the data when read rather than checked up front, so a damaged file sends garbage
+ * instead of reading outside the mapping. Requests are stored in order, so any run of them is
+ * one contiguous range that can be written in a single send. Files are in the host's byte
+ * order and are written with the Writer, as `corpus_build` does from access logs.
+ */
+class RequestCorpus {
+public:
+    // Types //
+    enum Flag : uint16_t {
+        PIPELINABLE = 1 << 0 // Every request is a GET
+    };
+
+    /**
+     * @brief The start of a corpus file.
+     */
+    struct FileHeader {
+        char magic[4];     // "HRQC"
+        uint16_t version;
+        uint16_t flags;    // Flag bits, worked out by the Writer
+        uint64_t count;    // Requests in the file
+        uint64_t dataSize; // Bytes of serialized requests
+    };
+
+    /**
+     * @brief The Writer class builds a corpus file one serialized request at a time.
+     * @details Requests are written as they are added and only their offsets are kept in memory.
+     * The file is written next to its final path and renamed over it by `finish()`, so a reader
+     * never maps a half written corpus; an unfinished one is removed.
+     */
+    class Writer {
+    public:
+        // Constructors //
+        explicit Writer(std::string path);
+        ~Writer() noexcept;
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // Getters //
+        size_t size() const noexcept { return offsets.size() - 1; }
+
+        // Functions //
+        bool add(std::string_view request);
+        bool finish();
+
+    private:
+        // Variables //
+        std::string path;
+        std::string temporary;
+        std::ofstream file;
+        std::vector<uint64_t> offsets; // Of every request added, and of the end of the data
+        uint16_t flags;
+        bool finished;
+    };
+
+    // Constants //
+    static constexpr uint16_t FORMAT_VERSION = 1;
+
+    // Constructors //
+    RequestCorpus() noexcept;
+    ~RequestCorpus() noexcept;
+    RequestCorpus(const RequestCorpus&) = delete;
+    RequestCorpus& operator=(const RequestCorpus&) = delete;
+
+    // Getters //
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    bool isPipelinable() const noexcept { return flags & PIPELINABLE; }
+    std::string_view get(size_t index) const noexcept { return span(index, index + 1); }
+    std::string_view span(size_t first, size_t last) const noexcept { // Requests [first, last), back-to-back
+        uint64_t end = std::min(offsets[last], dataSize);
+        uint64_t begin = std::min(offsets[first], end);
+        return std::string_view(data + begin, end - begin);
+    }
+
+    // Functions //
+    bool load(const std::string& path);
+
+private:
+    // Helpers //
+    void unmap() noexcept;
+    static constexpr uint64_t padded(uint64_t size) noexcept { return (size + 7) & ~uint64_t(7); }
+
+    // Variables //
+    void* mapping;
+    size_t mappingSize;
+    const char* data;         // The first request
+    const uint64_t* offsets;  // `count + 1` of them, into `data`
+    size_t count;
+    uint64_t dataSize;
+    uint16_t flags;
+};
+
+#endif // REQUEST_CORPUS_HPP
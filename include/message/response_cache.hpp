@@ -0,0 +1,133 @@
+/**
+ * @file response_cache.hpp
+ * @brief This file contains the declaration of the ResponseCache class.
+ * @details It keeps responses to GET requests so repeated requests for an unchanged
+ * resource are answered locally, or revalidated without moving the body again.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =HTTP Caching Documentation======================================
+// https://developer.mozilla.org/en-US/docs/Web/HTTP/Caching       |
+// https://www.rfc-editor.org/rfc/rfc9111                          |
+// https://www.rfc-editor.org/rfc/rfc9110#name-conditional-requests |
+// https://man7.org/linux/man-pages/man2/mmap.2.html               |
+// =================================================================
+
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include "http_response.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// Forward Declarations //
+class HttpRequest;
+
+/**
+ * @brief The ResponseCache class is a private (single user) HTTP cache with LRU eviction.
+ * @details Responses are keyed by "host:port" and URI, and kept fresh for their `max-age`, their
+ * `Expires` date or, with only a `Last-Modified` date, a tenth of their age (capped at a day).
+ * A stale response with an `ETag` or `Last-Modified` date is kept so the next request can be made
+ * conditional; a 304 then refreshes it in place. `no-store` responses are never kept, and
+ * `no-cache` ones are revalidated on every use. Once the bodies and headers held exceed the
+ * capacity, the least recently used responses are dropped.
+ *
+ * With a disk directory set, every stored response is also written there, one file per key, and
+ * responses missing from memory are read back with `mmap()`, so the cache survives restarts.
+ * Bodies are stored decoded and framed by a Content-Length, however they arrived.
+ * @note Like HttpClient, a ResponseCache belongs to a single thread and does no locking.
+ */
+class ResponseCache {
+public:
+    // Types //
+    using Clock = std::chrono::system_clock; // HTTP dates are wall-clock times
+
+    /**
+     * @brief A stored response and when it needs revalidating.
+     */
+    struct Entry {
+        HttpResponse response;
+        Clock::time_point stored;  // When the response, or its last 304, was received
+        Clock::time_point expires; // Fresh until then
+        bool noCache = false;      // Revalidated before every use
+        size_t size = 0;           // Bytes counted against the capacity
+
+        bool isFresh(Clock::time_point now) const noexcept { return !noCache && now < expires; }
+        bool hasValidators() const noexcept { return response.getHeader("ETag") || response.getHeader("Last-Modified"); }
+    };
+
+    // Constants //
+    static constexpr size_t DEFAULT_CAPACITY = 32 * 1024 * 1024; // 32MB
+    static constexpr long HEURISTIC_LIMIT_S = 24 * 60 * 60;      // 1 day, the longest guessed lifetime
+
+    // Constructors //
+    explicit ResponseCache(size_t capacity = DEFAULT_CAPACITY);
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    // Getters //
+    size_t size() const noexcept { return entries.size(); }
+    size_t getMemoryUsed() const noexcept { return memoryUsed; }
+    size_t getCapacity() const noexcept { return capacity; }
+
+    // Setters //
+    void setDiskDirectory(const std::string& path);
+
+    // Functions //
+    const Entry* lookup(const std::string& key);
+    bool store(const std::string& key, HttpResponse response, Clock::time_point now = Clock::now());
+    const Entry* freshen(const std::string& key, const HttpResponse& notModified, Clock::time_point now = Clock::now());
+    void remove(const std::string& key);
+    void clear() noexcept;
+    static std::string keyOf(const std::string& host, const std::string& port, std::string_view uri);
+    static bool isCacheable(const HttpRequest& request) noexcept;
+    static void addValidators(const Entry& entry, HttpRequest& request);
+
+private:
+    // Types //
+    using LruList = std::list<std::pair<std::string, Entry>>; // Most recently used first
+
+    /**
+     * @brief The Cache-Control directives this cache acts on.
+     */
+    struct Directives {
+        bool noStore = false;
+        bool noCache = false;
+        std::optional<long> maxAge; // Seconds
+    };
+
+    // Helpers //
+    const Entry* insert(const std::string& key, Entry entry);
+    void evict(LruList::iterator it) noexcept;
+    static void computeFreshness(Entry& entry);
+    static Directives parseDirectives(const HttpResponse& response);
+    static std::optional<Clock::time_point> parseDate(std::string_view text) noexcept;
+    static std::optional<long> parseSeconds(std::string_view text) noexcept;
+    static bool isHeuristicallyCacheable(http::status::Code status) noexcept;
+    static size_t sizeOf(const HttpResponse& response) noexcept;
+
+    // Disk Store //
+    std::string pathOf(const std::string& key) const;
+    void writeToDisk(const std::string& key, const Entry& entry) const;
+    std::optional<Entry> readFromDisk(const std::string& key) const;
+
+    // Variables //
+    LruList order;
+    std::unordered_map<std::string, LruList::iterator> entries;
+    size_t capacity;
+    size_t maxEntrySize; // Larger responses are not stored, so one cannot flush the others
+    size_t memoryUsed;
+    std::string diskDirectory; // Empty when responses are only kept in memory
+};
+
+#endif // RESPONSE_CACHE_HPP
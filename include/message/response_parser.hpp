@@ -0,0 +1,148 @@
+/**
+ * @file response_parser.hpp
+ * @brief This file contains the declaration of the ResponseParser class.
+ * @details It is a resumable HTTP response parser that works directly on a receive
+ * buffer owned by the connection, without copying the response.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =HTTP Message Framing Documentation==========================================
+// https://developer.mozilla.org/en-US/docs/Web/HTTP/Messages                  |
+// https://www.rfc-editor.org/rfc/rfc9112#name-message-body-length             |
+// =============================================================================
+
+#ifndef RESPONSE_PARSER_HPP
+#define RESPONSE_PARSER_HPP
+
+#include "buffer_pool.hpp"
+#include "content_decoder.hpp"
+#include "http_status.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The ResponseParser class incrementally parses one HTTP response.
+ * @details The caller owns the receive buffer. Each call to `feed()` passes the whole response
+ * received so far (the previous window plus any new bytes, which may have moved in memory), and
+ * parsing resumes where it stopped. Headers are stored as offsets, so every getter returns a
+ * `std::string_view` into the most recently fed window and nothing is copied. The views are only
+ * valid until the buffer is modified.
+ *
+ * Chunked bodies are decoded as they arrive. With a body sink set, every piece of the body is handed
+ * to the sink instead of being kept, and `releaseBody()` lets the caller drop the delivered bytes from
+ * its buffer, so a body of any size streams through a buffer of bounded size.
+ *
+ * A gzip, deflate or Brotli Content-Encoding is removed the same way, piece by piece, so the sink
+ * and `getBody()` only ever see the decoded body. Unknown or stacked codings are left as they are.
+ */
+class ResponseParser {
+public:
+    // Types //
+    enum class State {
+        START_LINE,
+        HEADERS,
+        BODY,             // Reading a Content-Length body
+        BODY_UNTIL_CLOSE, // Body ends when the connection closes
+        CHUNK_SIZE,       // Reading a chunk size line
+        CHUNK_DATA,
+        CHUNK_DATA_END,   // Expecting the CRLF after a chunk
+        TRAILERS,         // Reading trailer fields after the last chunk
+        COMPLETE,
+        INVALID
+    };
+    using BodySink = std::function<void(std::string_view data)>;
+
+    // Constructors //
+    ResponseParser() noexcept;
+
+    // Lifecycle //
+    void reset() noexcept;
+    State feed(std::string_view window);
+    State finish() noexcept;
+    size_t releaseBody(ByteBuffer& buffer) noexcept;
+    void skipBody(size_t length) noexcept;
+
+    // Setters //
+    void setBodySink(BodySink sink) { this->sink = std::move(sink); }
+
+    // Getters //
+    State getState() const noexcept { return state; }
+    bool isComplete() const noexcept { return state == State::COMPLETE; }
+    bool hasError() const noexcept { return state == State::INVALID; }
+    bool headersComplete() const noexcept { return state != State::START_LINE && state != State::HEADERS && state != State::INVALID; }
+    std::string_view getError() const noexcept { return error; }
+
+    http::status::Code getStatus() const noexcept { return status; }
+    std::string_view getVersion() const noexcept { return view(version); }
+    std::string_view getReason() const noexcept { return view(reason); }
+    std::optional<std::string_view> getHeader(std::string_view name) const noexcept;
+    size_t getHeaderCount() const noexcept { return headers.size(); }
+    std::string_view getHeaderName(size_t index) const noexcept { return view(headers[index].name); }
+    std::string_view getHeaderValue(size_t index) const noexcept { return view(headers[index].value); }
+    std::string_view getBody() const noexcept;
+    size_t getMessageSize() const noexcept { return messageEnd; }
+    size_t getHeaderSize() const noexcept { return bodyStart; } // Status line and headers, once parsed
+    size_t getBodyBytes() const noexcept { return bodyBytes; }  // Body received so far, as sent
+    bool isKeepAlive() const noexcept;
+    bool isChunked() const noexcept { return chunked; }
+    bool isDecoded() const noexcept { return decoder.isActive(); } // A content coding is being removed
+    size_t getDecodedSize() const noexcept { return decoder.getDecodedSize(); }
+    size_t getBodyRemaining() const noexcept { return (state == State::BODY) ? bodyRemaining : 0; }
+
+private:
+    // Types //
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+    struct HeaderSpan {
+        Span name;
+        Span value;
+    };
+
+    // Parsing //
+    bool parseStartLine(std::string_view line);
+    bool parseHeader(std::string_view line, size_t lineOffset);
+    void beginBody();
+    void beginDecoding();
+    bool parseChunkSize(std::string_view line);
+    bool deliver(size_t offset, size_t length);
+    void complete(size_t end) noexcept;
+    State invalid(std::string_view reason) noexcept;
+
+    // Helpers //
+    std::string_view view(const Span& span) const noexcept { return window.substr(span.offset, span.length); }
+
+    // Constants //
+    static constexpr size_t MAX_HEADER_BYTES = 64 * 1024; // 64KB
+    static constexpr size_t MAX_CHUNK_LINE = 1024;
+
+    // Variables //
+    std::string_view window;
+    State state;
+    size_t scanPos;
+    std::string_view error;
+    Span version;
+    Span reason;
+    http::status::Code status;
+    std::vector<HeaderSpan> headers; // Keeps its capacity across responses
+    size_t bodyStart;
+    size_t bodyRemaining; // Bytes left in the Content-Length body or the current chunk
+    size_t bodyBytes;     // Body bytes delivered or skipped, before decoding, without chunk framing
+    size_t messageEnd;
+    bool chunked;
+    bool closeDelimited;     // The body ran until the server closed the connection
+    std::string decodedBody; // Chunked or encoded body without a sink, keeps its capacity across responses
+    ContentDecoder decoder;  // Removes the Content-Encoding, keeps its zlib state across responses
+    BodySink sink;           // Kept across responses until replaced
+};
+
+#endif // RESPONSE_PARSER_HPP
\ No newline at end of file
@@ -0,0 +1,154 @@
+/**
+ * @file async_client.hpp
+ * @brief This file contains the declaration of the AsyncClient class.
+ * @details This class turns requests into awaitable responses, multiplexing them over a
+ * few connections per server on a single EventLoop.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef ASYNC_CLIENT_HPP
+#define ASYNC_CLIENT_HPP
+
+#include "async_connection.hpp"
+#include "config.hpp"
+#include "event_loop.hpp"
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "task.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The AsyncClient class sends requests from coroutines and resumes them with the responses.
+ * @details `fetch()` returns a Task that completes with the response, or `std::nullopt` if the
+ * request failed. Up to `connectionsPerHost` requests to one server are in flight at once, each on
+ * its own keep-alive connection; the rest wait for a connection to free up. Nothing happens until
+ * `run()` drives the event loop, which returns once the given task finishes:
+ *
+ *     Task<void> page(AsyncClient& client, Endpoint server) {
+ *         std::vector<Task<AsyncClient::Response>> parts;
+ *         for(auto& uri : uris) parts.push_back(client.fetch(makeRequest(uri), server));
+ *         for(auto& response : co_await whenAll(std::move(parts))) ...
+ *     }
+ *     client.run(page(client, server));
+ *
+ * Coroutines are resumed from `run()`, after the event loop has dispatched, never from inside a
+ * connection's callback, so they may start further requests freely.
+ * @note Like EventLoop, an AsyncClient belongs to a single thread. Request bodies are sent from
+ * memory; a body file is not supported.
+ */
+class AsyncClient {
+public:
+    // Types //
+    using Response = std::optional<HttpResponse>;
+
+    // Constants //
+    static constexpr size_t DEFAULT_CONNECTIONS_PER_HOST = 6; // As browsers do
+
+    // Constructors //
+    explicit AsyncClient(size_t connectionsPerHost = DEFAULT_CONNECTIONS_PER_HOST);
+    ~AsyncClient() noexcept;
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    // Getters //
+    size_t getInFlight() const noexcept { return inFlight; }
+
+    // Setters //
+    void setTimeouts(const Timeouts& limits) noexcept { timeouts = limits; } // For connections opened after the call
+
+    // Functions //
+    Task<Response> fetch(HttpRequest request, Endpoint target);
+    template<typename T>
+    T run(Task<T> task);
+    void close() noexcept;
+
+private:
+    // Types //
+    struct Host;
+
+    /**
+     * @brief Suspends a `fetch()` until its response is in.
+     */
+    class ResponseAwaiter {
+    public:
+        ResponseAwaiter(AsyncClient& client, Host& host, std::string requestData) noexcept
+            : client(client), host(host), requestData(std::move(requestData)) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        Response await_resume() noexcept { return std::move(response); }
+
+    private:
+        friend class AsyncClient;
+
+        // Variables //
+        AsyncClient& client;
+        Host& host;
+        std::string requestData;
+        Response response;
+        std::coroutine_handle<> waiter;
+    };
+
+    /**
+     * @brief The connections to one server, and the requests waiting for one of them.
+     */
+    struct Host {
+        Endpoint target; // Referenced by its connections, so a Host never moves
+        std::vector<std::unique_ptr<AsyncConnection>> connections;
+        std::deque<ResponseAwaiter*> waiting;
+    };
+
+    // Helpers //
+    Host& hostFor(const Endpoint& target);
+    void submit(ResponseAwaiter& awaiter);
+    void dispatch(AsyncConnection& connection, ResponseAwaiter& awaiter);
+    static ResponseAwaiter* nextWaiting(Host& host) noexcept;
+    void finish(ResponseAwaiter& awaiter, Response response);
+    void step();
+    void resumeReady();
+
+    // Constants //
+    static constexpr int POLL_INTERVAL_MS = 100; // How often timeouts are checked while waiting
+
+    // Variables //
+    EventLoop loop;
+    size_t connectionsPerHost;
+    Timeouts timeouts;
+    std::unordered_map<std::string, std::unique_ptr<Host>> hosts; // By scheme and authority
+    std::vector<std::coroutine_handle<>> ready; // Coroutines whose responses are in, resumed by run()
+    size_t inFlight; // Requests submitted and not yet finished
+};
+
+// Template Functions //
+
+/**
+ * @brief Runs a task to completion, driving the event loop while it waits on responses.
+ * @param task The task. It is started here if it was not already.
+ * @return The value the task returned.
+ * @throws Whatever the task threw, or std::logic_error if it waits on something other than this client.
+ */
+template<typename T>
+T AsyncClient::run(Task<T> task) {
+    task.start();
+    while(true) {
+        resumeReady();
+        if(task.done()) break;
+        if(inFlight == 0) throw std::logic_error("AsyncClient::run() task is waiting with no request in flight.");
+        step();
+    }
+    return task.result();
+}
+
+#endif // ASYNC_CLIENT_HPP
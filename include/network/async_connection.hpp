@@ -0,0 +1,126 @@
+/**
+ * @file async_connection.hpp
+ * @brief This file contains the declaration of the AsyncConnection class.
+ * @details This class is a per-connection state machine driven by an EventLoop, so a
+ * single thread can keep many requests in flight on many sockets.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef ASYNC_CONNECTION_HPP
+#define ASYNC_CONNECTION_HPP
+
+#include "buffer_pool.hpp"
+#include "config.hpp"
+#include "host_timeouts.hpp"
+#include "request_metrics.hpp"
+#include "resolver.hpp"
+#include "response_parser.hpp"
+#include "socket.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Forward Declarations //
+class EventLoop;
+
+/**
+ * @brief The AsyncConnection class sends requests over a non-blocking socket and reports each
+ * response through a completion handler, reacting only to EventLoop readiness.
+ * @details The connection is opened on the first request and reused while the server keeps it alive.
+ * For a TLS target, the handshake runs in non-blocking steps between the connect and the first send.
+ * Several serialized requests can be started at once to pipeline them; the handler then runs once per
+ * response, in order, and the last call may start the next request on the same connection.
+ * Requests are either handed over in a string the connection keeps, or borrowed from memory the
+ * caller keeps valid until the last response, such as a mapped RequestCorpus, and sent from there.
+ * The connect deadline adapts to the connect times seen on the connection, within the configured
+ * limit, while reads get the whole configured read timeout and responses much slower than usual
+ * are logged. An idle connection is closed after the idle timeout. After a failed connect, the next batch waits out a jittered reconnect delay first.
+ */
+class AsyncConnection {
+public:
+    // Types //
+    enum class State {
+        DISCONNECTED,
+        CONNECTING,
+        HANDSHAKING,
+        IDLE,
+        SENDING,
+        RECEIVING
+    };
+    using CompletionHandler = std::function<void(AsyncConnection& connection, bool success)>;
+
+    // Constructors //
+    AsyncConnection(EventLoop& loop, const Endpoint& target);
+    ~AsyncConnection() noexcept;
+    AsyncConnection(const AsyncConnection&) = delete;
+    AsyncConnection& operator=(const AsyncConnection&) = delete;
+
+    // Getters //
+    State getState() const noexcept { return state; }
+    bool isBusy() const noexcept { return state != State::DISCONNECTED && state != State::IDLE; }
+    const Endpoint& getTarget() const noexcept { return target; }
+    const ResponseParser& getResponse() const noexcept { return parser; } // Valid until the handler returns or starts a new request
+    size_t getOutstanding() const noexcept { return outstanding; }
+    const RequestTiming& getTiming() const noexcept { return timing; } // Phases of the response passed to the handler
+    uint32_t getConnectionId() const noexcept { return connectionId; } // Of the last socket opened, kept after it closes
+
+    // Setters //
+    void setBodySink(ResponseParser::BodySink sink) { parser.setBodySink(std::move(sink)); }
+    void setTimeouts(const Timeouts& limits) noexcept { timeouts.setLimits(limits); }
+
+    // Functions //
+    bool start(std::string requestData, size_t responseCount, CompletionHandler handler);
+    bool start(std::string_view requestData, size_t responseCount, CompletionHandler handler);
+    void close() noexcept;
+    void checkTimeout(std::chrono::steady_clock::time_point now);
+
+private:
+    // State Machine //
+    bool begin(std::string_view requestData, size_t responseCount, CompletionHandler handler);
+    void connect();
+    void connectNext();
+    void beginTls();
+    void sendOrWait();
+    void markConnected();
+    void handleEvents(uint32_t events);
+    bool flushWrites();
+    void readResponse();
+    void complete(bool success);
+    void fail(const std::string& reason);
+
+    // Dependencies //
+    EventLoop& loop;
+    const Endpoint& target;
+    std::unique_ptr<Socket> socket;
+
+    // Constants //
+    static constexpr size_t READ_SIZE = 16 * 1024; // 16KB, the least free space offered to recv()
+
+    // Variables //
+    State state;
+    Resolver::Result addresses; // Of the target, tried in order until one connects
+    size_t nextAddress;
+    std::string outgoing;   // Owns the requests passed as a string
+    std::string_view sending; // The requests being sent, in `outgoing` or borrowed
+    size_t bytesSent;
+    ByteBuffer incoming;
+    size_t consumed;        // Length of the response at the front of `incoming` already handed out
+    size_t outstanding; // Responses still expected for the current batch
+    uint32_t connectionId;
+    bool peerClosed;
+    bool awaitingFirstByte; // No response byte of the current batch has arrived yet
+    ResponseParser parser;
+    CompletionHandler onComplete;
+    std::chrono::steady_clock::time_point lastActivity;
+    RequestTiming timing; // Started with each batch, response points cleared per response
+    HostTimeouts timeouts; // Adapted to this connection's round trips
+};
+
+#endif // ASYNC_CONNECTION_HPP
\ No newline at end of file
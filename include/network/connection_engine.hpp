@@ -0,0 +1,147 @@
+/**
+ * @file connection_engine.hpp
+ * @brief This file contains the declaration of the ConnectionEngine class.
+ * @details This class is responsible for opening several connections to one or more
+ * servers and spreading requests across them from a pool of worker threads.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef CONNECTION_ENGINE_HPP
+#define CONNECTION_ENGINE_HPP
+
+#include "config.hpp"
+#include "rate_scheduler.hpp"
+#include "request_metrics.hpp"
+
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Externs //
+extern volatile std::sig_atomic_t signal_received;
+extern volatile std::sig_atomic_t metrics_requested;
+
+// Forward Declarations //
+class HttpRequest;
+class PreparedRequest;
+class RequestCorpus;
+
+/**
+ * @brief The ConnectionEngine class spreads requests across many connections from a pool of
+ * worker threads. Nothing on the send/receive path is shared between workers, so it takes no locks.
+ * @details Connections are assigned to targets round-robin and every connection pulls the next
+ * request index from a shared atomic counter until the workload is exhausted. With one thread per
+ * connection, each worker owns an HttpClient and ConnectionManager pair. With fewer threads than
+ * connections, each worker runs an EventLoop that multiplexes its share of AsyncConnections.
+ * With a pipeline depth above one, each connection claims that many requests at a time and
+ * writes them back-to-back before reading the responses.
+ * Requests either come from a factory that builds each one, from one PreparedRequest per
+ * target with only the URI filled in per request, or from a RequestCorpus replayed in order,
+ * request index `i` sending corpus request `i % size`. Corpus requests are written straight
+ * from the mapping, a pipelined batch as the one contiguous range it lies in; only a batch
+ * that wraps around the end of the corpus is copied.
+ *
+ * With a rate set, the run is open-loop instead: every worker runs an EventLoop, and a
+ * RateScheduler releases its share of the rate on a timer whether or not earlier responses are
+ * in. Each arrival goes to an idle connection, or waits for one (pipelining up to the depth), and
+ * its total latency is measured from when it was due, so time spent queued is counted.
+ *
+ * Closed-loop workers claim request indices from the shared counter in chunks, so it is touched
+ * once per chunk rather than once per request; chunks shrink as the run nears its end, so small
+ * runs still spread over every worker. Open-loop workers take one index per arrival. Pinned, each worker is bound to its own CPU core and
+ * builds its loop, connections, buffers and histograms after pinning, so that memory comes from
+ * the core's NUMA node; nothing but the counter is written by more than one worker.
+ *
+ * Every worker records into its own metrics, one set per target, so recording takes no locks.
+ * While the workers run, the calling thread hands the results to a snapshot handler whenever
+ * `metrics_requested` is set (by SIGUSR1).
+ */
+class ConnectionEngine {
+public:
+    // Types //
+    using RequestFactory = std::function<HttpRequest(const Endpoint& target, size_t index)>;
+    using URIFactory = std::function<std::string_view(size_t index)>;
+
+    struct alignas(64) WorkerResult { // One per worker thread and target it serves, on cache lines of its own
+        size_t targetIndex = 0;
+        RequestMetrics metrics;          // Phases of every successful request
+        std::atomic<size_t> failures{0}; // Atomic so snapshots can read it mid-run
+    };
+    using SnapshotHandler = std::function<void(const std::vector<WorkerResult>& results)>;
+
+    // Constructors //
+    ConnectionEngine(const std::vector<Endpoint>& targets, size_t connections, size_t threads = 0, size_t pipelineDepth = 1);
+
+    // Setters //
+    void setPinned(bool enable) noexcept { pinned = enable; }
+    void setTimeouts(const Timeouts& limits) noexcept { timeouts = limits; }
+    void setRate(double requestsPerSecond, RateScheduler::Arrival arrival = RateScheduler::Arrival::CONSTANT) noexcept {
+        rate = requestsPerSecond;
+        this->arrival = arrival;
+    }
+
+    // Functions //
+    std::vector<WorkerResult> run(size_t totalRequests, const RequestFactory& factory, const SnapshotHandler& onSnapshot = nullptr);
+    std::vector<WorkerResult> run(
+        size_t totalRequests,
+        const std::vector<PreparedRequest>& prepared,
+        const URIFactory& uriFor,
+        const SnapshotHandler& onSnapshot = nullptr
+    );
+    std::vector<WorkerResult> run(size_t totalRequests, const RequestCorpus& corpus, const SnapshotHandler& onSnapshot = nullptr);
+
+    // Helpers //
+    static std::vector<int> usableCpus();
+
+private:
+    // Types //
+    struct Workload { // A factory, a template per target and the URI of each request, or a corpus
+        const RequestFactory* factory = nullptr;
+        const std::vector<PreparedRequest>* prepared = nullptr;
+        const URIFactory* uriFor = nullptr;
+        const RequestCorpus* corpus = nullptr;
+    };
+    struct Claim { // Request indices a worker has claimed and not yet sent
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    // Workers //
+    std::vector<WorkerResult> runWorkload(size_t totalRequests, const Workload& workload, const SnapshotHandler& onSnapshot);
+    void runWorker(WorkerResult& result, const Workload& workload);
+    void runReactorWorker(size_t worker, size_t workerCount, const std::vector<WorkerResult*>& connectionResults, const Workload& workload);
+    void runOpenLoopWorker(size_t worker, size_t workerCount, const std::vector<WorkerResult*>& connectionResults, const Workload& workload);
+
+    // Helpers //
+    void enterShard(size_t worker, size_t workerCount, const std::vector<WorkerResult*>& connectionResults);
+    bool claim(Claim& local, size_t count, size_t& first, size_t& last) noexcept;
+    static std::string_view corpusRange(const RequestCorpus& corpus, size_t first, size_t last) noexcept;
+
+    // Dependencies //
+    const std::vector<Endpoint>& targets;
+
+    // Constants //
+    static constexpr int POLL_INTERVAL_MS = 100; // How often reactor workers check timeouts and signals
+    static constexpr size_t CLAIM_CHUNK = 64;    // Most requests a worker takes from the shared counter at once
+
+    // Variables //
+    size_t connections;
+    size_t threads;
+    size_t pipelineDepth;
+    bool pinned;
+    std::vector<int> cpus; // Usable CPUs, in order, while pinned
+    double rate; // Requests per second across all workers, 0 for closed-loop
+    RateScheduler::Arrival arrival;
+    Timeouts timeouts; // Applied to every connection
+    size_t totalRequests;
+    size_t claimants; // Workers sharing the request counter in the current run
+    alignas(64) std::atomic<size_t> nextRequest; // The one line every worker writes
+};
+
+#endif // CONNECTION_ENGINE_HPP
\ No newline at end of file
@@ -12,17 +12,35 @@
 #ifndef CONNECTION_MANAGER_HPP
 #define CONNECTION_MANAGER_HPP
 
+#include "buffer_pool.hpp"
+#include "connection_pool.hpp"
+#include "event_loop.hpp"
+#include "host_timeouts.hpp"
+#include "request_metrics.hpp"
+#include "resolver.hpp"
+#include "response_parser.hpp"
 #include "socket.hpp"
 
-#include <poll.h>
-
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 /**
  * @brief The ConnectionManager class is responsible for managing the connection to the server, 
  * sending and receiving data, and handling the socket.
+ * @details One connection is active at a time. Connecting to another server parks the active
+ * connection in a ConnectionPool if it is idle and kept alive, and takes a warm connection to the
+ * new server from the pool when there is one. With TLS enabled, connections are TlsSockets, and
+ * new ones resume the server's cached session when they can.
+ *
+ * Each server has its own HostTimeouts. Connects wait as long as its observed connect times call
+ * for, within the configured limit, so a dead server is given up on sooner. Reads always get the
+ * whole configured read timeout, and a response much slower than the server's usual time to
+ * first byte is logged. After a failed connect, the next one to that server waits out a
+ * jittered, exponentially growing delay.
  */
 class ConnectionManager {
 public:
@@ -30,29 +48,72 @@ public:
     ConnectionManager();
 
     // Getters //
-    bool isConnected();
-    bool isWritable() const { return pollSocket(POLLOUT); }
-    bool isReadable() const { return pollSocket(POLLIN); }
+    bool isConnected() const noexcept;
+    bool isConnectedTo(const std::string& ip, const std::string& port) const noexcept;
+    bool isReused() const noexcept { return reused; } // Served a response before, so it may have gone stale
+    bool isTls() const noexcept { return tls; }
+    uint32_t getConnectionId() const noexcept { return socket ? socket->getId() : 0; }
+    bool isWritable() { return pollSocket(EPOLLOUT, limits.readMs); }
+    bool isReadable() { return pollSocket(EPOLLIN, limits.readMs); }
+    const ResponseParser& getResponse() const noexcept { return parser; }
+    const RequestTiming& getTiming() const noexcept { return timing; } // Last connect and last response
+    ConnectionPool& getPool() noexcept { return pool; }
+
+    // Setters //
+    void setSendTimeout(int timeout_ms) noexcept;
+    void setTimeouts(const Timeouts& timeouts);
+    void setTls(bool enable);
 
     // Functions //
     bool connect(const std::string& ip, const std::string& port);
     void disconnect();
     bool send(const std::string& data) const;
-    std::optional<std::string> receive();
+    bool sendv(struct iovec* iov, int iovcnt) const;
+    bool sendFile(int fd, size_t count, off_t offset = 0) const;
+    std::optional<std::string_view> receive(const ResponseParser::BodySink& sink = nullptr);
+    std::optional<size_t> receiveTo(int fd);
 
 private:
     // Dependencies //
     std::unique_ptr<Socket> socket;
-
-    // Helpers //
-    bool pollSocket(short events, int timeout_ms = 50) const;
+    EventLoop loop;
+    ConnectionPool pool; // Declared after the loop, which it unregisters from
 
     // Constants //
-    static constexpr int TIMEOUT_MS = 5000; // 5 seconds
-    static constexpr int BUFFER_SIZE = 128 * 1024; // 128KB
+    static constexpr int SEND_TIMEOUT_MS = 5000; // 5 seconds
+    static constexpr int ATTEMPT_DELAY_MS = 250; // Head start of each address over the next (RFC 8305)
+    static constexpr int IDLE_CHECK_MS = 100; // Idle time after which a reused connection is checked
+    static constexpr size_t READ_SIZE = 16 * 1024; // 16KB, the least free space offered to recv()
+    static constexpr size_t SPLICE_SIZE = 64 * 1024; // 64KB, the default pipe capacity
+
+    // Helpers //
+    static std::unique_ptr<Socket> raceConnect(const Resolver::AddressList& addresses, std::chrono::milliseconds timeout);
+    void onSocketEvents(int fd, uint32_t events) noexcept;
+    void release();
+    bool pollSocket(uint32_t events, int timeout_ms);
+    HostTimeouts& timeoutsFor(const std::string& ip, const std::string& port);
+    ssize_t recvWhenReady(char* buffer, size_t len);
+    void beginResponse(const ResponseParser::BodySink& sink);
+    bool readResponse(bool stopAfterHeaders);
+    std::optional<size_t> spliceBody(int fd, size_t length, bool untilClose);
+    static bool writeAll(int fd, std::string_view data) noexcept;
 
     // Variables //
     bool connected;
+    bool reused;           // Taken from the pool or has completed a response
+    bool tls;              // New connections run TLS over the socket
+    std::string host;      // IP address of the active connection
+    std::string service;   // Port of the active connection
+    int sendTimeoutMs;     // Applied to every new socket
+    Timeouts limits;       // Applied to every server
+    std::unordered_map<std::string, HostTimeouts> hostTimeouts; // By "ip:port"
+    HostTimeouts* current; // Of the active connection's server, `nullptr` before the first connect
+    ByteBuffer buffer;     // Received bytes, starting with the last returned response
+    size_t consumed;       // Length of the last returned response
+    ResponseParser parser; // Parses the response at the front of the buffer
+    uint32_t readyEvents;  // Edge-triggered events not yet consumed
+    RequestTiming timing;  // Only the connect and response points are set here
+    RequestTiming::Clock::time_point waitingSince; // Start of the wait for a response's first byte, unset once it arrived
 };
 
 #endif // CONNECTION_MANAGER_HPP
\ No newline at end of file
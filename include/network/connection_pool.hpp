@@ -0,0 +1,89 @@
+/**
+ * @file connection_pool.hpp
+ * @brief This file contains the declaration of the ConnectionPool class.
+ * @details It keeps idle keep-alive connections, keyed by server address, so switching
+ * between servers reuses a warm connection instead of opening a new one.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include "socket.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Forward Declarations //
+class EventLoop;
+
+/**
+ * @brief The ConnectionPool class holds idle connections keyed by "ip:port".
+ * @details Idle sockets stay registered with their owner's EventLoop, which passes their events
+ * to `notify()`. Any readable data, hang-up or error while idle means the server closed the
+ * connection (or broke the protocol), so the socket is closed right away. No syscall is spent
+ * checking a connection when it is taken back out. Connections idle for longer than the idle
+ * timeout are closed too, and each server keeps at most `maxIdlePerHost`, closing the oldest.
+ * @note Like its EventLoop, a ConnectionPool belongs to a single thread and does no locking.
+ */
+class ConnectionPool {
+public:
+    // Types //
+    using Clock = std::chrono::steady_clock;
+
+    // Constants //
+    static constexpr size_t MAX_IDLE_PER_HOST = 4;
+    static constexpr int IDLE_TIMEOUT_MS = 15000; // 15 seconds
+
+    // Constructors //
+    explicit ConnectionPool(EventLoop& loop);
+    ~ConnectionPool() noexcept;
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Getters //
+    size_t size() const noexcept { return idleCount; }
+
+    // Setters //
+    void setMaxIdlePerHost(size_t max);
+    void setIdleTimeout(int timeout_ms) noexcept { idleTimeout = std::chrono::milliseconds(timeout_ms); }
+
+    // Functions //
+    void release(const std::string& ip, const std::string& port, std::unique_ptr<Socket> socket);
+    std::unique_ptr<Socket> acquire(const std::string& ip, const std::string& port);
+    void notify(int fd, uint32_t events) noexcept;
+    void clear(const std::string& ip, const std::string& port) noexcept;
+    void clear() noexcept;
+
+private:
+    // Types //
+    struct IdleConnection {
+        std::unique_ptr<Socket> socket;
+        Clock::time_point since; // When it was released
+    };
+    using IdleList = std::vector<IdleConnection>; // Oldest first
+
+    // Dependencies //
+    EventLoop& loop;
+
+    // Helpers //
+    static std::string keyOf(const std::string& ip, const std::string& port);
+    void close(IdleList& list, size_t index) noexcept;
+    void evictExpired(Clock::time_point now) noexcept;
+
+    // Variables //
+    std::unordered_map<std::string, IdleList> hosts;
+    size_t idleCount;
+    size_t maxIdlePerHost;
+    std::chrono::milliseconds idleTimeout;
+};
+
+#endif // CONNECTION_POOL_HPP
@@ -0,0 +1,81 @@
+/**
+ * @file event_loop.hpp
+ * @brief This file contains the declaration of the EventLoop class.
+ * @details The EventLoop class is an epoll based reactor that owns the readiness
+ * registrations of non-blocking sockets and dispatches their events to callbacks.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Epoll Man Pages===========================================
+// https://man7.org/linux/man-pages/man7/epoll.7.html        |
+// https://man7.org/linux/man-pages/man2/epoll_ctl.2.html    |
+// https://man7.org/linux/man-pages/man2/epoll_wait.2.html   |
+// ===========================================================
+
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <sys/epoll.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The EventLoop class is an epoll based reactor. File descriptors are registered once
+ * with a callback, and `poll()` dispatches every ready descriptor from a single `epoll_wait()`.
+ * @note An EventLoop is meant to be owned and driven by a single thread, so it does no locking.
+ * Callbacks may add or remove registrations (including their own) while being dispatched.
+ */
+class EventLoop {
+public:
+    // Types //
+    using Callback = std::function<void(uint32_t events)>;
+
+    // Constructors //
+    EventLoop();
+    ~EventLoop() noexcept;
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+    EventLoop(EventLoop&&) = delete;
+    EventLoop& operator=(EventLoop&&) = delete;
+
+    // Getters //
+    bool contains(int fd) const noexcept;
+    size_t size() const noexcept { return registered; }
+
+    // Registration //
+    void add(int fd, uint32_t events, Callback callback);
+    void modify(int fd, uint32_t events);
+    void remove(int fd) noexcept;
+
+    // Dispatch //
+    int poll(int timeout_ms);
+    void run(int timeout_ms = -1);
+    void stop() noexcept { running = false; }
+
+private:
+    // Types //
+    struct Registration {
+        Callback callback;
+        uint32_t generation;
+    };
+
+    // Variables //
+    int epoll_fd;
+    bool running;
+    size_t registered;
+    uint32_t nextGeneration;
+    std::vector<std::unique_ptr<Registration>> registrations; // Indexed by fd
+    std::vector<std::unique_ptr<Registration>> retired;       // Removed during dispatch
+    std::vector<struct epoll_event> readyEvents;
+
+    // Constants //
+    static constexpr int MAX_EVENTS = 256;
+};
+
+#endif // EVENT_LOOP_HPP
\ No newline at end of file
@@ -0,0 +1,111 @@
+/**
+ * @file host_timeouts.hpp
+ * @brief This file contains the declarations of the RttEstimator and HostTimeouts classes.
+ * @details Together they adapt the connect deadline of a server to the connect times observed
+ * on it, flag responses much slower than usual, and space out reconnects after failures.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Retransmission Timer RFC====================
+// https://www.rfc-editor.org/rfc/rfc6298      |
+// =============================================
+
+#ifndef HOST_TIMEOUTS_HPP
+#define HOST_TIMEOUTS_HPP
+
+#include "config.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief The RttEstimator class smooths round trip samples into a timeout, as TCP computes its
+ * retransmission timeout from SRTT and RTTVAR (RFC 6298).
+ * @details The timeout is the smoothed time plus four times its mean deviation, never below
+ * `MIN_TIMEOUT`. Each `backoff()` doubles it until the next sample, as TCP backs off after a
+ * retransmission. Without samples, and never beyond it, the configured limit applies.
+ */
+class RttEstimator {
+public:
+    // Types //
+    using Duration = std::chrono::nanoseconds;
+
+    // Constants //
+    static constexpr std::chrono::milliseconds MIN_TIMEOUT{1000}; // RFC 6298, section 2.4
+    static constexpr unsigned MAX_BACKOFF_SHIFT = 6;
+
+    // Constructors //
+    RttEstimator() noexcept;
+
+    // Getters //
+    bool hasSamples() const noexcept { return samples > 0; }
+    Duration getSmoothed() const noexcept { return smoothed; }
+    Duration getVariation() const noexcept { return variation; }
+
+    // Functions //
+    void sample(Duration rtt) noexcept;
+    void backoff() noexcept;
+    std::chrono::milliseconds timeout(std::chrono::milliseconds limit) const noexcept;
+
+private:
+    // Variables //
+    Duration smoothed;     // SRTT
+    Duration variation;    // RTTVAR
+    unsigned backoffShift; // Doublings since the last sample
+    uint64_t samples;
+};
+
+/**
+ * @brief The HostTimeouts class keeps the deadlines of one server: a connect timeout adapted to
+ * its connect times, the configured read and idle timeouts, and when it may be reconnected to.
+ * @details The configured connect timeout is an upper limit. The read timeout is not adapted, as
+ * giving up on a response that would have arrived turns a latency spike into a failure; times to
+ * first byte are only smoothed to tell when a response is slow. After a failed connect, the next one waits
+ * an exponentially growing delay, from `RECONNECT_BASE_MS` up to `RECONNECT_MAX_MS`, of which a
+ * random half is jitter, so clients that failed together do not all come back at once.
+ * @note Like the connection that feeds it, a HostTimeouts belongs to a single thread.
+ */
+class HostTimeouts {
+public:
+    // Types //
+    using Clock = std::chrono::steady_clock;
+
+    // Constants //
+    static constexpr int RECONNECT_BASE_MS = 100;
+    static constexpr int RECONNECT_MAX_MS = 2000; // 2 seconds
+
+    // Constructors //
+    explicit HostTimeouts(const Timeouts& limits = Timeouts());
+
+    // Getters //
+    const Timeouts& getLimits() const noexcept { return limits; }
+    std::chrono::milliseconds getConnectTimeout() const noexcept { return connect.timeout(std::chrono::milliseconds(limits.connectMs)); }
+    std::chrono::milliseconds getReadTimeout() const noexcept { return std::chrono::milliseconds(limits.readMs); }
+    std::chrono::milliseconds getSlowThreshold() const noexcept { return response.timeout(getReadTimeout()); } // A first byte later than this is unusual
+    std::chrono::milliseconds getIdleTimeout() const noexcept { return std::chrono::milliseconds(limits.idleMs); }
+    Clock::time_point getRetryAt() const noexcept { return retryAt; } // Unset unless the last connect failed
+    unsigned getFailures() const noexcept { return failures; }
+
+    // Setters //
+    void setLimits(const Timeouts& limits) noexcept { this->limits = limits; }
+
+    // Functions //
+    void onConnected(RttEstimator::Duration took) noexcept;
+    void onConnectFailed(Clock::time_point now) noexcept;
+    bool onFirstByte(RttEstimator::Duration waited) noexcept;
+
+private:
+    // Variables //
+    Timeouts limits;
+    RttEstimator connect;  // Connect and handshake times
+    RttEstimator response; // Times to first byte
+    unsigned failures;     // Connects failed in a row
+    Clock::time_point retryAt;
+    std::minstd_rand random;
+};
+
+#endif // HOST_TIMEOUTS_HPP
@@ -9,7 +9,16 @@
  * COP4635 Sys & Net II - Project 2
  */
 
+#include <sys/uio.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #ifndef HTTP_CLIENT_HPP
 #define HTTP_CLIENT_HPP
@@ -18,26 +27,119 @@
 class ConnectionManager;
 class HttpRequest;
 class HttpResponse;
+class PreparedRequest;
+class RequestMetrics;
+class ResponseCache;
+class ResponseParser;
 
 /**
  * @brief The HttpClient class is responsible for processing HTTP requests by serializing and sending them to the server,
  * then receiving and parsing the response and displaying it to the user.
+ * @details With a body sink set, each response body is handed to the sink as it arrives instead of
+ * being buffered, and displayed responses show an empty body. With metrics set, the phases of
+ * every successful request are recorded into them. With a cache set, GET responses are stored
+ * and fresh ones are answered without the network, while stale ones are revalidated. Display is
+ * off until `setDisplay()` turns it on; with tracing enabled every request, failed or not, is
+ * recorded into the TraceRing instead. Raw requests, such as those of a RequestCorpus, are sent
+ * as they are from the caller's memory, with runs of adjacent ones merged into one iovec.
  */
 class HttpClient {
 public:
+    // Types //
+    using ResponseHandler = std::function<void(size_t index, const ResponseParser& response)>;
+    using BodySink = std::function<void(std::string_view data)>;
+
     // Constructors //
     HttpClient(ConnectionManager& connMgr);
 
+    // Setters //
+    void setDisplay(bool enable) noexcept { displayEnabled = enable; }
+    void setBodySink(BodySink sink) { bodySink = std::move(sink); }
+    void setMetrics(RequestMetrics* metrics) noexcept { this->metrics = metrics; }
+    void setCache(ResponseCache* cache) noexcept { this->cache = cache; }
+
     // Functions //
-    void processRequest(const HttpRequest& request, const std::string& ip, const std::string& port);
+    bool processRequest(const HttpRequest& request, const std::string& ip, const std::string& port);
+    bool processRequest(const PreparedRequest& prepared, std::string_view uri, const std::string& ip, const std::string& port);
+    bool processRaw(std::string_view request, const std::string& ip, const std::string& port);
+    bool downloadToFile(const HttpRequest& request, const std::string& ip, const std::string& port, const std::string& path);
+    size_t processPipeline(
+        const std::vector<HttpRequest>& requests,
+        const std::string& ip,
+        const std::string& port,
+        const ResponseHandler& onResponse = nullptr
+    );
+    size_t processPipeline(
+        const PreparedRequest& prepared,
+        const std::vector<std::string_view>& uris,
+        const std::string& ip,
+        const std::string& port,
+        const ResponseHandler& onResponse = nullptr
+    );
+    size_t processPipeline(
+        const std::vector<std::string_view>& rawRequests,
+        const std::string& ip,
+        const std::string& port,
+        const ResponseHandler& onResponse = nullptr
+    );
+    static std::string serializeRequest(const HttpRequest& request);
+    static void serializeHead(const HttpRequest& request, std::string& out, std::optional<size_t> bodyLength = std::nullopt);
 
 private:
     // Dependencies //
     ConnectionManager& connMgr;
 
     // Helpers //
-    std::string serializeRequest(const HttpRequest& request) const;
-    HttpResponse parseResponse(const std::string& responseData) const;
+    template<typename SendFunc, typename ReceiveFunc>
+    bool sendAndReceive(
+        const std::string& ip,
+        const std::string& port,
+        SendFunc&& send,
+        ReceiveFunc&& receive,
+        bool idempotent,
+        std::chrono::steady_clock::time_point& sent
+    );
+    template<typename SendFunc, typename HandleFunc>
+    bool exchange(
+        const std::string& ip,
+        const std::string& port,
+        SendFunc&& send,
+        const HttpRequest* request,
+        bool idempotent,
+        HandleFunc&& handle
+    );
+    bool processCached(const HttpRequest& request, const std::string& ip, const std::string& port);
+    void displayResponse(const ResponseParser& parser) const;
+    template<typename SendFunc>
+    size_t pipeline(
+        size_t count,
+        const std::string& ip,
+        const std::string& port,
+        SendFunc&& send,
+        const std::vector<HttpRequest>* requests,
+        const ResponseHandler& onResponse
+    );
+    bool ensureConnected(const std::string& ip, const std::string& port);
+    bool sendRequest(const HttpRequest& request);
+    void recordTiming(
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point sent,
+        bool includeConnect,
+        bool received = true,
+        uint16_t traceFlags = 0
+    ) noexcept;
+    HttpResponse parseResponse(const ResponseParser& parser) const;
+    static size_t headSize(const HttpRequest& request) noexcept;
+    static bool isPipelinable(const HttpRequest& request) noexcept;
+    static std::string_view methodOf(std::string_view rawRequest) noexcept;
+
+    // Variables //
+    bool displayEnabled;
+    BodySink bodySink; // Receives response bodies as they stream in instead of buffering them
+    std::string headBuffer; // Reused for every serialized request head, so it keeps its capacity
+    std::vector<struct iovec> rawIov; // Reused for every raw pipelined batch
+    RequestMetrics* metrics; // Records the phases of every successful request, not owned
+    ResponseCache* cache; // Answers and stores GET responses, not owned
 };
 
 #endif // HTTP_CLIENT_HPP
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * @file rate_scheduler.hpp
+ * @brief This file contains the declaration of the RateScheduler class.
+ * @details The RateScheduler class releases request arrivals at a fixed average rate from a
+ * timer registered with an EventLoop, for open-loop load generation.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Timerfd Man Pages===========================================
+// https://man7.org/linux/man-pages/man2/timerfd_create.2.html |
+// =============================================================
+
+#ifndef RATE_SCHEDULER_HPP
+#define RATE_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+
+// Forward Declarations //
+class EventLoop;
+
+/**
+ * @brief The RateScheduler class calls a handler once per arrival of a constant or Poisson
+ * schedule, with the time the arrival was due.
+ * @details Arrivals are laid out from the start time alone, never from when earlier requests
+ * completed, so a slow server cannot slow the schedule down. A timerfd is armed for the next
+ * arrival; when the loop is late every arrival that fell due meanwhile is released at once,
+ * each with its own due time. Measuring latency from that time rather than from the actual
+ * send is what keeps the queueing behind a stalled connection in the results (coordinated
+ * omission).
+ * @note Like its EventLoop, a RateScheduler belongs to a single thread.
+ */
+class RateScheduler {
+public:
+    // Types //
+    using Clock = std::chrono::steady_clock;
+    using ArrivalHandler = std::function<bool(Clock::time_point due)>; // Returns `false` to stop
+    enum class Arrival {
+        CONSTANT, // Evenly spaced
+        POISSON   // Exponentially distributed gaps, as independent users would arrive
+    };
+
+    // Constructors //
+    RateScheduler(EventLoop& loop, double rate, Arrival arrival, uint64_t seed);
+    ~RateScheduler() noexcept;
+    RateScheduler(const RateScheduler&) = delete;
+    RateScheduler& operator=(const RateScheduler&) = delete;
+
+    // Getters //
+    bool isRunning() const noexcept { return running; }
+
+    // Functions //
+    void start(ArrivalHandler handler);
+    void stop() noexcept;
+
+    // Helpers //
+    static const char* toString(Arrival arrival) noexcept;
+
+private:
+    // Helpers //
+    void onTimer();
+    void advance();
+    void arm();
+
+    // Dependencies //
+    EventLoop& loop;
+
+    // Variables //
+    int timer_fd;
+    Arrival arrival;
+    double intervalNs;            // Mean gap between arrivals
+    std::mt19937_64 random;
+    std::exponential_distribution<double> gaps; // In units of the mean gap
+    Clock::time_point origin;     // When the schedule started
+    double offsetNs;              // Of the next arrival from `origin`, kept exact so gaps never drift
+    Clock::time_point next;       // When the next arrival is due
+    bool running;
+    ArrivalHandler onArrival;
+};
+
+#endif // RATE_SCHEDULER_HPP
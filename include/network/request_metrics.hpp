@@ -0,0 +1,74 @@
+/**
+ * @file request_metrics.hpp
+ * @brief This file contains the declaration of the RequestTiming struct and RequestMetrics class.
+ * @details They record when each phase of a request happened and collect the phase
+ * durations of many requests into latency histograms.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef REQUEST_METRICS_HPP
+#define REQUEST_METRICS_HPP
+
+#include "latency_histogram.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * @brief The RequestTiming struct holds the timestamps of one request. Points that did not
+ * happen (like connecting on a reused connection) are left at the clock's epoch.
+ */
+struct RequestTiming {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point start;        // Request started
+    Clock::time_point connectStart; // Connect started, unset if the connection was reused
+    Clock::time_point connected;    // Connection established
+    Clock::time_point sent;         // Whole request written
+    Clock::time_point firstByte;    // First byte of the response available
+    Clock::time_point headersDone;  // Status line and headers parsed
+    Clock::time_point complete;     // Whole response received
+
+    void clearResponse() noexcept { firstByte = headersDone = complete = Clock::time_point(); }
+    static void mark(Clock::time_point& point) noexcept { if(point == Clock::time_point()) point = Clock::now(); } // Keeps the first time
+};
+
+/**
+ * @brief The RequestMetrics class keeps one latency histogram per request phase.
+ * @details Like its histograms, it has a single writer, so each worker thread owns its own
+ * and they are merged for reporting.
+ */
+class RequestMetrics {
+public:
+    // Types //
+    enum class Phase {
+        CONNECT, // connectStart to connected, only for requests that opened a connection
+        TTFB,    // sent to firstByte
+        HEADERS, // firstByte to headersDone
+        BODY,    // headersDone to complete
+        TOTAL    // start to complete
+    };
+    static constexpr size_t PHASE_COUNT = 5;
+
+    // Getters //
+    const LatencyHistogram& get(Phase phase) const noexcept { return histograms[static_cast<size_t>(phase)]; }
+    uint64_t getCount() const noexcept { return get(Phase::TOTAL).getCount(); }
+
+    // Functions //
+    void record(const RequestTiming& timing) noexcept;
+    void merge(const RequestMetrics& other) noexcept;
+    void localize();
+
+    // Helpers //
+    static const char* toString(Phase phase) noexcept;
+
+private:
+    // Variables //
+    std::array<LatencyHistogram, PHASE_COUNT> histograms;
+};
+
+#endif // REQUEST_METRICS_HPP
@@ -0,0 +1,106 @@
+/**
+ * @file resolver.hpp
+ * @brief This file contains the declaration of the Resolver class.
+ * @details It resolves host names to socket addresses off the connect path, caching
+ * the results so connections to the same host never wait on DNS twice.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =Resolver Documentation======================================
+// https://man7.org/linux/man-pages/man3/getaddrinfo.3.html    |
+// https://datatracker.ietf.org/doc/html/rfc8305               |
+// =============================================================
+
+#ifndef RESOLVER_HPP
+#define RESOLVER_HPP
+
+#include <sys/socket.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The Resolver class is a process-wide, thread-safe cache of resolved addresses.
+ * @details IPv4 and IPv6 literals are parsed without a lookup. Host names are resolved with
+ * `getaddrinfo()` on a background thread and cached for the TTL, with their addresses ordered
+ * for Happy Eyeballs (alternating families, starting with the preferred one). Once an entry
+ * expires it is still served for another TTL while a background lookup refreshes it, so only
+ * the first connect to a host waits on DNS. Concurrent lookups of the same host share one query.
+ * @note `getaddrinfo()` does not report record TTLs, so one TTL is used for every host.
+ */
+class Resolver {
+public:
+    // Types //
+    struct Address {
+        struct sockaddr_storage storage;
+        socklen_t length;
+
+        int family() const noexcept { return storage.ss_family; }
+        const struct sockaddr* get() const noexcept { return reinterpret_cast<const struct sockaddr*>(&storage); }
+    };
+    using AddressList = std::vector<Address>;
+    using Result = std::shared_ptr<const AddressList>; // Never empty when set
+
+    // Constants //
+    static constexpr int TTL_MS = 60000; // 1 minute
+
+    // Singleton //
+    static Resolver& getInstance() {
+        static Resolver instance;
+        return instance;
+    }
+
+    // Constructors //
+    Resolver(const Resolver&) = delete;
+    Resolver& operator=(const Resolver&) = delete;
+
+    // Setters //
+    void setTtl(int ttl_ms) noexcept;
+
+    // Functions //
+    Result resolve(const std::string& host, const std::string& port);
+    void prefetch(const std::string& host, const std::string& port);
+    void clear();
+    static std::optional<Address> parseLiteral(const std::string& host, const std::string& port) noexcept;
+    static std::string formatAuthority(const std::string& host, const std::string& port);
+
+private:
+    // Types //
+    using Clock = std::chrono::steady_clock;
+    struct Entry {
+        Result addresses;                  // Last successful lookup, if any
+        Clock::time_point expires;         // When `addresses` needs refreshing
+        std::shared_future<Result> lookup; // In-flight lookup, invalid if there is none
+    };
+
+    /**
+     * @brief The cache, shared with lookup threads so it outlives the Resolver at exit.
+     */
+    struct State {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries; // Keyed by "host:port"
+        std::chrono::milliseconds ttl{TTL_MS};
+    };
+
+    // Constructors //
+    Resolver();
+
+    // Helpers //
+    static std::shared_future<Result> startLookup(const std::shared_ptr<State>& state, const std::string& key, const std::string& host, const std::string& port);
+    static Result lookup(const std::string& host, const std::string& port);
+    static std::string stripBrackets(const std::string& host);
+
+    // Variables //
+    std::shared_ptr<State> state;
+};
+
+#endif // RESOLVER_HPP
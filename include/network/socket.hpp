@@ -14,25 +14,35 @@
 // https://man7.org/linux/man-pages/man2/connect.2.html    |
 // https://man7.org/linux/man-pages/man2/recv.2.html       |
 // https://man7.org/linux/man-pages/man2/send.2.html       |
+// https://man7.org/linux/man-pages/man2/sendfile.2.html   |
 // https://man7.org/linux/man-pages/man2/setsockopt.2.html |
 // https://man7.org/linux/man-pages/man2/socket.2.html     |
+// https://man7.org/linux/man-pages/man2/poll.2.html       |
+// https://man7.org/linux/man-pages/man2/splice.2.html     |
 // =========================================================
 
 #ifndef SOCKET_HPP
 #define SOCKET_HPP
 
 #include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <cstdint>
 
 /**
  * @brief The Socket class serves as a wrapper around the socket file descriptor 
  * to adhere to RAII principles.
+ * @details The data transfer functions are virtual so a TlsSocket can encrypt them
+ * behind the same interface.
  */
 class Socket {
 public:
     // Constructors //
     Socket(int domain, int type, int protocol);
     explicit Socket(int socket_fd);
-    ~Socket() noexcept;
+    virtual ~Socket() noexcept;
     Socket(Socket&& other) noexcept;
     Socket& operator=(Socket&& other) noexcept;
     Socket(const Socket& other) = delete;
@@ -40,19 +50,43 @@ public:
 
     // Getters //
     int get() const { return socket_fd; }
+    uint32_t getId() const noexcept { return id; } // Unique per connection in the process, unlike the fd
     bool isValid() const { return socket_fd >= 0; }
+    int getSendTimeout() const noexcept { return sendTimeoutMs; }
     
     // Setters //
     void setNonBlocking(bool enable);
+    void setSendTimeout(int timeout_ms) noexcept { sendTimeoutMs = timeout_ms; }
     
     // Functions //
     void connect(const struct sockaddr* addr, socklen_t addrlen, int timeout_ms);
-    ssize_t recv(void* buf, size_t len, int flags) const;
-    ssize_t send(const void* buf, size_t len, int flags) const;
+    bool beginConnect(const struct sockaddr* addr, socklen_t addrlen);
+    void finishConnect() const;
+    virtual ssize_t recv(void* buf, size_t len, int flags) const;
+    virtual ssize_t send(const void* buf, size_t len, int flags) const;
+    virtual ssize_t trySend(const void* buf, size_t len, int flags) const;
+    virtual size_t sendv(struct iovec* iov, int iovcnt, int flags) const;
+    virtual size_t sendFile(int in_fd, off_t offset, size_t count) const;
+    virtual ssize_t trySplice(int pipe_fd, size_t len) const;
+    virtual bool canSplice() const noexcept { return true; } // Whether `trySplice()` moves the data as received
+
+protected:
+    // Helpers //
+    void waitWritable() const;
+    void waitReadable() const;
 
 private:
+    // Helpers //
+    void waitFor(short events) const;
+
+    // Constants //
+    static constexpr int DEFAULT_SEND_TIMEOUT_MS = 5000; // 5 seconds without progress
+
     // Variables //
     int socket_fd;
+    int sendTimeoutMs; // How long a blocking send waits for room in the send buffer
+    uint32_t id;
+    static std::atomic<uint32_t> nextId;
 };
 
 #endif // SOCKET_HPP
\ No newline at end of file
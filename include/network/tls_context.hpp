@@ -0,0 +1,90 @@
+/**
+ * @file tls_context.hpp
+ * @brief This file contains the declaration of the TlsContext class.
+ * @details It holds the OpenSSL settings shared by every TLS connection, and caches
+ * session tickets per server so reconnects resume instead of running a full handshake.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =TLS Documentation===============================================
+// https://docs.openssl.org/3.0/man3/SSL_CTX_sess_set_new_cb/      |
+// https://docs.openssl.org/3.0/man3/SSL_set_session/              |
+// https://docs.openssl.org/3.0/man3/SSL_CTX_set_options/          |
+// https://datatracker.ietf.org/doc/html/rfc8446#section-2.2       |
+// https://www.kernel.org/doc/html/latest/networking/tls.html      |
+// =================================================================
+
+#ifndef TLS_CONTEXT_HPP
+#define TLS_CONTEXT_HPP
+
+#include <openssl/ssl.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief The TlsContext class is the process-wide, thread-safe source of TLS connections.
+ * @details Every connection is created from one `SSL_CTX`, which verifies the server's certificate
+ * against the system trust store (or a CA file) and its host name, and offers HTTP/1.1 through ALPN.
+ * The latest resumable session each server hands out is kept under "host:port", and the next
+ * connection to that server offers it, so a reconnect skips the certificate exchange and its
+ * round trip. With kTLS enabled, OpenSSL moves the record layer into the kernel when the kernel
+ * and cipher allow it, so `sendfile()` and `splice()` keep working on encrypted connections.
+ * @note The setters are meant to be called at startup, before any connection is made.
+ */
+class TlsContext {
+public:
+    // Constants //
+    static constexpr size_t MAX_SESSIONS = 1024; // Servers whose sessions are cached at once
+
+    // Singleton //
+    static TlsContext& getInstance() {
+        static TlsContext instance;
+        return instance;
+    }
+
+    // Constructors //
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    // Getters //
+    bool isKtlsEnabled() const noexcept { return ktls; }
+
+    // Setters //
+    void setVerifyPeer(bool enable) noexcept;
+    void setKtls(bool enable) noexcept;
+    void loadCaFile(const std::string& path);
+
+    // Functions //
+    SSL* newConnection(const std::string& host, const std::string* key);
+    void clearSessions();
+    static std::string lastError();
+
+private:
+    // Types //
+    struct SessionDeleter {
+        void operator()(SSL_SESSION* session) const noexcept { SSL_SESSION_free(session); }
+    };
+    using SessionPtr = std::unique_ptr<SSL_SESSION, SessionDeleter>;
+
+    // Constructors //
+    TlsContext();
+    ~TlsContext() noexcept;
+
+    // Helpers //
+    static int onNewSession(SSL* ssl, SSL_SESSION* session);
+    void storeSession(const std::string& key, SSL_SESSION* session);
+
+    // Variables //
+    SSL_CTX* context;
+    bool ktls;
+    std::mutex mutex; // Guards the sessions
+    std::unordered_map<std::string, SessionPtr> sessions; // Keyed by "host:port"
+};
+
+#endif // TLS_CONTEXT_HPP
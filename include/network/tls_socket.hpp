@@ -0,0 +1,80 @@
+/**
+ * @file tls_socket.hpp
+ * @brief This file contains the declaration of the TlsSocket class.
+ * @details The TlsSocket class runs TLS over a connected Socket, behind the same
+ * send and receive interface.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+// =TLS Documentation========================================
+// https://docs.openssl.org/3.0/man3/SSL_connect/           |
+// https://docs.openssl.org/3.0/man3/SSL_read/              |
+// https://docs.openssl.org/3.0/man3/SSL_write/             |
+// https://docs.openssl.org/3.0/man3/SSL_get_error/         |
+// ==========================================================
+
+#ifndef TLS_SOCKET_HPP
+#define TLS_SOCKET_HPP
+
+#include "socket.hpp"
+
+#include <openssl/ssl.h>
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief The TlsSocket class is a Socket whose data is encrypted with TLS.
+ * @details It takes over a connected, non-blocking socket. After the handshake, `recv()` and
+ * `trySend()` never wait, and report "would block" as the plain socket does (-1 with `errno`
+ * set to EAGAIN), so they work with edge-triggered readiness. The blocking sends wait with the
+ * send timeout. With kTLS, `sendFile()` and `trySplice()` stay zero-copy. Without it, a file is
+ * encrypted in user space and `canSplice()` is `false`.
+ * @note OpenSSL writes with `write()`, which cannot take MSG_NOSIGNAL, so the process must ignore SIGPIPE.
+ */
+class TlsSocket : public Socket {
+public:
+    // Constructors //
+    TlsSocket(Socket&& socket, const std::string& host, const std::string& port);
+    ~TlsSocket() noexcept override;
+    TlsSocket(TlsSocket&& other) = delete;
+    TlsSocket& operator=(TlsSocket&& other) = delete;
+
+    // Getters //
+    bool isResumed() const noexcept { return SSL_session_reused(ssl) == 1; } // Skipped the full handshake
+    bool hasKtlsSend() const noexcept { return ktlsSend; }
+    bool hasKtlsRecv() const noexcept { return ktlsRecv; }
+    bool canSplice() const noexcept override { return ktlsRecv && SSL_pending(ssl) == 0; }
+
+    // Functions //
+    void handshake(int timeout_ms);
+    bool tryHandshake();
+    ssize_t recv(void* buf, size_t len, int flags) const override;
+    ssize_t send(const void* buf, size_t len, int flags) const override;
+    ssize_t trySend(const void* buf, size_t len, int flags) const override;
+    size_t sendv(struct iovec* iov, int iovcnt, int flags) const override;
+    size_t sendFile(int in_fd, off_t offset, size_t count) const override;
+    ssize_t trySplice(int pipe_fd, size_t len) const override;
+
+private:
+    // Helpers //
+    int check(int result, const char* what) const;
+    void finishHandshake();
+
+    // Constants //
+    static constexpr size_t RECORD_SIZE = 16 * 1024; // 16KB, the largest TLS record
+
+    // Variables //
+    std::string key;      // "host:port", the session cache key
+    SSL* ssl;
+    bool handshakeDone;
+    bool wantWrite;       // The handshake is waiting for writability rather than data
+    bool ktlsSend;        // Records are encrypted by the kernel
+    bool ktlsRecv;        // Records are decrypted by the kernel
+    mutable bool failed;  // A fatal error was reported, so no close_notify is sent
+};
+
+#endif // TLS_SOCKET_HPP
@@ -0,0 +1,133 @@
+/**
+ * @file trace_ring.hpp
+ * @brief This file contains the declaration of the TraceRing class.
+ * @details The TraceRing class keeps compact binary records of the most recent requests in a
+ * fixed-size ring, to be dumped to a file for post-mortem analysis.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#ifndef TRACE_RING_HPP
+#define TRACE_RING_HPP
+
+#include "request_metrics.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Forward Declarations //
+class ResponseParser;
+
+/**
+ * @brief The TraceRing class records one 56 byte record per request into a ring shared by every thread.
+ * @details Writers claim a slot with a single atomic increment and never wait: once the ring is
+ * full the oldest records are overwritten. Each slot is stamped like a seqlock, so `dump()` can
+ * run while workers keep recording and simply skips a record that is being rewritten as it reads it.
+ * Recording is off until `enable()` is called, and then costs no formatting at all; `trace_decode`
+ * turns a dump back into text.
+ *
+ * A dump is a FileHeader followed by its records, oldest first, in the host's byte order.
+ */
+class TraceRing {
+public:
+    // Types //
+    enum Flag : uint16_t {
+        FAILED    = 1 << 0, // No response; the status and sizes are 0
+        TLS       = 1 << 1,
+        REUSED    = 1 << 2, // Sent on a connection that was already open
+        PIPELINED = 1 << 3, // Written in a batch before earlier responses arrived
+        DECODED   = 1 << 4  // The body had a content coding removed
+    };
+
+    /**
+     * @brief One request, as stored in the ring and in a dump.
+     */
+    struct Record {
+        uint64_t sequence;     // Order the record was written in, across every thread
+        int64_t startNs;       // Wall clock time the request started, in nanoseconds since the epoch
+        uint32_t connectUs;    // Connect and handshake, 0 on a reused connection
+        uint32_t firstByteUs;  // Request written until the first byte of the response
+        uint32_t totalUs;      // Request started until the response was complete
+        uint32_t connectionId; // Socket id, unique per connection in the process
+        uint64_t bodyBytes;    // As received, before decoding
+        uint32_t headerBytes;  // Status line and headers
+        uint32_t headerHash;   // FNV-1a of the header names and values, to spot changed responses
+        uint32_t reserved;
+        uint16_t status;
+        uint16_t flags;        // Flag bits
+    };
+    static_assert(sizeof(Record) == 56, "Record is part of the dump format");
+
+    /**
+     * @brief The start of a dump file.
+     */
+    struct FileHeader {
+        char magic[4];        // "HTRC"
+        uint16_t version;
+        uint16_t recordSize;  // sizeof(Record)
+        uint32_t capacity;    // Records the ring held
+        uint32_t count;       // Records in the file
+        uint64_t written;     // Records written since the ring was enabled, including overwritten ones
+        int64_t dumpedNs;     // Wall clock time of the dump
+    };
+
+    // Constants //
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024; // 64K records, 4MB
+
+    // Singleton //
+    static TraceRing& getInstance() {
+        static TraceRing instance;
+        return instance;
+    }
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    // Getters //
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    const std::string& getPath() const noexcept { return path; }
+
+    // Functions //
+    void enable(const std::string& path, size_t capacity = DEFAULT_CAPACITY);
+    void record(const RequestTiming& timing, const ResponseParser* response, uint32_t connectionId, uint16_t flags) noexcept;
+    bool dump() const;
+    static bool load(const std::string& path, FileHeader& header, std::vector<Record>& records);
+    static uint32_t hashHeaders(const ResponseParser& response) noexcept;
+
+private:
+    // Types //
+
+    /**
+     * @brief A ring slot: the record and its stamp, on a cache line of its own.
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> stamp{0}; // 0 when empty, BUSY while written, otherwise the sequence + 1
+        Record record;
+    };
+
+    // Constants //
+    static constexpr uint64_t BUSY = ~0ULL;
+
+    // Constructors //
+    TraceRing() noexcept;
+
+    // Helpers //
+    int64_t toWallNs(RequestTiming::Clock::time_point point) const noexcept;
+
+    // Variables //
+    std::atomic<bool> enabled;
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;                       // Capacity - 1, the capacity being a power of two
+    std::atomic<uint64_t> next;        // Sequence of the next record
+    std::string path;                  // Where `dump()` writes
+    int64_t wallOffsetNs;              // Wall clock minus steady clock when enabled
+};
+
+#endif // TRACE_RING_HPP
@@ -0,0 +1,392 @@
+/**
+ * @file batch_runner.cpp
+ * @brief This file contains the definition of the BatchRunner class.
+ * @details This class is responsible for driving the HttpClient without the interactive menus,
+ * so the client can be used as a load generator against a server.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "batch_runner.hpp"
+#include "connection_engine.hpp"
+#include "http_method.hpp"
+#include "http_request.hpp"
+#include "logger.hpp"
+#include "n_utils.hpp"
+#include "prepared_request.hpp"
+#include "resolver.hpp"
+#include "trace_ring.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// Constructors //
+
+/**
+ * @brief Constructs a new BatchRunner object from the loaded configuration.
+ * @param config The configuration data with the target server and workload settings.
+ */
+BatchRunner::BatchRunner(const ConfigData& config) : config(config) {}
+
+// Lifecycle //
+
+/**
+ * @brief Runs the batch workload and prints the results.
+ * @return `true` if every request succeeded, `false` otherwise.
+ */
+bool BatchRunner::run() {
+    const bool replay = !config.replayFile.empty();
+    if(!(replay ? loadCorpus() : loadURIs())) return false;
+
+    size_t available = replay ? corpus.size() : uris.size();
+    size_t totalRequests = (config.requestCount > 0) ? config.requestCount : available;
+    Logger::getInstance().log(
+        "Sending " + std::to_string(totalRequests) + " requests to " + std::to_string(config.targets.size()) +
+        " target(s) over " + std::to_string(config.concurrency) + " connection(s).", Logger::LogLevel::INFO
+    );
+
+    // Resolve every target in parallel while the engine starts up
+    for(const auto& target : config.targets) Resolver::getInstance().prefetch(target.ip, target.port);
+
+    // Pinned, each core runs one worker unless a thread count was given
+    size_t threads = config.threads;
+    if(config.pin && threads == 0) threads = ConnectionEngine::usableCpus().size();
+    // Only GETs are pipelined, which a corpus records for all of its requests at once
+    size_t pipelineDepth = config.pipelineDepth;
+    if(replay && pipelineDepth > 1 && !corpus.isPipelinable()) {
+        Logger::getInstance().log("The corpus has requests other than GETs, so they are not pipelined.", Logger::LogLevel::WARN);
+        pipelineDepth = 1;
+    }
+    ConnectionEngine engine(config.targets, config.concurrency, threads, pipelineDepth);
+    engine.setPinned(config.pin);
+    engine.setTimeouts(config.timeouts);
+    if(config.rate > 0) {
+        RateScheduler::Arrival arrival = config.poisson ? RateScheduler::Arrival::POISSON : RateScheduler::Arrival::CONSTANT;
+        engine.setRate(static_cast<double>(config.rate), arrival);
+        Logger::getInstance().log(
+            "Open-loop at " + std::to_string(config.rate) + " req/s with " + RateScheduler::toString(arrival) + " arrivals.", Logger::LogLevel::INFO
+        );
+    }
+    std::vector<WorkerResult> results;
+    auto start = std::chrono::steady_clock::now();
+    auto onSnapshot = [&](const std::vector<WorkerResult>& live) {
+        printReport(live, std::chrono::steady_clock::now() - start);
+        exportMetrics(live);
+        if(TraceRing::getInstance().isEnabled()) TraceRing::getInstance().dump();
+    };
+    auto elapsed = n_utils::io_time::measureTime([&] {
+        if(replay) {
+            results = engine.run(totalRequests, corpus, onSnapshot);
+            return;
+        }
+
+        // Every request differs only by URI, so each target's head is serialized once
+        std::vector<PreparedRequest> prepared;
+        prepared.reserve(config.targets.size());
+        for(const auto& target : config.targets) prepared.emplace_back(buildTemplate(target));
+        auto uriFor = [this](size_t index) { return std::string_view(uris[index % uris.size()]); };
+        results = engine.run(totalRequests, prepared, uriFor, onSnapshot);
+    });
+
+    printReport(results, elapsed);
+    bool exported = exportMetrics(results);
+
+    return exported && std::all_of(results.begin(), results.end(), [](const WorkerResult& r) { return r.failures == 0; });
+}
+
+// Setup //
+
+/**
+ * @brief Loads the URIs to request from the configured URI file.
+ * @details Blank lines and lines starting with '#' are skipped. If no file is configured,
+ * the default URI is used.
+ * @return `true` if at least one valid URI was loaded, `false` otherwise.
+ */
+bool BatchRunner::loadURIs() {
+    if(config.uriFile.empty()) {
+        uris.emplace_back(DEFAULT_URI);
+        return true;
+    }
+
+    std::ifstream file(config.uriFile);
+    if(!file) {
+        Logger::getInstance().log("Failed to open URI file: " + config.uriFile, Logger::LogLevel::ERROR);
+        return false;
+    }
+
+    std::string line;
+    while(std::getline(file, line)) {
+        std::string uri = n_utils::str_manip::trim(line);
+        if(uri.empty() || uri[0] == '#') continue;
+        if(uri[0] != '/') {
+            Logger::getInstance().log("Skipping invalid URI: " + uri, Logger::LogLevel::WARN);
+            continue;
+        }
+        uris.push_back(uri);
+    }
+
+    if(uris.empty()) {
+        Logger::getInstance().log("No valid URIs found in " + config.uriFile, Logger::LogLevel::ERROR);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps the configured request corpus.
+ * @details The requests are sent as recorded, so the URI file is not used.
+ * @return `true` if the corpus holds at least one request, `false` otherwise.
+ */
+bool BatchRunner::loadCorpus() {
+    if(!config.uriFile.empty()) {
+        Logger::getInstance().log("Replaying " + config.replayFile + ", so " + config.uriFile + " is not used.", Logger::LogLevel::WARN);
+    }
+    if(!corpus.load(config.replayFile)) return false;
+    if(corpus.empty()) {
+        Logger::getInstance().log("No requests found in " + config.replayFile, Logger::LogLevel::ERROR);
+        return false;
+    }
+    Logger::getInstance().log("Replaying " + std::to_string(corpus.size()) + " recorded requests from " + config.replayFile, Logger::LogLevel::INFO);
+    return true;
+}
+
+// Request Building //
+
+/**
+ * @brief Builds the keep-alive GET request template for the given target.
+ * @param target The server the requests are sent to.
+ * @return The request, without a URI, which is filled in per request.
+ */
+HttpRequest BatchRunner::buildTemplate(const Endpoint& target) const {
+    HttpRequest request;
+    request.setMethod(http::method::Method::GET)
+           .setHeader("Host", Resolver::formatAuthority(target.ip, target.port))
+           .setHeader("User-Agent", "HTTP Client/1.1")
+           .setHeader("Accept", "*/*")
+           .setHeader("Connection", "keep-alive");
+    return request;
+}
+
+// Reporting //
+
+/**
+ * @brief Merges the worker results and prints throughput and latency percentiles.
+ * @param results The results from every worker. They may still be recording.
+ * @param elapsed The wall clock time of the run so far.
+ */
+void BatchRunner::printReport(const std::vector<WorkerResult>& results, std::chrono::duration<double> elapsed) const {
+    using Phase = RequestMetrics::Phase;
+
+    std::vector<RequestMetrics> perTarget = mergeByTarget(results);
+    std::vector<size_t> targetFailures = failuresByTarget(results);
+    RequestMetrics all;
+    size_t failures = 0;
+    for(size_t i = 0; i < perTarget.size(); i++) {
+        all.merge(perTarget[i]);
+        failures += targetFailures[i];
+    }
+
+    const LatencyHistogram& total = all.get(Phase::TOTAL);
+    const uint64_t completed = total.getCount();
+    const double seconds = elapsed.count();
+    const double throughput = (seconds > 0) ? completed / seconds : 0.0;
+    const int lineWidth = 32;
+    auto ms = [](uint64_t nanoseconds) { return nanoseconds / 1e6; };
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << n_utils::io_style::seperator("Batch Results", '=', lineWidth) << "\n";
+    oss << "Requests:    " << completed << " ok, " << failures << " failed\n";
+    oss << "Duration:    " << seconds << " s\n";
+    oss << "Throughput:  " << throughput << " req/s\n";
+    if(config.rate > 0) {
+        oss << "Target rate: " << config.rate << " req/s (" << (config.poisson ? "poisson" : "constant") << ")\n";
+        oss << "Latency is measured from when each request was due.\n";
+    }
+    if(config.targets.size() > 1) {
+        oss << n_utils::io_style::seperator("Targets (ms)", '-', lineWidth) << "\n";
+        for(size_t i = 0; i < config.targets.size(); i++) {
+            const LatencyHistogram& hostTotal = perTarget[i].get(Phase::TOTAL);
+            oss << hostName(i) << "  " << hostTotal.getCount() << " ok, " << targetFailures[i] << " failed\n";
+            oss << "  p50 " << ms(hostTotal.getValueAtPercentile(50.0))
+                << "  p99 " << ms(hostTotal.getValueAtPercentile(99.0))
+                << "  p99.9 " << ms(hostTotal.getValueAtPercentile(99.9)) << "\n";
+        }
+    }
+    oss << n_utils::io_style::seperator("Latency (ms)", '-', lineWidth) << "\n";
+    if(completed > 0) {
+        oss << "min:   " << ms(total.getMin()) << "\n";
+        oss << "p50:   " << ms(total.getValueAtPercentile(50.0)) << "\n";
+        oss << "p90:   " << ms(total.getValueAtPercentile(90.0)) << "\n";
+        oss << "p99:   " << ms(total.getValueAtPercentile(99.0)) << "\n";
+        oss << "p99.9: " << ms(total.getValueAtPercentile(99.9)) << "\n";
+        oss << "max:   " << ms(total.getMax()) << "\n";
+        oss << n_utils::io_style::seperator("Phases (ms)", '-', lineWidth) << "\n";
+        oss << std::left << std::setw(8) << "" << std::right
+            << std::setw(8) << "p50" << std::setw(8) << "p99" << std::setw(8) << "p99.9" << "\n";
+        for(Phase phase : {Phase::CONNECT, Phase::TTFB, Phase::HEADERS, Phase::BODY}) {
+            const LatencyHistogram& histogram = all.get(phase);
+            oss << std::left << std::setw(8) << RequestMetrics::toString(phase) << std::right
+                << std::setw(8) << ms(histogram.getValueAtPercentile(50.0))
+                << std::setw(8) << ms(histogram.getValueAtPercentile(99.0))
+                << std::setw(8) << ms(histogram.getValueAtPercentile(99.9)) << "\n";
+        }
+    }
+    else {
+        oss << "No successful requests.\n";
+    }
+    oss << n_utils::io_style::seperator("", '=', lineWidth);
+
+    Logger::getInstance().print(oss.str());
+}
+
+/**
+ * @brief Writes the per-host phase histograms to the configured metrics file.
+ * @details The file is written next to its final path and renamed over it, so a reader
+ * never sees a half written snapshot.
+ * @param results The results from every worker. They may still be recording.
+ * @return `true` if the file was written or none is configured, `false` otherwise.
+ */
+bool BatchRunner::exportMetrics(const std::vector<WorkerResult>& results) const {
+    if(config.metricsFile.empty()) return true;
+
+    const std::string& path = config.metricsFile;
+    const std::string tempPath = path + ".tmp";
+    bool csv = path.size() >= 4 && n_utils::str_manip::iequals(std::string_view(path).substr(path.size() - 4), ".csv");
+    std::vector<RequestMetrics> perTarget = mergeByTarget(results);
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if(file) {
+            if(csv) writeCsv(file, perTarget);
+            else writeJson(file, perTarget, failuresByTarget(results));
+        }
+        if(!file || !file.flush()) {
+            Logger::getInstance().log("Failed to write metrics to " + tempPath, Logger::LogLevel::ERROR);
+            return false;
+        }
+    }
+    if(std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        Logger::getInstance().log("Failed to write metrics to " + path, Logger::LogLevel::ERROR);
+        return false;
+    }
+    Logger::getInstance().log("Wrote latency metrics to " + path, Logger::LogLevel::INFO);
+    return true;
+}
+
+/**
+ * @brief Merges the metrics of every worker by target.
+ * @param results The results from every worker.
+ * @return The metrics of each target, in target order.
+ */
+std::vector<RequestMetrics> BatchRunner::mergeByTarget(const std::vector<WorkerResult>& results) const {
+    std::vector<RequestMetrics> perTarget(config.targets.size());
+    for(const auto& result : results) perTarget[result.targetIndex].merge(result.metrics);
+    return perTarget;
+}
+
+/**
+ * @brief Sums the failures of every worker by target.
+ * @param results The results from every worker.
+ * @return The failures of each target, in target order.
+ */
+std::vector<size_t> BatchRunner::failuresByTarget(const std::vector<WorkerResult>& results) const {
+    std::vector<size_t> failures(config.targets.size(), 0);
+    for(const auto& result : results) failures[result.targetIndex] += result.failures.load(std::memory_order_relaxed);
+    return failures;
+}
+
+/**
+ * @brief Writes the phase percentiles of every host, and of all hosts together, as JSON.
+ * @param out The stream to write to.
+ * @param perTarget The metrics of each target.
+ * @param failures The failures of each target.
+ */
+void BatchRunner::writeJson(std::ostream& out, const std::vector<RequestMetrics>& perTarget, const std::vector<size_t>& failures) const {
+    auto writeQuoted = [&](const std::string& text) {
+        out << '"';
+        for(char c : text) {
+            if(c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    };
+    auto us = [](double nanoseconds) { return nanoseconds / 1e3; };
+    auto writePhases = [&](const RequestMetrics& metrics) {
+        out << "\"phases\": {";
+        for(size_t p = 0; p < RequestMetrics::PHASE_COUNT; p++) {
+            auto phase = static_cast<RequestMetrics::Phase>(p);
+            const LatencyHistogram& histogram = metrics.get(phase);
+            out << (p ? ", " : "") << "\"" << RequestMetrics::toString(phase) << "\": {"
+                << "\"count\": " << histogram.getCount()
+                << ", \"min\": " << us(histogram.getMin())
+                << ", \"mean\": " << us(histogram.getMean())
+                << ", \"p50\": " << us(histogram.getValueAtPercentile(50.0))
+                << ", \"p90\": " << us(histogram.getValueAtPercentile(90.0))
+                << ", \"p99\": " << us(histogram.getValueAtPercentile(99.0))
+                << ", \"p999\": " << us(histogram.getValueAtPercentile(99.9))
+                << ", \"max\": " << us(histogram.getMax()) << "}";
+        }
+        out << "}";
+    };
+
+    RequestMetrics all;
+    size_t totalFailures = 0;
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"unit\": \"us\",\n  \"hosts\": [\n";
+    for(size_t i = 0; i < perTarget.size(); i++) {
+        all.merge(perTarget[i]);
+        totalFailures += failures[i];
+        out << "    {\"host\": ";
+        writeQuoted(hostName(i));
+        out << ", \"requests\": " << perTarget[i].getCount() << ", \"failures\": " << failures[i] << ", ";
+        writePhases(perTarget[i]);
+        out << "}" << (i + 1 < perTarget.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n  \"all\": {\"requests\": " << all.getCount() << ", \"failures\": " << totalFailures << ", ";
+    writePhases(all);
+    out << "}\n}\n";
+}
+
+/**
+ * @brief Writes the phase percentiles of every host, and of all hosts together, as CSV.
+ * @details There is one row per host and phase. The host of the combined rows is `all`.
+ * @param out The stream to write to.
+ * @param perTarget The metrics of each target.
+ */
+void BatchRunner::writeCsv(std::ostream& out, const std::vector<RequestMetrics>& perTarget) const {
+    auto us = [](double nanoseconds) { return nanoseconds / 1e3; };
+    auto writeRows = [&](const std::string& host, const RequestMetrics& metrics) {
+        for(size_t p = 0; p < RequestMetrics::PHASE_COUNT; p++) {
+            auto phase = static_cast<RequestMetrics::Phase>(p);
+            const LatencyHistogram& histogram = metrics.get(phase);
+            out << host << ',' << RequestMetrics::toString(phase) << ',' << histogram.getCount()
+                << ',' << us(histogram.getMin()) << ',' << us(histogram.getMean())
+                << ',' << us(histogram.getValueAtPercentile(50.0)) << ',' << us(histogram.getValueAtPercentile(90.0))
+                << ',' << us(histogram.getValueAtPercentile(99.0)) << ',' << us(histogram.getValueAtPercentile(99.9))
+                << ',' << us(histogram.getMax()) << "\n";
+        }
+    };
+
+    RequestMetrics all;
+    out << std::fixed << std::setprecision(3);
+    out << "host,phase,count,min_us,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+    for(size_t i = 0; i < perTarget.size(); i++) {
+        all.merge(perTarget[i]);
+        writeRows(hostName(i), perTarget[i]);
+    }
+    writeRows("all", all);
+}
+
+/**
+ * @brief Gets the "host:port" name of a target.
+ * @param targetIndex The index of the target.
+ * @return The host name used in reports.
+ */
+std::string BatchRunner::hostName(size_t targetIndex) const {
+    return Resolver::formatAuthority(config.targets[targetIndex].ip, config.targets[targetIndex].port);
+}
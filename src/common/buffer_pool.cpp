@@ -0,0 +1,169 @@
+/**
+ * @file buffer_pool.cpp
+ * @brief This file contains the definition of the BufferPool and ByteBuffer classes.
+ * @details The BufferPool recycles receive buffer memory per thread, and the ByteBuffer
+ * is a growable receive buffer built on the pool's slabs.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "buffer_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// BufferPool //
+
+/**
+ * @brief Gets a slab of at least the requested capacity, reusing a freed one when possible.
+ * @param minCapacity The minimum capacity in bytes.
+ * @return A slab whose capacity is the next power of two (at least `MIN_SLAB_SIZE`).
+ */
+BufferPool::Slab BufferPool::acquire(size_t minCapacity) {
+    size_t capacity = MIN_SLAB_SIZE;
+    while(capacity < minCapacity) capacity *= 2;
+
+    if(capacity <= MAX_POOLED_SIZE) {
+        auto& slabs = freeSlabs[sizeClass(capacity)];
+        if(!slabs.empty()) {
+            Slab slab = std::move(slabs.back());
+            slabs.pop_back();
+            return slab;
+        }
+    }
+
+    // new char[] leaves the memory uninitialized, unlike a std::string or std::vector
+    return Slab{std::unique_ptr<char[]>(new char[capacity]), capacity};
+}
+
+/**
+ * @brief Returns a slab to the pool, or frees it if its size class is full.
+ * @param slab The slab to recycle. It is left empty.
+ */
+void BufferPool::recycle(Slab&& slab) noexcept {
+    if(!slab.data) return;
+
+    if(slab.capacity <= MAX_POOLED_SIZE) {
+        auto& slabs = freeSlabs[sizeClass(slab.capacity)];
+        if(slabs.size() < MAX_FREE_PER_CLASS) {
+            try {
+                slabs.push_back(std::move(slab));
+            }
+            catch(...) {} // Freed below if it could not be kept
+        }
+    }
+    slab.data.reset();
+    slab.capacity = 0;
+}
+
+/**
+ * @brief Maps a power of two capacity to its free list.
+ * @param capacity The slab capacity.
+ * @return The index of the size class.
+ */
+size_t BufferPool::sizeClass(size_t capacity) noexcept {
+    size_t index = 0;
+    for(size_t size = MIN_SLAB_SIZE; size < capacity; size *= 2) index++;
+    return std::min(index, CLASS_COUNT - 1);
+}
+
+// ByteBuffer //
+
+/**
+ * @brief Takes over another buffer's slab and contents.
+ * @param other The buffer to move from. It is left empty.
+ */
+ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept
+    : slab(std::move(other.slab)), start(other.start), finish(other.finish)
+{
+    other.slab.capacity = 0;
+    other.start = other.finish = 0;
+}
+
+/**
+ * @brief Takes over another buffer's slab and contents, recycling the current slab.
+ * @param other The buffer to move from. It is left empty.
+ * @return This buffer.
+ */
+ByteBuffer& ByteBuffer::operator=(ByteBuffer&& other) noexcept {
+    if(this != &other) {
+        release();
+        slab = std::move(other.slab);
+        start = other.start;
+        finish = other.finish;
+        other.slab.capacity = 0;
+        other.start = other.finish = 0;
+    }
+    return *this;
+}
+
+/**
+ * @brief Makes room for at least the requested number of bytes after the live data.
+ * @details Live bytes are moved to the front of the slab first. A larger slab is only taken
+ * from the pool if that is not enough.
+ * @param minWritable The number of bytes the caller wants to write.
+ * @return A pointer to the free space. At least `minWritable` bytes (see `writable()`) may be
+ * written there before calling `commit()`.
+ */
+char* ByteBuffer::prepare(size_t minWritable) {
+    if(writable() >= minWritable) return slab.data.get() + finish;
+
+    size_t live = size();
+    if(slab.capacity - live >= minWritable) {
+        std::memmove(slab.data.get(), data(), live);
+    }
+    else {
+        BufferPool::Slab larger = BufferPool::local().acquire(std::max(live + minWritable, slab.capacity * 2));
+        if(live > 0) std::memcpy(larger.data.get(), data(), live);
+        BufferPool::local().recycle(std::move(slab));
+        slab = std::move(larger);
+    }
+    start = 0;
+    finish = live;
+    return slab.data.get() + finish;
+}
+
+/**
+ * @brief Copies bytes to the end of the buffer.
+ * @param bytes The bytes to copy.
+ * @param length The number of bytes.
+ */
+void ByteBuffer::append(const char* bytes, size_t length) {
+    if(length == 0) return;
+    std::memcpy(prepare(length), bytes, length);
+    commit(length);
+}
+
+/**
+ * @brief Drops bytes from the front of the buffer without moving the rest.
+ * @param length The number of bytes to drop.
+ */
+void ByteBuffer::consume(size_t length) noexcept {
+    start += std::min(length, size());
+    if(start == finish) clear(); // Reuse the whole slab once it is drained
+}
+
+/**
+ * @brief Removes a range of bytes, moving the bytes after it down.
+ * @param offset The offset of the range from the first live byte.
+ * @param length The length of the range.
+ */
+void ByteBuffer::erase(size_t offset, size_t length) noexcept {
+    if(offset >= size()) return;
+    length = std::min(length, size() - offset);
+
+    char* first = slab.data.get() + start + offset;
+    std::memmove(first, first + length, size() - offset - length);
+    finish -= length;
+}
+
+/**
+ * @brief Empties the buffer and returns its slab to the pool.
+ */
+void ByteBuffer::release() noexcept {
+    BufferPool::local().recycle(std::move(slab));
+    start = finish = 0;
+}
@@ -16,9 +16,12 @@
 #include <getopt.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -61,19 +64,68 @@ void Config::parseCommandLine(int argc, char* argv[]) {
     ConfigData parsedData;
 
     static struct option long_options[] = {
-        {"debug",         no_argument,       0, 'd'}, // -d or --debug
-        {0,               0,                 0,  0 }  // Required null terminator
+        {"debug",           no_argument,       0, 'd'}, // -d or --debug
+        {"host",            required_argument, 0, 'H'}, // -H or --host <[scheme://]host[:port],...>
+        {"port",            required_argument, 0, 'p'}, // -p or --port <port>
+        {"uri-file",        required_argument, 0, 'f'}, // -f or --uri-file <path>
+        {"replay",          required_argument, 0, 'R'}, // -R or --replay <corpus>
+        {"requests",        required_argument, 0, 'n'}, // -n or --requests <count>
+        {"concurrency",     required_argument, 0, 'c'}, // -c or --concurrency <count>
+        {"threads",         required_argument, 0, 't'}, // -t or --threads <count>
+        {"pin",             no_argument,       0, 'A'}, // -A or --pin
+        {"pipeline",        required_argument, 0, 'P'}, // -P or --pipeline <depth>
+        {"rate",            required_argument, 0, 'r'}, // -r or --rate <requests per second>
+        {"arrival",         required_argument, 0, 'a'}, // -a or --arrival <constant|poisson>
+        {"metrics",         required_argument, 0, 'm'}, // -m or --metrics <path>
+        {"tls",             no_argument,       0, 's'}, // -s or --tls
+        {"insecure",        no_argument,       0, 'k'}, // -k or --insecure
+        {"ca-file",         required_argument, 0, 'C'}, // -C or --ca-file <path>
+        {"ktls",            no_argument,       0, 'K'}, // -K or --ktls
+        {"cache-dir",       required_argument, 0, 'D'}, // -D or --cache-dir <path>
+        {"no-cache",        no_argument,       0, 'N'}, // -N or --no-cache
+        {"trace",           required_argument, 0, 'T'}, // -T or --trace <path>
+        {"connect-timeout", required_argument, 0, 'o'}, // -o or --connect-timeout <ms>
+        {"read-timeout",    required_argument, 0, 'w'}, // -w or --read-timeout <ms>
+        {"idle-timeout",    required_argument, 0, 'i'}, // -i or --idle-timeout <ms>
+        {0,                 0,                 0,  0 }  // Required null terminator
     };
 
     // Parse command line arguments
     int opt, option_index, verbosityCount = 0;
-    while((opt = getopt_long(argc, argv, "d", long_options, &option_index)) != -1) {
+    std::string hosts;
+    Timeouts& timeouts = parsedData.timeouts;
+    while((opt = getopt_long(argc, argv, "dH:p:f:R:n:c:t:AP:r:a:m:skC:KD:NT:o:w:i:", long_options, &option_index)) != -1) {
         switch(opt) {
-            case 'd': verbosityCount++; parsedData.debug = true; break;
-            case '?': handleInvalidOption(optopt, argv);         break;
+            case 'd': verbosityCount++; parsedData.debug = true;                          break;
+            case 'H': hosts = optarg;                                                     break;
+            case 'p': parsedData.port = std::to_string(parseCount(optarg, "--port"));     break;
+            case 'f': parsedData.uriFile = optarg;                                        break;
+            case 'R': parsedData.replayFile = optarg;                                     break;
+            case 'n': parsedData.requestCount = parseCount(optarg, "--requests");         break;
+            case 'c': parsedData.concurrency = parseCount(optarg, "--concurrency");       break;
+            case 't': parsedData.threads = parseCount(optarg, "--threads");               break;
+            case 'A': parsedData.pin = true;                                              break;
+            case 'P': parsedData.pipelineDepth = parseCount(optarg, "--pipeline");        break;
+            case 'r': parsedData.rate = parseCount(optarg, "--rate");                     break;
+            case 'a': parsedData.poisson = parseArrival(optarg);                          break;
+            case 'm': parsedData.metricsFile = optarg;                                    break;
+            case 's': parsedData.tls = true;                                              break;
+            case 'k': parsedData.verifyPeer = false;                                      break;
+            case 'C': parsedData.caFile = optarg;                                         break;
+            case 'K': parsedData.ktls = true;                                             break;
+            case 'D': parsedData.cacheDir = optarg;                                       break;
+            case 'N': parsedData.cache = false;                                           break;
+            case 'T': parsedData.traceFile = optarg;                                      break;
+            case 'o': timeouts.connectMs = parseMilliseconds(optarg, "--connect-timeout"); break;
+            case 'w': timeouts.readMs = parseMilliseconds(optarg, "--read-timeout");      break;
+            case 'i': timeouts.idleMs = parseMilliseconds(optarg, "--idle-timeout");      break;
+            case '?': handleInvalidOption(optopt, argv);                                  break;
         }
     }
 
+    // Targets are resolved last so --port and --tls apply regardless of option order
+    if(!hosts.empty()) parsedData.targets = parseTargets(hosts, parsedData.port, parsedData.tls);
+
     // Update the ConfigData struct with the parsed data
     data = parsedData;
 }
@@ -92,4 +144,109 @@ void Config::handleInvalidOption(int optopt, char* argv[]) {
         std::cerr << "Error: Invalid long option - " << argv[optind - 1] << std::endl;
     }
     throw std::invalid_argument("Invalid command-line argument.");
+}
+
+/**
+ * @brief Parses a strictly positive integer from a command line argument.
+ * @param arg The argument value.
+ * @param option The option name, used in the error message.
+ * @return The parsed value.
+ * @throws std::invalid_argument if the value is not a positive integer.
+ */
+size_t Config::parseCount(const char* arg, const std::string& option) const {
+    std::string_view value(arg);
+    if(value.empty() || !std::all_of(value.begin(), value.end(), ::isdigit)) {
+        throw std::invalid_argument("Option " + option + " expects a positive integer.");
+    }
+
+    size_t count;
+    try {
+        count = std::stoul(std::string(value));
+    }
+    catch(const std::out_of_range& e) {
+        throw std::invalid_argument("Option " + option + " value is out of range.");
+    }
+    if(count == 0) throw std::invalid_argument("Option " + option + " must be greater than zero.");
+    return count;
+}
+
+/**
+ * @brief Parses a timeout from a command line argument.
+ * @param arg The argument value, in milliseconds.
+ * @param option The option name, used in the error message.
+ * @return The timeout in milliseconds.
+ * @throws std::invalid_argument if the value is not a positive integer that fits in an `int`.
+ */
+int Config::parseMilliseconds(const char* arg, const std::string& option) const {
+    size_t milliseconds = parseCount(arg, option);
+    if(milliseconds > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::invalid_argument("Option " + option + " value is out of range.");
+    }
+    return static_cast<int>(milliseconds);
+}
+
+/**
+ * @brief Parses the arrival process of an open-loop run.
+ * @param arg The raw --arrival argument, "constant" or "poisson".
+ * @return `true` for Poisson arrivals, `false` for evenly spaced ones.
+ * @throws std::invalid_argument if the process is unknown.
+ */
+bool Config::parseArrival(const char* arg) const {
+    if(n_utils::str_manip::iequals(arg, "poisson")) return true;
+    if(n_utils::str_manip::iequals(arg, "constant")) return false;
+    throw std::invalid_argument("Option --arrival expects \"constant\" or \"poisson\".");
+}
+
+/**
+ * @brief Parses a comma-separated list of "[scheme://]host[:port]" targets.
+ * @details A host is an IPv4 address, a host name, or an IPv6 address. An IPv6 address
+ * needs brackets to take a port ("[::1]:8080"), and is stored without them. A target with
+ * an "https://" or "http://" scheme picks TLS itself and defaults to port 443 or 80.
+ * @param hosts The raw --host argument.
+ * @param defaultPort The port used for targets without a port or scheme.
+ * @param defaultTls Whether targets without a scheme use TLS.
+ * @return The parsed targets.
+ * @throws std::invalid_argument if a target is empty or has an invalid scheme or port.
+ */
+std::vector<Endpoint> Config::parseTargets(const std::string& hosts, const std::string& defaultPort, bool defaultTls) const {
+    std::vector<Endpoint> targets;
+    std::istringstream hostStream(hosts);
+    std::string entry;
+    while(std::getline(hostStream, entry, ',')) {
+        entry = n_utils::str_manip::trim(entry);
+        if(entry.empty()) throw std::invalid_argument("Option --host contains an empty target.");
+
+        Endpoint target{entry, defaultPort, defaultTls};
+        size_t scheme = entry.find("://");
+        if(scheme != std::string::npos) {
+            std::string_view name(entry.data(), scheme);
+            bool https = n_utils::str_manip::iequals(name, "https");
+            if(!https && !n_utils::str_manip::iequals(name, "http")) {
+                throw std::invalid_argument("Option --host contains an unsupported scheme: " + entry);
+            }
+            entry.erase(0, scheme + 3);
+            if(!entry.empty() && entry.back() == '/') entry.pop_back(); // "https://host/" names the same server
+            if(entry.empty()) throw std::invalid_argument("Option --host contains a target without a host.");
+            target = Endpoint{entry, https ? "443" : "80", https};
+        }
+
+        size_t colon = std::string::npos;
+        if(entry.front() == '[') {
+            size_t close = entry.find(']');
+            if(close == std::string::npos || (close + 1 < entry.size() && entry[close + 1] != ':')) {
+                throw std::invalid_argument("Option --host contains a malformed IPv6 target: " + entry);
+            }
+            target.ip = entry.substr(1, close - 1);
+            if(close + 1 < entry.size()) colon = close + 1;
+        }
+        else if(std::count(entry.begin(), entry.end(), ':') == 1) {
+            colon = entry.find(':'); // More than one colon is a bare IPv6 address
+            target.ip = entry.substr(0, colon);
+        }
+        if(colon != std::string::npos) target.port = std::to_string(parseCount(entry.c_str() + colon + 1, "--host"));
+        if(target.ip.empty()) throw std::invalid_argument("Option --host contains a target without a host.");
+        if(std::stoul(target.port) > 65535) throw std::invalid_argument("Port must be between 1 and 65535.");
+        targets.push_back(std::move(target));
+    }
+    return targets;
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+/**
+ * @file latency_histogram.cpp
+ * @brief This file contains the definition of the LatencyHistogram class.
+ * @details It is a fixed-size, log-linear histogram of durations in the style of
+ * HdrHistogram, so percentiles cost nothing to record and no samples are kept.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Constructors //
+
+/**
+ * @brief Constructs an empty LatencyHistogram with every bucket allocated up front.
+ */
+LatencyHistogram::LatencyHistogram()
+    : buckets(new Counter[BUCKET_COUNT]()), count(0), sum(0),
+      min(std::numeric_limits<uint64_t>::max()), max(0)
+{}
+
+/**
+ * @brief Takes over another histogram's buckets.
+ * @param other The histogram to move from. It must not be recording, and is left unusable.
+ */
+LatencyHistogram::LatencyHistogram(LatencyHistogram&& other) noexcept
+    : buckets(std::move(other.buckets)),
+      count(other.count.load(std::memory_order_relaxed)),
+      sum(other.sum.load(std::memory_order_relaxed)),
+      min(other.min.load(std::memory_order_relaxed)),
+      max(other.max.load(std::memory_order_relaxed))
+{}
+
+// Getters //
+
+/**
+ * @brief Gets the exact mean of every recorded value.
+ * @return The mean in nanoseconds, or 0 if nothing was recorded.
+ */
+double LatencyHistogram::getMean() const noexcept {
+    uint64_t total = getCount();
+    return total ? static_cast<double>(sum.load(std::memory_order_relaxed)) / total : 0.0;
+}
+
+/**
+ * @brief Gets a percentile using the nearest-rank method.
+ * @param pct The percentile to get (0-100).
+ * @return The highest value in the bucket holding that rank, capped at the largest recorded
+ * value, or 0 if nothing was recorded.
+ */
+uint64_t LatencyHistogram::getValueAtPercentile(double pct) const noexcept {
+    uint64_t total = getCount();
+    if(total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(pct, 0.0, 100.0) / 100.0 * total));
+    rank = std::clamp<uint64_t>(rank, 1, total);
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if(seen >= rank) return std::min(bucketUpperBound(i), getMax());
+    }
+    return getMax(); // Only reached if a snapshot caught the count ahead of the buckets
+}
+
+// Functions //
+
+/**
+ * @brief Counts one value. Only the owning thread may call this.
+ * @param nanoseconds The value to record.
+ */
+void LatencyHistogram::record(uint64_t nanoseconds) noexcept {
+    add(buckets[bucketIndex(nanoseconds)], 1);
+    add(sum, nanoseconds);
+    if(nanoseconds < min.load(std::memory_order_relaxed)) min.store(nanoseconds, std::memory_order_relaxed);
+    if(nanoseconds > max.load(std::memory_order_relaxed)) max.store(nanoseconds, std::memory_order_relaxed);
+    add(count, 1); // Last, so a reader never sees more samples than bucket counts
+}
+
+/**
+ * @brief Counts one duration. Negative durations are counted as zero.
+ * @param duration The duration to record.
+ */
+void LatencyHistogram::record(std::chrono::steady_clock::duration duration) noexcept {
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    record(static_cast<uint64_t>(std::max<decltype(nanoseconds)>(nanoseconds, 0)));
+}
+
+/**
+ * @brief Adds every value counted by another histogram to this one.
+ * @param other The histogram to add. It may still be recording, in which case a snapshot is added.
+ */
+void LatencyHistogram::merge(const LatencyHistogram& other) noexcept {
+    uint64_t otherCount = 0;
+    for(size_t i = 0; i < BUCKET_COUNT; i++) {
+        uint64_t value = other.buckets[i].load(std::memory_order_relaxed);
+        if(value == 0) continue;
+        add(buckets[i], value);
+        otherCount += value;
+    }
+    if(otherCount == 0) return;
+
+    add(sum, other.sum.load(std::memory_order_relaxed));
+    min.store(std::min(min.load(std::memory_order_relaxed), other.min.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    max.store(std::max(max.load(std::memory_order_relaxed), other.max.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    add(count, otherCount);
+}
+
+/**
+ * @brief Moves the buckets into memory allocated by the calling thread.
+ * @details Pages are placed on the NUMA node of the thread that first writes them, so a
+ * worker pinned to a core calls this before recording to keep its counters local.
+ * @note No other thread may read the histogram meanwhile.
+ */
+void LatencyHistogram::localize() {
+    std::unique_ptr<Counter[]> local(new Counter[BUCKET_COUNT]());
+    for(size_t i = 0; i < BUCKET_COUNT; i++) local[i].store(buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    buckets = std::move(local);
+}
+
+// Helpers //
+
+/**
+ * @brief Maps a value to its bucket.
+ * @param value The value in nanoseconds.
+ * @return The bucket index.
+ */
+size_t LatencyHistogram::bucketIndex(uint64_t value) noexcept {
+    if(value < LINEAR_BUCKETS) return static_cast<size_t>(value);
+
+    unsigned exponent = 63 - __builtin_clzll(value); // Highest set bit
+    if(exponent > LAST_EXPONENT) return BUCKET_COUNT - 1;
+
+    // The top SUB_BUCKET_BITS + 1 bits pick the bucket within this power of two
+    unsigned shift = exponent - SUB_BUCKET_BITS;
+    return LINEAR_BUCKETS + (exponent - FIRST_EXPONENT) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+/**
+ * @brief Gets the highest value that maps to a bucket.
+ * @param index The bucket index.
+ * @return The value in nanoseconds.
+ */
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) noexcept {
+    if(index < LINEAR_BUCKETS) return index;
+
+    size_t offset = index - LINEAR_BUCKETS;
+    unsigned shift = static_cast<unsigned>(offset / SUB_BUCKETS) + FIRST_EXPONENT - SUB_BUCKET_BITS;
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + offset % SUB_BUCKETS) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
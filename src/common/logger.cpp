@@ -10,13 +10,13 @@
  */
 
 #include "logger.hpp"
-#include "n_utils.hpp"
 
+#include <chrono>
+#include <ctime>
 #include <iostream>
 #include <mutex>
 #include <string>
 #include <string_view>
-#include <sstream>
 
 /**
  * @brief This method logs a message to the console.
@@ -31,28 +31,28 @@ void Logger::log(std::string_view message, const LogLevel& level) noexcept {
 /**
  * @brief This method logs a message to the specified output stream.
  * @details The `out` param allows the caller to specify what stream type to write to.
+ * In async mode, messages for `std::cout` and `std::cerr` are queued for the writer thread.
  * @param message The message to log.
  * @param level The log level of the message.
  * @param out The output stream to write the log message to.
  */
 void Logger::log(std::string_view message, const LogLevel& level, std::ostream& out) noexcept {
     // Prevent messages below the current log level from being printed
-    if(level < currentLevel) return;
+    if(!isEnabled(level)) return;
 
-    // Lock the mutex to prevent multiple threads from writing at the same time
-    std::scoped_lock<std::mutex> lock(logMutex);
-
-    std::ostringstream oss;
-    // Add the timestamp and log level to the message
-    oss << "[" << n_utils::io_time::getCurrentTimestamp() << "]" << "[" << toString(level) << "]";
-
-    // Add padding to the message based on the log level
-    if(level == LogLevel::DEBUG || level == LogLevel::ERROR) oss << " " << message;
-    else oss << "  " << message;
+    try {
+        std::string line = formatLine(message, level);
+        if(asyncEnabled.load(std::memory_order_acquire) && (&out == &std::cout || &out == &std::cerr)) {
+            enqueue(std::move(line), &out == &std::cerr);
+            return;
+        }
 
-    // Print the log message to the output stream
-    out << oss.str() << std::endl;
-    out.flush(); // Ensure immediate output to the console
+        // Lock the mutex to prevent multiple threads from writing at the same time
+        std::scoped_lock<std::mutex> lock(logMutex);
+        out << line;
+        out.flush(); // Ensure immediate output to the console
+    }
+    catch(...) {} // Logging must never throw
 }
 
 /**
@@ -60,9 +60,198 @@ void Logger::log(std::string_view message, const LogLevel& level, std::ostream&
  * @param message The message to print.
  */
 void Logger::print(std::string_view message) noexcept {
+    try {
+        std::string line(message);
+        line += '\n';
+        if(asyncEnabled.load(std::memory_order_acquire)) {
+            enqueue(std::move(line), false); // Keeps its place among queued log lines
+            return;
+        }
+
+        std::scoped_lock<std::mutex> lock(logMutex);
+        std::cout << line;
+        std::cout.flush();  // Ensure immediate output to the console
+    }
+    catch(...) {}
+}
+
+// Lifecycle //
+
+/**
+ * @brief Starts the background writer. From now on, console messages are queued instead of written inline.
+ * @details Queued messages keep their order within each thread. Messages from different threads
+ * are written in the order the writer finds them.
+ */
+void Logger::startAsync() {
+    std::scoped_lock<std::mutex> lock(ringsMutex);
+    if(writerRunning) return;
+
+    writerRunning = true;
+    writer = std::thread(&Logger::runWriter, this);
+    asyncEnabled.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Stops the background writer after writing every queued message.
+ */
+void Logger::stopAsync() noexcept {
+    {
+        std::scoped_lock<std::mutex> lock(ringsMutex);
+        if(!writerRunning) return;
+        asyncEnabled.store(false, std::memory_order_release);
+        writerRunning = false;
+    }
+    wakeWriter.notify_all();
+    if(writer.joinable()) writer.join();
+}
+
+// Helpers //
+
+/**
+ * @brief Builds a log line with its timestamp and level.
+ * @param message The message to log.
+ * @param level The log level of the message.
+ * @return The formatted line, ending with a newline.
+ */
+std::string Logger::formatLine(std::string_view message, const LogLevel& level) const {
+    std::string_view levelName;
+    switch(level) {
+        case LogLevel::DEBUG: levelName = "DEBUG"; break;
+        case LogLevel::INFO:  levelName = "INFO";  break;
+        case LogLevel::WARN:  levelName = "WARN";  break;
+        case LogLevel::ERROR: levelName = "ERROR"; break;
+        default:              levelName = "UNKNOWN"; break;
+    }
+
+    std::string_view timestamp = cachedTimestamp();
+    std::string line;
+    line.reserve(timestamp.size() + levelName.size() + message.size() + 8);
+    line += '[';
+    line += timestamp;
+    line += "][";
+    line += levelName;
+    line += ']';
+
+    // Add padding to the message based on the log level
+    if(level == LogLevel::DEBUG || level == LogLevel::ERROR) line += ' ';
+    else line += "  ";
+    line += message;
+    line += '\n';
+    return line;
+}
+
+/**
+ * @brief Gets the current timestamp in the format "YYYY-MM-DD HH:MM:SS".
+ * @details The timestamp is only formatted again when the second changes, and each thread has
+ * its own copy, so no lock is needed.
+ * @return A view of the calling thread's cached timestamp.
+ */
+std::string_view Logger::cachedTimestamp() noexcept {
+    thread_local std::time_t cachedSecond = -1;
+    thread_local char buffer[32] = {0};
+    thread_local size_t length = 0;
+
+    std::time_t now = std::time(nullptr);
+    if(now != cachedSecond) {
+        struct tm local;
+        localtime_r(&now, &local);
+        length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+        cachedSecond = now;
+    }
+    return std::string_view(buffer, length);
+}
+
+/**
+ * @brief Queues a formatted line on the calling thread's ring.
+ * @details When the ring is full the caller yields until the writer makes room, so no
+ * message is lost.
+ * @param line The formatted line.
+ * @param toError `true` to write the line to `std::cerr`.
+ */
+void Logger::enqueue(std::string&& line, bool toError) noexcept {
+    Ring* ring = nullptr;
+    try {
+        ring = localRing();
+    }
+    catch(...) {
+        return;
+    }
+
+    size_t tail = ring->tail.load(std::memory_order_relaxed);
+    while(tail - ring->head.load(std::memory_order_acquire) >= RING_CAPACITY) {
+        if(!writerRunning) return; // Stopped while waiting, nothing will drain the ring
+        wakeWriter.notify_one();
+        std::this_thread::yield();
+    }
+
+    Entry& entry = ring->slots[tail & (RING_CAPACITY - 1)];
+    entry.line = std::move(line);
+    entry.toError = toError;
+    ring->tail.store(tail + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Gets the calling thread's ring, registering one on first use.
+ * @return The ring owned by the calling thread.
+ * @note Rings are owned by the Logger, so lines queued by a thread that has exited are still written.
+ */
+Logger::Ring* Logger::localRing() {
+    thread_local Ring* ring = nullptr;
+    if(!ring) {
+        auto created = std::make_unique<Ring>();
+        std::scoped_lock<std::mutex> lock(ringsMutex);
+        rings.push_back(std::move(created));
+        ring = rings.back().get();
+    }
+    return ring;
+}
+
+/**
+ * @brief Writes every queued line, one batch per stream.
+ * @return `true` if anything was written.
+ */
+bool Logger::drain() {
+    std::string outBatch, errBatch;
+    {
+        std::scoped_lock<std::mutex> lock(ringsMutex);
+        for(auto& ring : rings) {
+            size_t head = ring->head.load(std::memory_order_relaxed);
+            size_t tail = ring->tail.load(std::memory_order_acquire);
+            for(; head != tail; head++) {
+                Entry& entry = ring->slots[head & (RING_CAPACITY - 1)];
+                (entry.toError ? errBatch : outBatch) += entry.line;
+                entry.line.clear();
+            }
+            ring->head.store(head, std::memory_order_release);
+        }
+    }
+    if(outBatch.empty() && errBatch.empty()) return false;
+
     std::scoped_lock<std::mutex> lock(logMutex);
-    std::cout << message << std::endl;
-    std::cout.flush();  // Ensure immediate output to the console
+    if(!outBatch.empty()) std::cout.write(outBatch.data(), outBatch.size()).flush();
+    if(!errBatch.empty()) std::cerr.write(errBatch.data(), errBatch.size()).flush();
+    return true;
+}
+
+/**
+ * @brief The writer thread. Drains the rings every few milliseconds, or sooner when a ring fills up.
+ */
+void Logger::runWriter() {
+    std::mutex waitMutex;
+    while(writerRunning) {
+        try {
+            drain();
+        }
+        catch(...) {}
+        std::unique_lock<std::mutex> lock(waitMutex);
+        wakeWriter.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+    }
+
+    // Write whatever was queued before stopping
+    try {
+        while(drain()) {}
+    }
+    catch(...) {}
 }
 
 /**
@@ -10,17 +10,20 @@
  */
 
 #include "connection_manager.hpp"
+#include "content_decoder.hpp"
 #include "http_client.hpp"
 #include "http_encoding.hpp"
 #include "http_mime.hpp"
 #include "http_request.hpp"
 #include "input_handler.hpp"
 #include "logger.hpp"
+#include "n_utils.hpp"
+#include "resolver.hpp"
 
-#include <arpa/inet.h>
 #include <unistd.h>
 
-#include <cstring>
+#include <cctype>
+#include <utility>
 
 // Constructors //
 
@@ -80,6 +83,9 @@ void InputHandler::run() {
             case InputState::ENTER_POST_BODY:
                 if(readPostBody()) switchToState(InputState::ENTER_POST_BODY); // Allow user to keep sending POST requests
                 break;
+            case InputState::ENTER_DOWNLOAD:
+                if(readDownload()) switchToState(InputState::ENTER_DOWNLOAD); // Allow user to keep downloading files
+                break;
             case InputState::EXIT:
                 clearConnection(); // Clean up socket resources
                 break;
@@ -123,6 +129,7 @@ void InputHandler::displayRequestMenu() {
     std::cout << n_utils::io_style::seperator("Request Menu", '=', 24) << std::endl;
     std::cout << "1) Send a GET request\n";
     std::cout << "2) Send a POST request\n";
+    std::cout << "3) Download a file\n";
     std::cout << n_utils::io_style::seperator("", '=', 24) << std::endl;
     handleRequestMenuInput();
 }
@@ -206,6 +213,10 @@ void InputHandler::handleRequestMenuInput() {
         clearScreen();
         switchToState(InputState::ENTER_POST_BODY);
     }
+    else if(choice == "3") {
+        clearScreen();
+        switchToState(InputState::ENTER_DOWNLOAD);
+    }
     else if(choice == ESC_KEY) {
         switchToState(InputState::MAIN_MENU);
     }
@@ -267,9 +278,9 @@ std::optional<std::string> InputHandler::readInput(
 bool InputHandler::readIP() {
     clearScreen();
     auto ip = readInput(
-        "Enter the IP address of the server (ex: 127.0.0.1): ",
-        [this](const std::string& ip) { return checkValidIP(ip); },
-        "Invalid IP address format. Please try again."
+        "Enter the IP address or host name of the server (ex: 127.0.0.1): ",
+        [this](const std::string& ip) { return checkValidHost(ip); },
+        "Invalid IP address or host name. Please try again."
     );
     if(!ip.has_value()) return false;
 
@@ -332,26 +343,73 @@ bool InputHandler::readPostBody() {
     if(!postData.value().empty()) {
         postData = http::encoding::encode(postData.value()); // Encode any special characters
         postData = "comment=" + postData.value(); // Add form data key (only key on server)
-        return sendAndValidate(http::method::Method::POST, "/submit", postData.value());
+        return sendAndValidate(http::method::Method::POST, "/submit", std::move(postData.value()));
     }
     return false;
 }
 
+/**
+ * @brief Reads the URI to download and the file to save it to from the user.
+ * @return `true` if the download finished, otherwise `false`.
+ */
+bool InputHandler::readDownload() {
+    auto uri = readInput(
+        "Enter the URI of the file (ex: /index.html): ",
+        [this](const std::string& uri) { return checkValidURI(uri); },
+        "Invalid URI format. Please try again."
+    );
+    if(!uri.has_value() || uri.value().empty()) return false;
+
+    auto path = readInput(
+        "Enter the file to save it to: ",
+        [](const std::string& path) { return !path.empty(); },
+        "File name cannot be empty. Please try again."
+    );
+    if(!path.has_value()) return false;
+
+    // Check if connection is lost and reconnect
+    if(!connMgr.connect(ip, port)) {
+        printMessage("Failed to reconnect to " + ip + ":" + port + ".\n");
+        return false;
+    }
+
+    HttpRequest request = buildRequest(http::method::Method::GET, uri.value(), "");
+    if(!client.downloadToFile(request, ip, port, path.value())) {
+        printMessage("Failed to download " + uri.value() + ".\n");
+        return false;
+    }
+    return true;
+}
+
 // Input Validators //
 
 /**
- * @brief Checks if the IP address is valid.
- * @param ip The IP address to check.
- * @return `true` if the IP address is valid, otherwise `false`.
+ * @brief Checks if the host is an IP address or a well-formed host name.
+ * @details Host names are dot-separated labels of letters, digits and hyphens (RFC 1123).
+ * Whether the name resolves is only known once connecting.
+ * @param host The IPv4 address, IPv6 address or host name to check.
+ * @return `true` if the host is valid, otherwise `false`.
  */
-bool InputHandler::checkValidIP(const std::string& ip) {
-    // Setup sockaddr_in struct
-    struct sockaddr_in sa;
-    std::memset(&sa, 0, sizeof(sa));
-
-    // Check if IP address is valid
-    int result = inet_pton(AF_INET, ip.c_str(), &(sa.sin_addr));
-    return result == 1; // 1 means valid IP address
+bool InputHandler::checkValidHost(const std::string& host) {
+    if(Resolver::parseLiteral(host, "0")) return true;
+    if(host.empty() || host.size() > 253) return false;
+
+    size_t labelStart = 0;
+    while(labelStart <= host.size()) {
+        size_t labelEnd = host.find('.', labelStart);
+        if(labelEnd == std::string::npos) labelEnd = host.size();
+        size_t length = labelEnd - labelStart;
+
+        // Only the label after a trailing dot may be empty
+        if(length == 0) return labelEnd == host.size() && labelStart > 0;
+        if(length > 63 || host[labelStart] == '-' || host[labelEnd - 1] == '-') return false;
+        for(size_t i = labelStart; i < labelEnd; i++) {
+            unsigned char c = static_cast<unsigned char>(host[i]);
+            if(!std::isalnum(c) && c != '-') return false;
+        }
+        labelStart = labelEnd + 1;
+    }
+    return true;
 }
 
 /**
@@ -439,7 +497,7 @@ void InputHandler::clearConnection() {
  * if the connection was successful.
  */
 bool InputHandler::checkConnection() {
-    if(!connMgr.isConnected()) {
+    if(!connMgr.isConnectedTo(ip, port)) {
         if(!connMgr.connect(ip, port)) {
             printMessage("Failed to connect to " + ip + ":" + port + ".\n");
             return false;
@@ -456,12 +514,12 @@ bool InputHandler::checkConnection() {
  * @param body The body of the request.
  * @return `true` if the request was sent and validated, otherwise `false`.
  */
-bool InputHandler::sendAndValidate(const http::method::Method& method, const std::string& uri, const std::string& body) {
-    HttpRequest request = buildRequest(method, uri, body);
+bool InputHandler::sendAndValidate(const http::method::Method& method, const std::string& uri, std::string body) {
+    HttpRequest request = buildRequest(method, uri, std::move(body));
     if(request.getStatusLine().empty()) return false;
 
     // Check if connection is lost and reconnect
-    if(!connMgr.isConnected()) {
+    if(!connMgr.isConnectedTo(ip, port)) {
         if(!connMgr.connect(ip, port)) {
             printMessage("Failed to reconnect to " + ip + ":" + port + ".\n");
             return false;
@@ -481,24 +539,25 @@ bool InputHandler::sendAndValidate(const http::method::Method& method, const std
  * @param body The body of the request.
  * @return The built HTTP request object.
  */
-HttpRequest InputHandler::buildRequest(const http::method::Method& method, const std::string& uri, const std::string &body) const{
+HttpRequest InputHandler::buildRequest(const http::method::Method& method, const std::string& uri, std::string body) const{
     // Create and set values for all requests
     HttpRequest request;
     request.setMethod(method)
            .setURI(uri)
-           .setHeader("Host", ip + ":" + port)
+           .setHeader("Host", Resolver::formatAuthority(ip, port))
            .setHeader("User-Agent", "HTTP Client/1.1")
-           .setHeader("Accept", "*/*");
+           .setHeader("Accept", "*/*")
+           .setHeader("Accept-Encoding", ContentDecoder::ACCEPTED); // Decoded as the body arrives
     
     // Set extra headers based on request type
     if(method == http::method::Method::GET) {
         request.setHeader("Connection", "keep-alive");
     }
     else if(method == http::method::Method::POST) {
-        request.setBody(body)
-               .setHeader("Content-Type", http::mime::toString(http::mime::Media::APP_FORM))
+        request.setHeader("Content-Type", http::mime::toString(http::mime::Media::APP_FORM))
                .setHeader("Content-Length", std::to_string(body.length()))
                .setHeader("Connection", "close");
+        request.setBody(std::move(body)); // Moved last, the length is read above
     }
     return request;
 }
\ No newline at end of file
@@ -8,14 +8,19 @@
  * COP4635 Sys & Net II - Project 2
  */
 
+#include "batch_runner.hpp"
 #include "config.hpp"
 #include "http_client.hpp"
 #include "input_handler.hpp"
 #include "logger.hpp"
 #include "connection_manager.hpp"
+#include "response_cache.hpp"
+#include "tls_context.hpp"
+#include "trace_ring.hpp"
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <csignal>
 #include <cstdlib>
 #include <cstring>
@@ -23,6 +28,9 @@
 // Global variable to track if a signal was received
 volatile std::sig_atomic_t signal_received = 0;
 
+// Global variable set when the latency metrics should be written mid-run
+volatile std::sig_atomic_t metrics_requested = 0;
+
 /**
  * @brief Signal handler for system signals.
  * @param signum The signal number.
@@ -33,6 +41,16 @@ void signalHandler(int signum) {
     Logger::getInstance().log("Received signal: " + std::string(strsignal(signum)), Logger::LogLevel::INFO);
 }
 
+/**
+ * @brief Signal handler for SIGUSR1.
+ * @param signum The signal number.
+ * @details This function only sets a flag, so the batch run can write a metrics snapshot
+ * and dump the trace ring.
+ */
+void metricsSignalHandler(int) {
+    metrics_requested = 1;
+}
+
 /**
  * @brief Registers signals to be captured.
  */
@@ -43,6 +61,29 @@ void registerSignals() {
     sa.sa_flags = 0; // Disable SA_RESTART to prevent interrupted system calls
     sigaction(SIGINT, &sa, nullptr);
     sigaction(SIGTERM, &sa, nullptr);
+
+    sa.sa_handler = metricsSignalHandler;
+    sa.sa_flags = SA_RESTART; // A snapshot request must not interrupt the workers
+    sigaction(SIGUSR1, &sa, nullptr);
+
+    // OpenSSL writes without MSG_NOSIGNAL, so a closed TLS connection must fail with EPIPE instead
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, nullptr);
+}
+
+/**
+ * @brief Applies the TLS settings, only if some connection uses TLS.
+ * @param config The configuration data.
+ * @throws std::runtime_error if the CA file cannot be loaded.
+ */
+void configureTls(const ConfigData& config) {
+    bool used = config.tls || std::any_of(config.targets.begin(), config.targets.end(), [](const Endpoint& target) { return target.tls; });
+    if(!used) return;
+
+    TlsContext& context = TlsContext::getInstance();
+    context.setVerifyPeer(config.verifyPeer);
+    context.setKtls(config.ktls);
+    if(!config.caFile.empty()) context.loadCaFile(config.caFile);
 }
 
 /**
@@ -54,18 +95,39 @@ int main(int argc, char* argv[]) {
     // Register signal handlers
     registerSignals();
 
-    // Load the configuration and set the log level
-    Config::getInstance().loadConfig(argc, argv);
-    Logger::getInstance().setLogLevel(Config::getInstance().determineLogLevel());
-
     try {
+        // Load the configuration and set the log level
+        Config::getInstance().loadConfig(argc, argv);
+        Logger::getInstance().setLogLevel(Config::getInstance().determineLogLevel());
+        configureTls(Config::getInstance().getData());
+        TraceRing& trace = TraceRing::getInstance();
+        if(!Config::getInstance().getData().traceFile.empty()) trace.enable(Config::getInstance().getData().traceFile);
+
+        // Run headless when a target host was given on the command line
+        if(Config::getInstance().isBatch()) {
+            Logger::getInstance().startAsync(); // Workers must not wait on the terminal
+            BatchRunner batchRunner(Config::getInstance().getData());
+            bool success = batchRunner.run();
+            if(trace.isEnabled()) success = trace.dump() && success;
+            Logger::getInstance().stopAsync();
+            return success ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
         // Create objects and inject dependencies by reference
+        const ConfigData& config = Config::getInstance().getData();
         ConnectionManager connMgr;
+        connMgr.setTls(config.tls);
+        connMgr.setTimeouts(config.timeouts);
+        ResponseCache cache;
+        if(!config.cacheDir.empty()) cache.setDiskDirectory(config.cacheDir);
         HttpClient client(connMgr);
+        client.setDisplay(true); // Showing each exchange is the point of interactive mode
+        if(config.cache) client.setCache(&cache);
         InputHandler inputHandler(client, connMgr);
 
         // Run the program
         inputHandler.run();
+        if(trace.isEnabled()) trace.dump();
     }
     catch(const std::exception& e) {
         Logger::getInstance().log("An error occurred: " + std::string(e.what()), Logger::LogLevel::ERROR);
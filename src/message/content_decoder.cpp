@@ -0,0 +1,219 @@
+/**
+ * @file content_decoder.cpp
+ * @brief This file contains the definition of the ContentDecoder class.
+ * @details It is responsible for driving zlib and Brotli over a body as it streams in.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "content_decoder.hpp"
+#include "n_utils.hpp"
+
+#include <brotli/decode.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+// Constructors //
+
+/**
+ * @brief Constructs an idle decoder. zlib and Brotli state is only created with the first body that needs it.
+ */
+ContentDecoder::ContentDecoder() noexcept
+    : coding(Coding::IDENTITY), zlibReady(false), probing(false), brotli(nullptr), finished(false), decodedSize(0) {
+    std::memset(&zlib, 0, sizeof(zlib));
+}
+
+/**
+ * @brief Frees the zlib and Brotli state.
+ */
+ContentDecoder::~ContentDecoder() noexcept {
+    reset();
+    if(zlibReady) inflateEnd(&zlib);
+}
+
+// Functions //
+
+/**
+ * @brief Prepares the decoder for a new body.
+ * @param coding The body's content coding. IDENTITY leaves the decoder inactive.
+ * @return `true` if the decoder is ready, `false` if the coding is unsupported or zlib or
+ * Brotli could not allocate their state.
+ */
+bool ContentDecoder::begin(Coding coding) {
+    reset();
+    if(coding == Coding::IDENTITY) return true;
+    if(coding == Coding::UNSUPPORTED) return false;
+    if(!buffer) buffer = std::make_unique<char[]>(OUTPUT_SIZE);
+
+    if(coding == Coding::BROTLI) {
+        brotli = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+        if(!brotli) return false;
+    }
+    else {
+        // Deflate picks its window bits once the first bytes show whether it is wrapped
+        int windowBits = (coding == Coding::GZIP) ? 16 + MAX_WBITS : MAX_WBITS;
+        int result = zlibReady ? inflateReset2(&zlib, windowBits) : inflateInit2(&zlib, windowBits);
+        if(result != Z_OK) return false;
+        zlibReady = true;
+        probing = (coding == Coding::DEFLATE);
+    }
+    this->coding = coding;
+    return true;
+}
+
+/**
+ * @brief Decodes the next piece of the body.
+ * @details Bytes after the end of the encoded stream are ignored, unless they start another gzip member.
+ * @param input The next encoded bytes.
+ * @param output Receives the decoded bytes, in order. If it is empty they are appended to `kept` instead.
+ * @param kept The decoded body, when there is no output.
+ * @return `true` if the input was valid, `false` if the body is corrupt.
+ */
+bool ContentDecoder::decode(std::string_view input, const Output& output, std::string& kept) {
+    if(input.empty() || coding == Coding::IDENTITY) return true;
+    if(finished) {
+        if(coding != Coding::GZIP || static_cast<uint8_t>(input.front()) != 0x1F) return true;
+        inflateReset(&zlib); // Another gzip member follows
+        finished = false;
+    }
+    return (coding == Coding::BROTLI) ? decodeBrotli(input, output, kept) : inflateZlib(input, output, kept);
+}
+
+/**
+ * @brief Drops the current body's state, leaving the decoder inactive.
+ * @note The zlib stream is kept for the next body. The Brotli state, which cannot be reset, is freed.
+ */
+void ContentDecoder::reset() noexcept {
+    if(brotli) {
+        BrotliDecoderDestroyInstance(brotli);
+        brotli = nullptr;
+    }
+    coding = Coding::IDENTITY;
+    probing = false;
+    finished = false;
+    decodedSize = 0;
+}
+
+/**
+ * @brief Reads the coding of a body from its Content-Encoding header.
+ * @param contentEncoding The header value, a list of codings in the order they were applied.
+ * @return The coding, IDENTITY if there is none, or UNSUPPORTED if it is unknown or several codings are stacked.
+ */
+ContentDecoder::Coding ContentDecoder::parseCoding(std::string_view contentEncoding) noexcept {
+    Coding result = Coding::IDENTITY;
+    while(!contentEncoding.empty()) {
+        size_t comma = contentEncoding.find(',');
+        std::string_view name = contentEncoding.substr(0, comma);
+        contentEncoding = (comma == std::string_view::npos) ? std::string_view() : contentEncoding.substr(comma + 1);
+
+        while(!name.empty() && (name.front() == ' ' || name.front() == '\t')) name.remove_prefix(1);
+        while(!name.empty() && (name.back() == ' ' || name.back() == '\t')) name.remove_suffix(1);
+        if(name.empty() || n_utils::str_manip::iequals(name, "identity")) continue;
+        if(result != Coding::IDENTITY) return Coding::UNSUPPORTED;
+
+        if(n_utils::str_manip::iequals(name, "gzip") || n_utils::str_manip::iequals(name, "x-gzip")) result = Coding::GZIP;
+        else if(n_utils::str_manip::iequals(name, "deflate")) result = Coding::DEFLATE;
+        else if(n_utils::str_manip::iequals(name, "br")) result = Coding::BROTLI;
+        else return Coding::UNSUPPORTED;
+    }
+    return result;
+}
+
+// Helpers //
+
+/**
+ * @brief Runs zlib over a piece of a gzip or deflate body.
+ * @param input The encoded bytes.
+ * @param output Receives the decoded bytes, if set.
+ * @param kept Receives the decoded bytes otherwise.
+ * @return `true` if the input was valid, `false` otherwise.
+ */
+bool ContentDecoder::inflateZlib(std::string_view input, const Output& output, std::string& kept) {
+    if(probing) {
+        // A zlib header is a deflate method nibble with a check value that makes it a multiple of 31
+        uint8_t method = static_cast<uint8_t>(input[0]);
+        bool wrapped = (method & 0x0F) == Z_DEFLATED && (input.size() < 2 || ((method << 8) | static_cast<uint8_t>(input[1])) % 31 == 0);
+        if(!wrapped && inflateReset2(&zlib, -MAX_WBITS) != Z_OK) return false;
+        probing = false;
+    }
+
+    while(!input.empty() && !finished) {
+        size_t length = std::min<size_t>(input.size(), UINT_MAX);
+        zlib.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        zlib.avail_in = static_cast<uInt>(length);
+
+        // Drain the output before taking more input, so a full buffer never stalls the stream
+        do {
+            zlib.next_out = reinterpret_cast<Bytef*>(buffer.get());
+            zlib.avail_out = static_cast<uInt>(OUTPUT_SIZE);
+            int result = inflate(&zlib, Z_NO_FLUSH);
+            if(result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) return false;
+            emit(OUTPUT_SIZE - zlib.avail_out, output, kept);
+
+            if(result == Z_STREAM_END) {
+                bool another = coding == Coding::GZIP && zlib.avail_in > 0 && *zlib.next_in == 0x1F;
+                if(!another) {
+                    finished = true;
+                    break;
+                }
+                inflateReset(&zlib);
+            }
+            else if(result == Z_BUF_ERROR) {
+                if(zlib.avail_in > 0) return false; // Stuck with input left
+                break; // No progress possible until more input arrives
+            }
+        } while(zlib.avail_in > 0 || zlib.avail_out == 0);
+
+        input.remove_prefix(length - zlib.avail_in);
+    }
+    return true;
+}
+
+/**
+ * @brief Runs Brotli over a piece of a br body.
+ * @param input The encoded bytes.
+ * @param output Receives the decoded bytes, if set.
+ * @param kept Receives the decoded bytes otherwise.
+ * @return `true` if the input was valid, `false` otherwise.
+ */
+bool ContentDecoder::decodeBrotli(std::string_view input, const Output& output, std::string& kept) {
+    const uint8_t* next = reinterpret_cast<const uint8_t*>(input.data());
+    size_t available = input.size();
+    while(true) {
+        uint8_t* out = reinterpret_cast<uint8_t*>(buffer.get());
+        size_t space = OUTPUT_SIZE;
+        BrotliDecoderResult result = BrotliDecoderDecompressStream(brotli, &available, &next, &space, &out, nullptr);
+        emit(OUTPUT_SIZE - space, output, kept);
+
+        switch(result) {
+            case BROTLI_DECODER_RESULT_SUCCESS:
+                finished = true;
+                return true;
+            case BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT:
+                return true;
+            case BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT:
+                break;
+            default:
+                return false;
+        }
+    }
+}
+
+/**
+ * @brief Hands on the decoded bytes in the output buffer.
+ * @param length The number of bytes decoded into the buffer.
+ * @param output Receives them, if set.
+ * @param kept Receives them otherwise.
+ */
+void ContentDecoder::emit(size_t length, const Output& output, std::string& kept) {
+    if(length == 0) return;
+    decodedSize += length;
+    std::string_view data(buffer.get(), length);
+    if(output) output(data);
+    else kept.append(data);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file http_headers.cpp
+ * @brief This file contains the definition of the HttpHeaders class.
+ * @details It is responsible for storing, finding and removing HTTP headers.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "http_headers.hpp"
+#include "n_utils.hpp"
+
+#include <algorithm>
+#include <utility>
+
+// Constructors //
+
+/**
+ * @brief Copies only the headers in use, not the spare slots.
+ */
+HttpHeaders::HttpHeaders(const HttpHeaders& other) {
+    for(const auto& header : other) add(header.name, header.value);
+}
+
+HttpHeaders::HttpHeaders(HttpHeaders&& other) noexcept
+    : inlineSlots(std::move(other.inlineSlots)), spilled(std::move(other.spilled)), count(other.count) {
+    other.spilled.clear();
+    other.clear();
+}
+
+HttpHeaders& HttpHeaders::operator=(const HttpHeaders& other) {
+    if(this == &other) return *this;
+    clear();
+    for(const auto& header : other) add(header.name, header.value);
+    return *this;
+}
+
+HttpHeaders& HttpHeaders::operator=(HttpHeaders&& other) noexcept {
+    if(this == &other) return *this;
+    inlineSlots = std::move(other.inlineSlots);
+    spilled = std::move(other.spilled);
+    count = other.count;
+    other.spilled.clear();
+    other.clear();
+    return *this;
+}
+
+// Getters //
+
+/**
+ * @brief Gets the value of a header.
+ * @param name The header name, in any case.
+ * @return The value of the first header with that name, or `std::nullopt` if there is none.
+ * @note The view is invalidated by the next change to the headers.
+ */
+std::optional<std::string_view> HttpHeaders::get(std::string_view name) const noexcept {
+    size_t index = indexOf(name);
+    if(index == count) return std::nullopt;
+    return std::string_view(slots()[index].value);
+}
+
+// Setters //
+
+/**
+ * @brief Sets a header, replacing the value of an existing header with the same name.
+ * @param name The header name.
+ * @param value The header value.
+ */
+void HttpHeaders::set(std::string_view name, std::string_view value) {
+    size_t index = indexOf(name);
+    if(index < count) slots()[index].value.assign(value);
+    else add(name, value);
+}
+
+/**
+ * @brief Appends a header without checking for one with the same name.
+ * @details Used when copying headers received from a peer, which may repeat a name.
+ * @param name The header name.
+ * @param value The header value.
+ */
+void HttpHeaders::add(std::string_view name, std::string_view value) {
+    Header& header = nextSlot();
+    header.name.assign(name);
+    header.value.assign(value);
+}
+
+/**
+ * @brief Removes every header with a name, keeping the order of the others.
+ * @param name The header name, in any case.
+ * @return `true` if a header was removed, `false` if there was none.
+ */
+bool HttpHeaders::remove(std::string_view name) noexcept {
+    Header* headers = slots();
+    size_t kept = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(n_utils::str_manip::iequals(headers[i].name, name)) continue;
+        if(kept != i) std::swap(headers[kept], headers[i]); // Removed slots end up past the end for reuse
+        kept++;
+    }
+    bool removed = kept != count;
+    count = kept;
+    return removed;
+}
+
+// Helpers //
+
+/**
+ * @brief Finds the first header with a name.
+ * @param name The header name, in any case.
+ * @return The index of the header, or `size()` if there is none.
+ */
+size_t HttpHeaders::indexOf(std::string_view name) const noexcept {
+    const Header* headers = slots();
+    for(size_t i = 0; i < count; i++) {
+        if(n_utils::str_manip::iequals(headers[i].name, name)) return i;
+    }
+    return count;
+}
+
+/**
+ * @brief Claims the slot after the last header, growing the storage if every slot is used.
+ * @details The first spill moves the inline headers into a vector, which is then used
+ * for good, even after `clear()`.
+ * @return The claimed slot, whose strings may hold stale contents.
+ */
+HttpHeaders::Header& HttpHeaders::nextSlot() {
+    if(count == capacity()) {
+        if(spilled.empty()) {
+            spilled.resize(2 * INLINE_CAPACITY);
+            std::move(inlineSlots.begin(), inlineSlots.begin() + count, spilled.begin());
+        }
+        else {
+            spilled.resize(2 * spilled.size());
+        }
+    }
+    return slots()[count++];
+}
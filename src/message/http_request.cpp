@@ -20,13 +20,17 @@
 // Overrides //
 
 /**
- * @brief Gets the HTTP method of the request.
- * @return The HTTP method.
+ * @brief Composes the request line (GET /index.html HTTP/1.1).
+ * @details The line's buffer is reused, so changing a part again only allocates if it grows.
  */
-std::string HttpRequest::getStatusLine() const noexcept {
-    std::ostringstream oss;
-    oss << getMethod() << " " << getURI() << " " << getVersion();
-    return oss.str();
+void HttpRequest::composeStartLine() {
+    startLine.clear();
+    startLine.reserve(method.size() + uri.size() + version.size() + 2);
+    startLine += method;
+    startLine += ' ';
+    startLine += uri;
+    startLine += ' ';
+    startLine += version;
 }
 
 /**
@@ -45,7 +49,8 @@ void HttpRequest::display() const {
     }
     
     oss << n_utils::io_style::seperator("Body", '-', lineWidth) << "\n";
-    oss << getBody() << "\n";
+    if(!bodyFile.empty()) oss << "<contents of " << bodyFile << ">\n";
+    else oss << getBody() << "\n";
     oss << n_utils::io_style::seperator("", '=', lineWidth) << "\n";
     
     Logger::getInstance().print(oss.str());
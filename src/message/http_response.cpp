@@ -12,182 +12,108 @@
 #include "http_status.hpp"
 #include "logger.hpp"
 #include "n_utils.hpp"
+#include "response_parser.hpp"
 
 #include <iostream>
 #include <sstream>
 
 // Constructors //
 
-HttpResponse::HttpResponse() noexcept : status(http::status::Code::OK), keepAlive(true) {}
+HttpResponse::HttpResponse() : status(http::status::Code::OK), keepAlive(true) {
+    composeStartLine();
+}
 
 // Overrides //
 
 /**
- * @brief Generates the HTTP status line (HTTP/1.1 200 OK).
+ * @brief Composes the status line (HTTP/1.1 200 OK).
  */
-std::string HttpResponse::getStatusLine() const noexcept {
-    std::ostringstream oss;
-    oss << getVersion() << " " << static_cast<int>(status) << " " << http::status::toString(status);
-    return oss.str();
+void HttpResponse::composeStartLine() {
+    std::string_view reason = http::status::toString(status);
+    std::string code = std::to_string(static_cast<int>(status));
+    startLine.clear();
+    startLine.reserve(version.size() + code.size() + reason.size() + 2);
+    startLine += version;
+    startLine += ' ';
+    startLine += code;
+    startLine += ' ';
+    startLine += reason;
 }
 
 // Functions //
 
 /**
  * @brief Parse raw HTTP response data into a structured object.
- * @param rawData The raw HTTP response data.
+ * @param rawData The raw HTTP response data, holding exactly one response.
  * @return `true` if parsing succeeded, `false` if invalid.
  */
 bool HttpResponse::parse(std::string_view rawData) {
-    // Parse the start line and validate
-    size_t startLineEnd = rawData.find("\r\n");
-    if(startLineEnd == std::string_view::npos) {
-        Logger::getInstance().log("Malformed response: Missing start line end.", Logger::LogLevel::ERROR);
-        return false;
-    }
-    std::string_view startLine = rawData.substr(0, startLineEnd);
-    if(!parseStartLine(startLine)) {
-        Logger::getInstance().log("Malformed response: Invalid start line.", Logger::LogLevel::ERROR);
-        return false;
-    }
+    ResponseParser parser;
+    parser.feed(rawData);
+    if(parser.getState() == ResponseParser::State::BODY_UNTIL_CLOSE) parser.finish();
 
-    // Parse headers and validate
-    size_t headersStart = startLineEnd + 2; // Move past "\r\n"
-    size_t headersEnd = rawData.find("\r\n\r\n", headersStart);
-    if(headersEnd == std::string_view::npos) {
-        Logger::getInstance().log("Malformed response: Missing headers end.", Logger::LogLevel::ERROR);
+    if(parser.hasError()) {
+        Logger::getInstance().log("Malformed response: " + std::string(parser.getError()), Logger::LogLevel::ERROR);
         return false;
     }
-    std::string_view headersBlock = rawData.substr(headersStart, headersEnd - headersStart);
-    parseHeaders(headersBlock);
-
-    // Determine if the connection should be kept alive
-    determineKeepAlive();
-    
-    // Parse the body and validate
-    size_t bodyStart = headersEnd + 4; // Move past "\r\n\r\n"
-    if(!parseBody(rawData, bodyStart)) {
-        Logger::getInstance().log("Malformed request: Invalid body.", Logger::LogLevel::ERROR);
+    if(!parser.isComplete()) {
+        Logger::getInstance().log("Incomplete response body received.", Logger::LogLevel::ERROR);
         return false;
     }
 
-    return true;
-}
-
-/**
- * @brief Determine if the connection should be kept alive.
- */
-void HttpResponse::determineKeepAlive() {
-    if(auto connectionHeader = getHeader("Connection")) {
-        std::string connection = n_utils::str_manip::trim(*connectionHeader);
-        std::string lowerValue = n_utils::str_manip::toLower(connection);
-        keepAlive = (lowerValue == "keep-alive");
-    }
+    return parse(parser);
 }
 
 /**
- * @brief Parse the response line (Version, Code, Reason).
- * @param line The response line (HTTP/1.1 200 OK).
- * @return `true` if valid, `false` if malformed.
+ * @brief Copy an already parsed response into a structured object.
+ * @param parser A parser holding a complete response.
+ * @return `true` if the response was copied, `false` if the parser is not complete.
  */
-bool HttpResponse::parseStartLine(std::string_view line) {
-    // Find the version
-    size_t versionEnd = line.find(" ");
-    if(versionEnd == std::string_view::npos) {
-        Logger::getInstance().log("Malformed start line: Missing space after version.", Logger::LogLevel::ERROR);
-        return false;
-    }
-
-    // Find the status code
-    size_t statusCodeEnd = line.find(" ", versionEnd + 1);
-    if(statusCodeEnd == std::string_view::npos) {
-        Logger::getInstance().log("Malformed start line: Missing space after URI.", Logger::LogLevel::ERROR);
-        return false;
-    }
-
-    // Extract the version and status code
-    std::string versionStr = std::string(line.substr(0, versionEnd));
-    std::string statusCodeStr = std::string(line.substr(versionEnd + 1, statusCodeEnd - versionEnd - 1));
-    try {
-        http::status::Code code = http::status::fromString(statusCodeStr);
-        if(code == http::status::Code::INVALID) {
-            Logger::getInstance().log("Invalid status code.", Logger::LogLevel::ERROR);
-            return false;
+bool HttpResponse::parse(const ResponseParser& parser) {
+    if(!parser.isComplete()) return false;
+
+    version = parser.getVersion();
+    setStatus(parser.getStatus()); // Composes the status line once for both
+    headers.clear();
+    for(size_t i = 0; i < parser.getHeaderCount(); i++) {
+        std::string_view name = parser.getHeaderName(i);
+        if(parser.isDecoded()) {
+            // The body is held decoded, so the headers describe it that way
+            if(n_utils::str_manip::iequals(name, "Content-Encoding")) continue;
+            if(n_utils::str_manip::iequals(name, "Content-Length")) {
+                headers.add(name, std::to_string(parser.getDecodedSize()));
+                continue;
+            }
         }
-        setVersion(versionStr);
-        setStatus(code);
-    }
-    catch(const std::exception& e){
-        Logger::getInstance().log("Status code could not be parsed.", Logger::LogLevel::ERROR);
-        return false;
+        headers.add(name, parser.getHeaderValue(i)); // Keeps repeated headers like Set-Cookie
     }
+    setBody(std::string(parser.getBody()));
 
+    // Determine if the connection should be kept alive
+    determineKeepAlive();
     return true;
 }
 
 /**
- * @brief Parse the request headers.
- * @param headersBlock The headers as a string_view.
+ * @brief Finds where the first response in a buffer ends without copying it.
+ * @param rawData The received data, which may hold a partial or several responses.
+ * @return The length of the first complete response, or `std::nullopt` if more data is needed
+ * (or the body is delimited by the connection closing).
  */
-void HttpResponse::parseHeaders(std::string_view headersBlock) {
-    size_t pos = 0;
-    while(pos < headersBlock.size()) {
-        size_t end = headersBlock.find("\r\n", pos);
-        if(end == std::string_view::npos) {
-            end = headersBlock.size();
-        }
-        std::string_view header = headersBlock.substr(pos, end - pos);
-        pos = (end == headersBlock.size() ? end : end + 2); // Move past "\r\n" if present
-
-        if(header.empty()) continue;
-
-        size_t separator = header.find(":");
-        if(separator != std::string_view::npos) {
-            // Allow optional whitespace after the colon
-            size_t valueStart = header.find_first_not_of(" ", separator + 1);
-            std::string_view value = (valueStart != std::string_view::npos)
-                ? header.substr(valueStart)
-                : "";
-            setHeader(header.substr(0, separator), value);
-        }
-    }
+std::optional<size_t> HttpResponse::messageLength(std::string_view rawData) {
+    ResponseParser parser;
+    if(parser.feed(rawData) != ResponseParser::State::COMPLETE) return std::nullopt;
+    return parser.getMessageSize();
 }
 
 /**
- * @brief Parse the response body.
- * @param rawData The raw response data.
- * @param bodyStart The index where the body starts.
- * @return `true` if valid, `false` if malformed.
+ * @brief Determine if the connection should be kept alive.
  */
-bool HttpResponse::parseBody(std::string_view rawData, const size_t& bodyStart) {
-    if(bodyStart < rawData.size()) {
-        // Check for Content-Length (impl. Transfer-Encoding later)
-        if(auto contentLengthHeader = getHeader("Content-Length")) {
-            try {
-                size_t contentLength = std::stoul(std::string(*contentLengthHeader));
-                if(rawData.size() - bodyStart >= contentLength) {
-                    setBody(rawData.substr(bodyStart, contentLength));
-                } 
-                else {
-                    Logger::getInstance().log("Incomplete response body received.", Logger::LogLevel::ERROR);
-                    return false;
-                }
-            } 
-            catch(const std::invalid_argument& e) {
-                Logger::getInstance().log("Invalid Content-Length header.", Logger::LogLevel::ERROR);
-                return false;
-            }
-            catch(const std::out_of_range& e) {
-                Logger::getInstance().log("Content-Length value out of range.", Logger::LogLevel::ERROR);
-                return false;
-            }
-        } 
-    }
-    else {
-        setBody("");
+void HttpResponse::determineKeepAlive() {
+    keepAlive = true;
+    if(auto connectionHeader = getHeader("Connection")) {
+        keepAlive = n_utils::str_manip::iequals(*connectionHeader, "keep-alive");
     }
-
-    return true;
 }
 
 // Overrides //
@@ -0,0 +1,129 @@
+/**
+ * @file prepared_request.cpp
+ * @brief This file contains the definition of the PreparedRequest class.
+ * @details It is responsible for serializing a request template once and filling in
+ * its variable fields per send.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "prepared_request.hpp"
+#include "http_method.hpp"
+#include "http_request.hpp"
+#include "n_utils.hpp"
+
+// Constants //
+static constexpr std::string_view CRLF = "\r\n";
+static constexpr std::string_view HEADER_END = "\r\n\r\n"; // Ends the variable header and the head
+
+// Constructors //
+
+/**
+ * @brief Serializes the constant part of a request.
+ * @param base The request to use as the template. A body file is not supported and is ignored.
+ * @param variableHeader The name of a header whose value is given per send, or empty for none.
+ */
+PreparedRequest::PreparedRequest(const HttpRequest& base, std::string_view variableHeader)
+    : pipelinable(http::method::fromString(base.getMethod()) == http::method::Method::GET),
+      idempotent(http::method::isIdempotent(http::method::fromString(base.getMethod()))) {
+    prefix += base.getMethod();
+    prefix += ' ';
+
+    suffix += ' ';
+    suffix += base.getVersion();
+    suffix += CRLF;
+    for(const auto& [key, value] : base.getAllHeaders()) {
+        if(!variableHeader.empty() && n_utils::str_manip::iequals(key, variableHeader)) continue;
+        suffix += key;
+        suffix += ": ";
+        suffix += value;
+        suffix += CRLF;
+    }
+
+    if(variableHeader.empty()) {
+        suffix += CRLF; // Blank line between headers and body
+    }
+    else {
+        headerPrefix += variableHeader;
+        headerPrefix += ": ";
+    }
+    body = base.getBody();
+}
+
+// Functions //
+
+/**
+ * @brief Points iovecs at the pieces of one request, without copying anything.
+ * @param iov The iovecs to fill. They point into this object and the given views.
+ * @param uri The URI to request.
+ * @param headerValue The value of the variable header. Empty leaves the header out.
+ * @return The number of iovecs filled.
+ */
+int PreparedRequest::fill(struct iovec (&iov)[MAX_IOV], std::string_view uri, std::string_view headerValue) const noexcept {
+    int count = 0;
+    auto add = [&](std::string_view piece) {
+        if(!piece.empty()) iov[count++] = {const_cast<char*>(piece.data()), piece.size()};
+    };
+
+    add(prefix);
+    add(uri);
+    add(suffix);
+    if(hasVariableHeader()) {
+        if(!headerValue.empty()) {
+            add(headerPrefix);
+            add(headerValue);
+        }
+        add(headerEnd(headerValue));
+    }
+    add(body);
+    return count;
+}
+
+/**
+ * @brief Appends one serialized request to a buffer.
+ * @param out The buffer to append to.
+ * @param uri The URI to request.
+ * @param headerValue The value of the variable header. Empty leaves the header out.
+ */
+void PreparedRequest::appendTo(std::string& out, std::string_view uri, std::string_view headerValue) const {
+    out.reserve(out.size() + size(uri, headerValue));
+    out += prefix;
+    out += uri;
+    out += suffix;
+    if(hasVariableHeader()) {
+        if(!headerValue.empty()) {
+            out += headerPrefix;
+            out += headerValue;
+        }
+        out += headerEnd(headerValue);
+    }
+    out += body;
+}
+
+/**
+ * @brief Computes the size of one serialized request.
+ * @param uri The URI to request.
+ * @param headerValue The value of the variable header.
+ * @return The size in bytes.
+ */
+size_t PreparedRequest::size(std::string_view uri, std::string_view headerValue) const noexcept {
+    size_t size = prefix.size() + uri.size() + suffix.size() + body.size();
+    if(hasVariableHeader()) {
+        if(!headerValue.empty()) size += headerPrefix.size() + headerValue.size();
+        size += headerEnd(headerValue).size();
+    }
+    return size;
+}
+
+// Helpers //
+
+/**
+ * @brief Gets the bytes that end the head after the variable header.
+ * @param headerValue The value of the variable header.
+ * @return The header's CRLF and the blank line, or only the blank line if the header is left out.
+ */
+std::string_view PreparedRequest::headerEnd(std::string_view headerValue) const noexcept {
+    return headerValue.empty() ? CRLF : HEADER_END;
+}
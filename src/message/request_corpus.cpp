@@ -0,0 +1,187 @@
+/**
+ * @file request_corpus.cpp
+ * @brief This file contains the definition of the RequestCorpus class.
+ * @details It is responsible for mapping and checking corpus files, and for writing them.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "http_method.hpp"
+#include "logger.hpp"
+#include "request_corpus.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+// Constructors //
+
+/**
+ * @brief Constructs an empty corpus with nothing mapped.
+ */
+RequestCorpus::RequestCorpus() noexcept
+    : mapping(nullptr), mappingSize(0), data(nullptr), offsets(nullptr), count(0), dataSize(0), flags(0) {}
+
+/**
+ * @brief Unmaps the corpus. Views it handed out are no longer valid.
+ */
+RequestCorpus::~RequestCorpus() noexcept {
+    unmap();
+}
+
+// Functions //
+
+/**
+ * @brief Maps a corpus file, replacing any corpus mapped before.
+ * @details Only the header and the first and last offsets are read, so loading takes the same
+ * time however many requests the file holds. Readahead of the rest is started in the background.
+ * @param path The corpus file.
+ * @return `true` if the file is a complete corpus of this format version, `false` otherwise.
+ */
+bool RequestCorpus::load(const std::string& path) {
+    unmap();
+    auto reject = [&](const std::string& reason) {
+        Logger::getInstance().log("Cannot replay " + path + ": " + reason, Logger::LogLevel::ERROR);
+        unmap();
+        return false;
+    };
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return reject(std::strerror(errno));
+    struct stat info;
+    if(fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return reject("not a regular file");
+    }
+    if(static_cast<uint64_t>(info.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return reject("not a request corpus");
+    }
+
+    mappingSize = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if(mapped == MAP_FAILED) return reject(std::strerror(errno));
+    mapping = mapped;
+    madvise(mapping, mappingSize, MADV_WILLNEED);
+
+    // The mapping is page aligned, so the header and offset table are aligned too
+    const FileHeader& header = *static_cast<const FileHeader*>(mapping);
+    if(std::memcmp(header.magic, "HRQC", sizeof(header.magic)) != 0) return reject("not a request corpus");
+    if(header.version != FORMAT_VERSION) return reject("format version " + std::to_string(header.version) + " is not supported");
+
+    // The file must end exactly where the header says the offset table does
+    const uint64_t limit = std::numeric_limits<uint64_t>::max() / 2;
+    if(header.dataSize > limit || header.count > limit / sizeof(uint64_t)) return reject("the header is damaged");
+    uint64_t tableStart = sizeof(FileHeader) + padded(header.dataSize);
+    if(tableStart + (header.count + 1) * sizeof(uint64_t) != mappingSize) return reject("the file is truncated");
+
+    data = static_cast<const char*>(mapping) + sizeof(FileHeader);
+    offsets = reinterpret_cast<const uint64_t*>(static_cast<const char*>(mapping) + tableStart);
+    if(offsets[0] != 0 || offsets[header.count] != header.dataSize) return reject("the offset table is damaged");
+
+    count = static_cast<size_t>(header.count);
+    dataSize = header.dataSize;
+    flags = header.flags;
+    Logger::getInstance().log(
+        "Mapped " + std::to_string(count) + " requests (" + std::to_string(dataSize) + " bytes) from " + path, Logger::LogLevel::DEBUG
+    );
+    return true;
+}
+
+// Helpers //
+
+/**
+ * @brief Unmaps the file, leaving the corpus empty.
+ */
+void RequestCorpus::unmap() noexcept {
+    if(mapping) munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    data = nullptr;
+    offsets = nullptr;
+    count = 0;
+    dataSize = 0;
+    flags = 0;
+}
+
+// Writer //
+
+/**
+ * @brief Starts writing a corpus next to its final path.
+ * @param path Where `finish()` puts the corpus.
+ */
+RequestCorpus::Writer::Writer(std::string path)
+    : path(std::move(path)), flags(PIPELINABLE), finished(false)
+{
+    temporary = this->path + ".tmp";
+    file.open(temporary, std::ios::binary | std::ios::trunc);
+    FileHeader placeholder{}; // Rewritten once the counts are known
+    file.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+    offsets.push_back(0);
+}
+
+/**
+ * @brief Removes the temporary file of a corpus that was not finished.
+ */
+RequestCorpus::Writer::~Writer() noexcept {
+    if(finished) return;
+    file.close();
+    unlink(temporary.c_str());
+}
+
+/**
+ * @brief Appends one serialized request.
+ * @param request The request's wire bytes, such as the output of `HttpClient::serializeRequest()`.
+ * @return `true` if it was written, `false` if it is empty or the write failed.
+ */
+bool RequestCorpus::Writer::add(std::string_view request) {
+    if(finished || request.empty() || !file) return false;
+
+    std::string_view method = request.substr(0, request.find(' '));
+    if(http::method::fromString(method) != http::method::Method::GET) flags &= ~PIPELINABLE;
+
+    file.write(request.data(), static_cast<std::streamsize>(request.size()));
+    offsets.push_back(offsets.back() + request.size());
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Writes the offset table and header, then moves the corpus to its final path.
+ * @return `true` if the corpus was written, `false` otherwise.
+ */
+bool RequestCorpus::Writer::finish() {
+    if(finished) return false;
+
+    FileHeader header{};
+    std::memcpy(header.magic, "HRQC", sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.flags = flags;
+    header.count = size();
+    header.dataSize = offsets.back();
+
+    static const char padding[8] = {};
+    file.write(padding, static_cast<std::streamsize>(padded(header.dataSize) - header.dataSize));
+    file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if(!file) {
+        Logger::getInstance().log("Failed to write corpus to " + temporary, Logger::LogLevel::ERROR);
+        return false;
+    }
+    if(std::rename(temporary.c_str(), path.c_str()) != 0) {
+        Logger::getInstance().log("Failed to write corpus to " + path + ": " + std::strerror(errno), Logger::LogLevel::ERROR);
+        return false;
+    }
+    finished = true;
+    return true;
+}
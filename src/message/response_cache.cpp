@@ -0,0 +1,451 @@
+/**
+ * @file response_cache.cpp
+ * @brief This file contains the definition of the ResponseCache class.
+ * @details It is responsible for deciding which responses can be stored and for how long,
+ * evicting the least recently used ones, and keeping them on disk when asked to.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "http_method.hpp"
+#include "http_request.hpp"
+#include "logger.hpp"
+#include "n_utils.hpp"
+#include "response_cache.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+
+// Constructors //
+
+/**
+ * @brief Constructs an empty cache that only keeps responses in memory.
+ * @param capacity The bytes of responses (bodies and headers) kept in memory. A single response
+ * may use at most an eighth of it.
+ */
+ResponseCache::ResponseCache(size_t capacity)
+    : capacity(capacity), maxEntrySize(capacity / 8), memoryUsed(0) {}
+
+// Setters //
+
+/**
+ * @brief Keeps stored responses in a directory as well, so they outlive the process.
+ * @param path The directory. It is created if it does not exist.
+ * @throws std::runtime_error if the directory cannot be created or is not a directory.
+ */
+void ResponseCache::setDiskDirectory(const std::string& path) {
+    if(mkdir(path.c_str(), 0755) < 0 && errno != EEXIST) {
+        throw std::runtime_error("Failed to create cache directory " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if(stat(path.c_str(), &info) < 0 || !S_ISDIR(info.st_mode)) {
+        throw std::runtime_error("Cache directory " + path + " is not a directory.");
+    }
+    diskDirectory = path;
+}
+
+// Functions //
+
+/**
+ * @brief Finds the stored response for a key, fresh or not, and marks it as recently used.
+ * @details A response missing from memory is read back from the disk directory, if one is set.
+ * @param key The key, from `keyOf()`.
+ * @return The entry, valid until the cache is next changed, or `nullptr` if there is none.
+ */
+const ResponseCache::Entry* ResponseCache::lookup(const std::string& key) {
+    auto it = entries.find(key);
+    if(it != entries.end()) {
+        order.splice(order.begin(), order, it->second);
+        return &it->second->second;
+    }
+
+    if(diskDirectory.empty()) return nullptr;
+    std::optional<Entry> entry = readFromDisk(key);
+    if(!entry) return nullptr;
+    Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Loaded cached response for " + key + " from disk."; });
+    return insert(key, std::move(*entry));
+}
+
+/**
+ * @brief Stores a response if the cache may keep it, replacing the previous one for the key.
+ * @details The response is kept if its status is cacheable by default, it is not `no-store` or
+ * `Vary: *`, it fits, and it is either fresh or can be revalidated. Its body is framed by a
+ * Content-Length, as any transfer coding has already been removed.
+ * @param key The key, from `keyOf()`.
+ * @param response The complete response, with its body.
+ * @param now When the response was received.
+ * @return `true` if it was stored, `false` otherwise. A previous response is kept either way.
+ */
+bool ResponseCache::store(const std::string& key, HttpResponse response, Clock::time_point now) {
+    if(!isHeuristicallyCacheable(response.getStatus())) return false;
+    if(parseDirectives(response).noStore) return false;
+    if(auto vary = response.getHeader("Vary"); vary && n_utils::str_manip::trim(std::string(*vary)) == "*") return false;
+
+    while(response.removeHeader("Transfer-Encoding")) {}
+    response.setHeader("Content-Length", std::to_string(response.getBody().size()));
+
+    Entry entry;
+    entry.response = std::move(response);
+    entry.stored = now;
+    computeFreshness(entry);
+    if(!entry.isFresh(now) && !entry.hasValidators()) return false; // Could never be used
+    entry.size = sizeOf(entry.response);
+    if(entry.size > maxEntrySize) return false;
+
+    const Entry* stored = insert(key, std::move(entry));
+    if(!diskDirectory.empty()) writeToDisk(key, *stored);
+    Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] {
+        return "Cached response for " + key + " (" + std::to_string(stored->size) + " bytes, " + std::to_string(size()) + " cached).";
+    });
+    return true;
+}
+
+/**
+ * @brief Refreshes a stored response with the headers of a 304 Not Modified.
+ * @details The 304's headers replace the stored ones of the same name, except for the framing
+ * and content coding headers, and the freshness is computed again from its time (RFC 9111, section 4.3.4).
+ * @param key The key, from `keyOf()`.
+ * @param notModified The 304 response.
+ * @param now When the 304 was received.
+ * @return The refreshed entry, valid until the cache is next changed, or `nullptr` if there is
+ * no stored response for the key.
+ */
+const ResponseCache::Entry* ResponseCache::freshen(const std::string& key, const HttpResponse& notModified, Clock::time_point now) {
+    if(!lookup(key)) return nullptr;
+    Entry& entry = order.front().second; // Moved to the front by the lookup
+
+    for(const auto& [name, value] : notModified.getAllHeaders()) {
+        bool framing = n_utils::str_manip::iequals(name, "Content-Length") || n_utils::str_manip::iequals(name, "Transfer-Encoding")
+                    || n_utils::str_manip::iequals(name, "Content-Encoding"); // The stored body is decoded
+        if(!framing) entry.response.setHeader(name, value);
+    }
+    entry.stored = now;
+    computeFreshness(entry);
+
+    memoryUsed -= entry.size;
+    entry.size = sizeOf(entry.response);
+    memoryUsed += entry.size;
+    if(!diskDirectory.empty()) writeToDisk(key, entry);
+    return &entry;
+}
+
+/**
+ * @brief Drops the stored response for a key, in memory and on disk.
+ * @param key The key, from `keyOf()`.
+ */
+void ResponseCache::remove(const std::string& key) {
+    auto it = entries.find(key);
+    if(it != entries.end()) evict(it->second);
+    if(!diskDirectory.empty()) unlink(pathOf(key).c_str());
+}
+
+/**
+ * @brief Drops every response held in memory. Responses on disk are kept.
+ */
+void ResponseCache::clear() noexcept {
+    entries.clear();
+    order.clear();
+    memoryUsed = 0;
+}
+
+/**
+ * @brief Builds the key a response is stored under.
+ * @param host The host or IP address of the server.
+ * @param port The port of the server.
+ * @param uri The request URI.
+ * @return The key, "host:port/uri" with IPv6 addresses in brackets.
+ */
+std::string ResponseCache::keyOf(const std::string& host, const std::string& port, std::string_view uri) {
+    bool ipv6 = host.find(':') != std::string::npos && host.front() != '[';
+    std::string key;
+    key.reserve(host.size() + port.size() + uri.size() + 3);
+    if(ipv6) key += '[';
+    key += host;
+    if(ipv6) key += ']';
+    key += ':';
+    key += port;
+    key += uri;
+    return key;
+}
+
+/**
+ * @brief Checks if a request may be answered from the cache and its response stored.
+ * @param request The request.
+ * @return `true` for a GET without a body, a range or a `Cache-Control: no-store`, `false` otherwise.
+ */
+bool ResponseCache::isCacheable(const HttpRequest& request) noexcept {
+    if(http::method::fromString(request.getMethod()) != http::method::Method::GET) return false;
+    if(!request.getBody().empty() || !request.getBodyFile().empty() || request.getHeader("Range")) return false;
+
+    auto control = request.getHeader("Cache-Control");
+    return !control || control->find("no-store") == std::string_view::npos;
+}
+
+/**
+ * @brief Makes a request conditional on the stored response being unchanged.
+ * @details The validators are copied as the server sent them: the ETag to If-None-Match, and the
+ * Last-Modified date to If-Modified-Since.
+ * @param entry The stored response.
+ * @param request The request to add the headers to.
+ */
+void ResponseCache::addValidators(const Entry& entry, HttpRequest& request) {
+    if(auto etag = entry.response.getHeader("ETag")) request.setHeader("If-None-Match", *etag);
+    if(auto modified = entry.response.getHeader("Last-Modified")) request.setHeader("If-Modified-Since", *modified);
+}
+
+// Helpers //
+
+/**
+ * @brief Puts an entry at the front, replacing the key's previous one, then evicts down to the capacity.
+ * @param key The key.
+ * @param entry The entry.
+ * @return The inserted entry, which is never evicted by its own insertion.
+ */
+const ResponseCache::Entry* ResponseCache::insert(const std::string& key, Entry entry) {
+    auto existing = entries.find(key);
+    if(existing != entries.end()) evict(existing->second);
+
+    memoryUsed += entry.size;
+    order.emplace_front(key, std::move(entry));
+    entries[key] = order.begin();
+    while(memoryUsed > capacity && order.size() > 1) evict(std::prev(order.end()));
+    return &order.front().second;
+}
+
+/**
+ * @brief Drops one entry from memory.
+ * @param it The entry's position in the LRU list.
+ */
+void ResponseCache::evict(LruList::iterator it) noexcept {
+    memoryUsed -= it->second.size;
+    entries.erase(it->first);
+    order.erase(it);
+}
+
+/**
+ * @brief Computes when a stored response stops being fresh.
+ * @details The lifetime comes from `max-age`, else `Expires` minus `Date`, else a tenth of the
+ * time since `Last-Modified`. The `Age` the response already had is subtracted. An invalid
+ * `Expires` means the response is already stale.
+ * @param entry The entry, whose `stored` time is set.
+ */
+void ResponseCache::computeFreshness(Entry& entry) {
+    const HttpResponse& response = entry.response;
+    Directives directives = parseDirectives(response);
+    entry.noCache = directives.noCache;
+
+    Clock::time_point date = entry.stored;
+    if(auto header = response.getHeader("Date")) date = parseDate(*header).value_or(entry.stored);
+
+    long lifetime = 0;
+    if(directives.maxAge) {
+        lifetime = *directives.maxAge;
+    }
+    else if(auto expires = response.getHeader("Expires")) {
+        if(auto when = parseDate(*expires)) lifetime = std::chrono::duration_cast<std::chrono::seconds>(*when - date).count();
+    }
+    else if(auto modified = response.getHeader("Last-Modified")) {
+        if(auto when = parseDate(*modified); when && *when < date) {
+            lifetime = std::min(std::chrono::duration_cast<std::chrono::seconds>(date - *when).count() / 10, HEURISTIC_LIMIT_S);
+        }
+    }
+
+    long age = 0;
+    if(auto header = response.getHeader("Age")) age = parseSeconds(*header).value_or(0);
+    entry.expires = entry.stored + std::chrono::seconds(lifetime - age);
+}
+
+/**
+ * @brief Reads the Cache-Control directives of a response, from every Cache-Control header.
+ * @details Without a Cache-Control header, `Pragma: no-cache` counts as `no-cache`.
+ * @param response The response.
+ * @return The directives.
+ */
+ResponseCache::Directives ResponseCache::parseDirectives(const HttpResponse& response) {
+    Directives directives;
+    bool found = false;
+    for(const auto& [name, value] : response.getAllHeaders()) {
+        if(!n_utils::str_manip::iequals(name, "Cache-Control")) continue;
+        found = true;
+
+        std::string_view list = value;
+        while(!list.empty()) {
+            size_t comma = list.find(',');
+            std::string directive = n_utils::str_manip::trim(std::string(list.substr(0, comma)));
+            list = (comma == std::string_view::npos) ? std::string_view() : list.substr(comma + 1);
+
+            std::string_view view = directive;
+            size_t equals = view.find('=');
+            std::string_view directiveName = view.substr(0, equals);
+            if(n_utils::str_manip::iequals(directiveName, "no-store")) directives.noStore = true;
+            else if(n_utils::str_manip::iequals(directiveName, "no-cache")) directives.noCache = true;
+            else if(n_utils::str_manip::iequals(directiveName, "max-age") && equals != std::string_view::npos) {
+                std::string_view argument = view.substr(equals + 1);
+                if(argument.size() >= 2 && argument.front() == '"' && argument.back() == '"') argument = argument.substr(1, argument.size() - 2);
+                directives.maxAge = parseSeconds(argument).value_or(0); // An invalid max-age is stale
+            }
+        }
+    }
+
+    if(!found) {
+        auto pragma = response.getHeader("Pragma");
+        directives.noCache = pragma && n_utils::str_manip::iequals(n_utils::str_manip::trim(std::string(*pragma)), "no-cache");
+    }
+    return directives;
+}
+
+/**
+ * @brief Parses an HTTP date in the preferred IMF-fixdate format, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+ * @param text The date.
+ * @return The time, or `std::nullopt` if the date is invalid.
+ */
+std::optional<ResponseCache::Clock::time_point> ResponseCache::parseDate(std::string_view text) noexcept {
+    char buffer[64];
+    if(text.size() >= sizeof(buffer)) return std::nullopt;
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+
+    struct tm parts;
+    std::memset(&parts, 0, sizeof(parts));
+    const char* end = strptime(buffer, "%a, %d %b %Y %H:%M:%S GMT", &parts);
+    if(!end || *end != '\0') return std::nullopt;
+    return Clock::from_time_t(timegm(&parts));
+}
+
+/**
+ * @brief Parses a non-negative number of seconds, as used by `max-age` and `Age`.
+ * @param text The number.
+ * @return The seconds, or `std::nullopt` if the text is not a number. Overflows are capped.
+ */
+std::optional<long> ResponseCache::parseSeconds(std::string_view text) noexcept {
+    long seconds = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), seconds);
+    if(text.empty() || end != text.data() + text.size() || seconds < 0) {
+        if(error != std::errc::result_out_of_range || text.front() == '-') return std::nullopt;
+        seconds = 0x7FFFFFFF; // RFC 9111 section 1.2.2: cap at 2^31 seconds
+    }
+    return std::min(seconds, 0x7FFFFFFFL);
+}
+
+/**
+ * @brief Checks if a status may be stored without explicit freshness (RFC 9110, section 15.1).
+ * @param status The status code.
+ * @return `true` if responses with the status can be cached, `false` otherwise.
+ * @note 206 Partial Content is left out, as ranges are not combined.
+ */
+bool ResponseCache::isHeuristicallyCacheable(http::status::Code status) noexcept {
+    switch(static_cast<int>(status)) {
+        case 200: case 203: case 204: case 300: case 301: case 308:
+        case 404: case 405: case 410: case 414: case 501:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Counts the bytes a response holds: the status line, the headers and the body.
+ * @param response The response.
+ * @return The size in bytes.
+ */
+size_t ResponseCache::sizeOf(const HttpResponse& response) noexcept {
+    size_t size = response.getStatusLine().size() + response.getBody().size();
+    for(const auto& [name, value] : response.getAllHeaders()) size += name.size() + value.size() + 4;
+    return size;
+}
+
+// Disk Store //
+
+/**
+ * @brief Picks the file a key is stored in, named after the key's FNV-1a hash.
+ * @param key The key.
+ * @return The path of the file.
+ */
+std::string ResponseCache::pathOf(const std::string& key) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.http", static_cast<unsigned long long>(hash));
+    return diskDirectory + "/" + name;
+}
+
+/**
+ * @brief Writes an entry to its file, replacing the old one only once it is complete.
+ * @details The file holds the key, the time it was received (in seconds since the epoch),
+ * then the response as it would arrive on the wire.
+ * @param key The key.
+ * @param entry The entry.
+ */
+void ResponseCache::writeToDisk(const std::string& key, const Entry& entry) const {
+    std::string path = pathOf(key);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file << key << '\n' << Clock::to_time_t(entry.stored) << '\n' << entry.response.getStatusLine() << "\r\n";
+        for(const auto& [name, value] : entry.response.getAllHeaders()) file << name << ": " << value << "\r\n";
+        file << "\r\n";
+        file.write(entry.response.getBody().data(), entry.response.getBody().size());
+        if(!file) {
+            Logger::getInstance().log("Failed to write cache file " + temporary + ".", Logger::LogLevel::WARN);
+            unlink(temporary.c_str());
+            return;
+        }
+    }
+    if(std::rename(temporary.c_str(), path.c_str()) < 0) {
+        Logger::getInstance().log("Failed to write cache file " + path + ": " + std::strerror(errno), Logger::LogLevel::WARN);
+        unlink(temporary.c_str());
+    }
+}
+
+/**
+ * @brief Reads an entry back from its file through a read-only mapping.
+ * @param key The key.
+ * @return The entry, or `std::nullopt` if the file is missing, unreadable or holds another key.
+ */
+std::optional<ResponseCache::Entry> ResponseCache::readFromDisk(const std::string& key) const {
+    int fd = open(pathOf(key).c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return std::nullopt;
+
+    struct stat info;
+    if(fstat(fd, &info) < 0 || info.st_size == 0) {
+        close(fd);
+        return std::nullopt;
+    }
+    size_t length = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file open
+    if(mapping == MAP_FAILED) return std::nullopt;
+
+    std::optional<Entry> entry;
+    std::string_view data(static_cast<const char*>(mapping), length);
+    size_t keyEnd = data.find('\n');
+    size_t timeEnd = (keyEnd == std::string_view::npos) ? keyEnd : data.find('\n', keyEnd + 1);
+    if(timeEnd != std::string_view::npos && data.substr(0, keyEnd) == key) {
+        auto stored = parseSeconds(data.substr(keyEnd + 1, timeEnd - keyEnd - 1));
+        Entry loaded;
+        if(stored && loaded.response.parse(data.substr(timeEnd + 1))) {
+            loaded.stored = Clock::from_time_t(static_cast<std::time_t>(*stored));
+            computeFreshness(loaded);
+            loaded.size = sizeOf(loaded.response);
+            entry = std::move(loaded);
+        }
+    }
+    munmap(mapping, length);
+    return entry;
+}
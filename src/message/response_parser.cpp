@@ -0,0 +1,469 @@
+/**
+ * @file response_parser.cpp
+ * @brief This file contains the definition of the ResponseParser class.
+ * @details It is a resumable HTTP response parser that works directly on a receive
+ * buffer owned by the connection, without copying the response.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "response_parser.hpp"
+#include "n_utils.hpp"
+
+#include <algorithm>
+#include <string>
+
+// Constructors //
+
+/**
+ * @brief Constructs a new ResponseParser object, ready for the first response.
+ */
+ResponseParser::ResponseParser() noexcept {
+    reset();
+}
+
+// Lifecycle //
+
+/**
+ * @brief Prepares the parser for the next response.
+ * @note The header storage keeps its capacity, so parsing many responses does not reallocate.
+ * The body sink is kept.
+ */
+void ResponseParser::reset() noexcept {
+    window = {};
+    state = State::START_LINE;
+    scanPos = 0;
+    error = {};
+    version = {};
+    reason = {};
+    status = http::status::Code::INVALID;
+    headers.clear();
+    bodyStart = 0;
+    bodyRemaining = 0;
+    bodyBytes = 0;
+    messageEnd = 0;
+    chunked = false;
+    closeDelimited = false;
+    decodedBody.clear();
+    decoder.reset();
+}
+
+/**
+ * @brief Parses as much of the response as the window allows.
+ * @param window The response received so far, starting at its first byte. It may hold bytes
+ * of a following response, which are left unparsed.
+ * @return The new state of the parser.
+ */
+ResponseParser::State ResponseParser::feed(std::string_view window) {
+    this->window = window;
+
+    while(true) {
+        switch(state) {
+            // Start line and headers, one CRLF terminated line at a time
+            case State::START_LINE:
+            case State::HEADERS: {
+                size_t lineEnd = window.find("\r\n", scanPos);
+                if(lineEnd == std::string_view::npos) {
+                    if(window.size() > MAX_HEADER_BYTES) return invalid("Headers too large.");
+                    return state;
+                }
+
+                std::string_view line = window.substr(scanPos, lineEnd - scanPos);
+                size_t lineOffset = scanPos;
+                scanPos = lineEnd + 2; // Move past "\r\n"
+
+                if(state == State::START_LINE) {
+                    if(!parseStartLine(line)) return state;
+                    state = State::HEADERS;
+                }
+                else if(line.empty()) {
+                    bodyStart = scanPos;
+                    beginBody();
+                }
+                else if(!parseHeader(line, lineOffset)) {
+                    return state;
+                }
+                break;
+            }
+
+            // Body with a known length
+            case State::BODY: {
+                size_t length = std::min(window.size() - scanPos, bodyRemaining);
+                if(!deliver(scanPos, length)) return state;
+                scanPos += length;
+                bodyRemaining -= length;
+                if(bodyRemaining > 0) return state;
+                complete(scanPos);
+                break;
+            }
+
+            // Everything received belongs to the body until the connection closes
+            case State::BODY_UNTIL_CLOSE:
+                if(!deliver(scanPos, window.size() - scanPos)) return state;
+                scanPos = window.size();
+                return state;
+
+            // Chunked body (size line, data, CRLF), ending with a zero size chunk
+            case State::CHUNK_SIZE: {
+                size_t lineEnd = window.find("\r\n", scanPos);
+                if(lineEnd == std::string_view::npos) {
+                    if(window.size() - scanPos > MAX_CHUNK_LINE) return invalid("Chunk size line too long.");
+                    return state;
+                }
+                std::string_view line = window.substr(scanPos, lineEnd - scanPos);
+                scanPos = lineEnd + 2; // Move past "\r\n"
+                if(!parseChunkSize(line)) return state;
+                state = (bodyRemaining > 0) ? State::CHUNK_DATA : State::TRAILERS;
+                break;
+            }
+            case State::CHUNK_DATA: {
+                size_t length = std::min(window.size() - scanPos, bodyRemaining);
+                if(!deliver(scanPos, length)) return state;
+                scanPos += length;
+                bodyRemaining -= length;
+                if(bodyRemaining > 0) return state;
+                state = State::CHUNK_DATA_END;
+                break;
+            }
+            case State::CHUNK_DATA_END:
+                if(window.size() - scanPos < 2) return state;
+                if(window.compare(scanPos, 2, "\r\n") != 0) return invalid("Missing CRLF after chunk data.");
+                scanPos += 2;
+                state = State::CHUNK_SIZE;
+                break;
+
+            // Trailer fields are kept with the headers
+            case State::TRAILERS: {
+                size_t lineEnd = window.find("\r\n", scanPos);
+                if(lineEnd == std::string_view::npos) {
+                    if(window.size() - scanPos > MAX_HEADER_BYTES) return invalid("Trailers too large.");
+                    return state;
+                }
+                std::string_view line = window.substr(scanPos, lineEnd - scanPos);
+                size_t lineOffset = scanPos;
+                scanPos = lineEnd + 2; // Move past "\r\n"
+
+                if(line.empty()) {
+                    complete(scanPos);
+                }
+                else if(!parseHeader(line, lineOffset)) {
+                    return state;
+                }
+                break;
+            }
+
+            case State::COMPLETE:
+            case State::INVALID:
+                return state;
+        }
+    }
+}
+
+/**
+ * @brief Tells the parser the connection was closed, which ends a body without a length.
+ * @return The new state of the parser.
+ */
+ResponseParser::State ResponseParser::finish() noexcept {
+    if(state == State::BODY_UNTIL_CLOSE) {
+        complete(window.size());
+    }
+    else if(state != State::COMPLETE && state != State::INVALID) {
+        invalid("Connection closed before the response was complete.");
+    }
+    return state;
+}
+
+/**
+ * @brief Removes body bytes that were already handed to the sink from the caller's buffer.
+ * @details Only the body is removed, so header views stay valid and the window is updated to the
+ * shortened buffer. Call it after `feed()` to keep the buffer from growing with the body.
+ * @param buffer The buffer that was last fed, starting at the first byte of the response.
+ * @return The number of bytes removed. Always 0 without a sink.
+ */
+size_t ResponseParser::releaseBody(ByteBuffer& buffer) noexcept {
+    if(!sink || !headersComplete() || state == State::TRAILERS || state == State::COMPLETE) return 0;
+
+    size_t released = scanPos - bodyStart;
+    if(released == 0) return 0;
+    buffer.erase(bodyStart, released);
+    scanPos = bodyStart;
+    window = buffer.view();
+    return released;
+}
+
+/**
+ * @brief Accounts for body bytes the caller read past the parser, for example straight into a file.
+ * @details Completes a Content-Length body once all of it has been skipped. A close-delimited
+ * body still ends with `finish()`.
+ * @param length The number of body bytes read without feeding them.
+ */
+void ResponseParser::skipBody(size_t length) noexcept {
+    if(state == State::BODY_UNTIL_CLOSE) bodyBytes += length;
+    if(state != State::BODY) return;
+
+    length = std::min(length, bodyRemaining);
+    bodyRemaining -= length;
+    bodyBytes += length;
+    if(bodyRemaining == 0) complete(scanPos);
+}
+
+// Getters //
+
+/**
+ * @brief Finds a header by name, ignoring case.
+ * @param name The header name.
+ * @return A view of the header value if found, otherwise `std::nullopt`.
+ */
+std::optional<std::string_view> ResponseParser::getHeader(std::string_view name) const noexcept {
+    for(const auto& header : headers) {
+        if(n_utils::str_manip::iequals(view(header.name), name)) return view(header.value);
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Gets the body received so far (the whole body once complete).
+ * @return A view of the body, or an empty view if it is being handed to a sink.
+ */
+std::string_view ResponseParser::getBody() const noexcept {
+    if(sink || !headersComplete()) return {};
+    if(chunked || decoder.isActive()) return decodedBody;
+    return window.substr(bodyStart, scanPos - bodyStart);
+}
+
+/**
+ * @brief Determine if the connection should be kept alive.
+ * @details Connection headers are lists of options, and there may be several (RFC 9110,
+ * section 7.6.1). HTTP/1.1 connections persist unless an option is "close", while HTTP/1.0 ones
+ * only do with a "keep-alive" option (RFC 9112, section 9.3). A body that ran until the close
+ * never leaves a connection to keep.
+ * @return `true` if the connection can carry another request, `false` otherwise.
+ */
+bool ResponseParser::isKeepAlive() const noexcept {
+    if(closeDelimited) return false;
+
+    bool close = false;
+    bool keepAlive = false;
+    for(const HeaderSpan& header : headers) {
+        if(!n_utils::str_manip::iequals(view(header.name), "Connection")) continue;
+        std::string_view options = view(header.value);
+        while(!options.empty()) {
+            size_t comma = options.find(',');
+            std::string_view option = options.substr(0, comma);
+            options.remove_prefix((comma == std::string_view::npos) ? options.size() : comma + 1);
+            while(!option.empty() && (option.front() == ' ' || option.front() == '\t')) option.remove_prefix(1);
+            while(!option.empty() && (option.back() == ' ' || option.back() == '\t')) option.remove_suffix(1);
+
+            if(n_utils::str_manip::iequals(option, "close")) close = true;
+            else if(n_utils::str_manip::iequals(option, "keep-alive")) keepAlive = true;
+        }
+    }
+    if(close) return false;
+    std::string_view version = getVersion();
+    return keepAlive || (version != "HTTP/1.0" && version != "HTTP/0.9");
+}
+
+// Parsing //
+
+/**
+ * @brief Parse the response line (Version, Code, Reason).
+ * @param line The response line (HTTP/1.1 200 OK).
+ * @return `true` if valid, `false` if malformed.
+ */
+bool ResponseParser::parseStartLine(std::string_view line) {
+    size_t versionEnd = line.find(' ');
+    if(versionEnd == std::string_view::npos || line.compare(0, 5, "HTTP/") != 0) {
+        invalid("Invalid start line.");
+        return false;
+    }
+
+    // The reason phrase is optional, so the code may end the line
+    size_t codeEnd = line.find(' ', versionEnd + 1);
+    if(codeEnd == std::string_view::npos) codeEnd = line.size();
+    std::string_view code = line.substr(versionEnd + 1, codeEnd - versionEnd - 1);
+    if(code.size() != 3) {
+        invalid("Invalid status code.");
+        return false;
+    }
+
+    status = http::status::fromString(code);
+    if(status == http::status::Code::INVALID) {
+        invalid("Invalid status code.");
+        return false;
+    }
+
+    version = Span{0, versionEnd};
+    if(codeEnd < line.size()) reason = Span{codeEnd + 1, line.size() - codeEnd - 1};
+    return true;
+}
+
+/**
+ * @brief Parse a single header line.
+ * @param line The header line without its CRLF.
+ * @param lineOffset The offset of the line in the window.
+ * @return `true` if valid, `false` if malformed.
+ */
+bool ResponseParser::parseHeader(std::string_view line, size_t lineOffset) {
+    size_t separator = line.find(':');
+    if(separator == std::string_view::npos || separator == 0) {
+        invalid("Malformed header line.");
+        return false;
+    }
+
+    // Allow optional whitespace around the value
+    size_t valueStart = line.find_first_not_of(" \t", separator + 1);
+    size_t valueEnd = line.find_last_not_of(" \t");
+    Span value;
+    if(valueStart != std::string_view::npos && valueEnd >= valueStart) {
+        value = Span{lineOffset + valueStart, valueEnd - valueStart + 1};
+    }
+
+    headers.push_back(HeaderSpan{Span{lineOffset, separator}, value});
+    return true;
+}
+
+/**
+ * @brief Decides how the body is framed once all headers are parsed.
+ * @details Responses to which the status forbids a body (1xx, 204, 304) end at the headers.
+ * A chunked Transfer-Encoding takes precedence over Content-Length, and any other encoding,
+ * like a missing length, means the body runs until the connection closes.
+ */
+void ResponseParser::beginBody() {
+    int code = static_cast<int>(status);
+    if((code >= 100 && code < 200) || code == 204 || code == 304) {
+        messageEnd = bodyStart;
+        state = State::COMPLETE;
+        return;
+    }
+
+    // Chunked must be the last coding applied
+    if(auto encoding = getHeader("Transfer-Encoding")) {
+        std::string_view coding = *encoding;
+        size_t comma = coding.rfind(',');
+        if(comma != std::string_view::npos) coding.remove_prefix(comma + 1);
+        while(!coding.empty() && (coding.front() == ' ' || coding.front() == '\t')) coding.remove_prefix(1);
+
+        chunked = n_utils::str_manip::iequals(coding, "chunked");
+        state = chunked ? State::CHUNK_SIZE : State::BODY_UNTIL_CLOSE;
+        closeDelimited = !chunked;
+        beginDecoding();
+        return;
+    }
+
+    auto lengthHeader = getHeader("Content-Length");
+    if(!lengthHeader) {
+        state = State::BODY_UNTIL_CLOSE;
+        closeDelimited = true;
+        beginDecoding();
+        return;
+    }
+
+    if(lengthHeader->empty() || lengthHeader->size() > 18) {
+        invalid("Invalid Content-Length header.");
+        return;
+    }
+    bodyRemaining = 0;
+    for(char c : *lengthHeader) {
+        if(c < '0' || c > '9') {
+            invalid("Invalid Content-Length header.");
+            return;
+        }
+        bodyRemaining = bodyRemaining * 10 + (c - '0');
+    }
+    state = State::BODY;
+    if(bodyRemaining > 0) beginDecoding();
+}
+
+/**
+ * @brief Starts removing the body's Content-Encoding, if it is one the decoder supports.
+ * @details A coding the decoder cannot handle leaves the body as it was sent, Content-Encoding
+ * header included, so the caller can still tell what it holds.
+ */
+void ResponseParser::beginDecoding() {
+    auto encoding = getHeader("Content-Encoding");
+    if(!encoding) return;
+
+    ContentDecoder::Coding coding = ContentDecoder::parseCoding(*encoding);
+    if(coding == ContentDecoder::Coding::UNSUPPORTED || !decoder.begin(coding)) decoder.reset();
+}
+
+/**
+ * @brief Parse a chunk size line. Chunk extensions are ignored.
+ * @param line The chunk size line without its CRLF (1a2b;name=value).
+ * @return `true` if valid, `false` if malformed.
+ */
+bool ResponseParser::parseChunkSize(std::string_view line) {
+    size_t digits = 0;
+    bodyRemaining = 0;
+    for(char c : line) {
+        int value;
+        if(c >= '0' && c <= '9') value = c - '0';
+        else if(c >= 'a' && c <= 'f') value = c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F') value = c - 'A' + 10;
+        else if(c == ';' || c == ' ' || c == '\t') break;
+        else {
+            invalid("Invalid chunk size.");
+            return false;
+        }
+
+        if(++digits > 15) {
+            invalid("Chunk size out of range.");
+            return false;
+        }
+        bodyRemaining = (bodyRemaining << 4) | value;
+    }
+
+    if(digits == 0) {
+        invalid("Invalid chunk size.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Hands a piece of the body to the sink, or keeps it if the body is chunked or encoded.
+ * @details An encoded piece is decoded first, and only its decoded bytes are handed on.
+ * @param offset The offset of the piece in the window.
+ * @param length The length of the piece.
+ * @return `true` if the piece was delivered, `false` if it could not be decoded.
+ * @note Content-Length and close-delimited bodies stay in the window without a sink.
+ */
+bool ResponseParser::deliver(size_t offset, size_t length) {
+    if(length == 0) return true;
+    bodyBytes += length;
+    std::string_view data = window.substr(offset, length);
+    if(decoder.isActive()) {
+        if(!decoder.decode(data, sink, decodedBody)) {
+            invalid("Invalid compressed body.");
+            return false;
+        }
+    }
+    else if(sink) sink(data);
+    else if(chunked) decodedBody.append(data);
+    return true;
+}
+
+/**
+ * @brief Marks the response as complete, unless its encoded body stopped part way through.
+ * @details An empty body holds no encoded data to finish, so it is complete whatever its
+ * Content-Encoding, as a Content-Length of zero is.
+ * @param end The offset just past the end of the response.
+ */
+void ResponseParser::complete(size_t end) noexcept {
+    messageEnd = end;
+    state = State::COMPLETE;
+    if(decoder.isActive() && bodyBytes > 0 && !decoder.isFinished()) invalid("Compressed body ended early.");
+}
+
+/**
+ * @brief Marks the response as malformed.
+ * @param reason The reason, kept for the caller to log.
+ * @return The INVALID state.
+ */
+ResponseParser::State ResponseParser::invalid(std::string_view reason) noexcept {
+    error = reason;
+    state = State::INVALID;
+    return state;
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+/**
+ * @file async_client.cpp
+ * @brief This file contains the definition of the AsyncClient class.
+ * @details This class is responsible for handing requests to free connections, queuing the
+ * rest, and resuming each waiting coroutine once its response is in.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "async_client.hpp"
+#include "http_client.hpp"
+#include "logger.hpp"
+#include "resolver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+// Constructors //
+
+/**
+ * @brief Constructs a client with no connections open yet.
+ * @param connectionsPerHost The most connections, and so requests in flight, per server. At least one.
+ */
+AsyncClient::AsyncClient(size_t connectionsPerHost)
+    : connectionsPerHost(std::max<size_t>(connectionsPerHost, 1)), inFlight(0) {}
+
+/**
+ * @brief Closes every connection.
+ */
+AsyncClient::~AsyncClient() noexcept {
+    close();
+}
+
+// Functions //
+
+/**
+ * @brief Sends a request and completes with its response.
+ * @details The request is only sent once the task is started or awaited.
+ * @param request The request. GETs should carry a keep-alive Connection header, so the
+ * connection can be reused for the next request.
+ * @param target The server to send it to.
+ * @return A task producing the response, or `std::nullopt` if the request failed.
+ * @note GCC 12 can destroy braced temporaries twice inside a `co_await` expression, so pass named
+ * objects (`co_await client.fetch(request, server)`) rather than `{"host", "port"}` literals.
+ */
+Task<AsyncClient::Response> AsyncClient::fetch(HttpRequest request, Endpoint target) {
+    Host& host = hostFor(target);
+    co_return co_await ResponseAwaiter(*this, host, HttpClient::serializeRequest(request));
+}
+
+/**
+ * @brief Closes every connection and forgets every server.
+ * @note Requests still in flight are abandoned without resuming their coroutines.
+ */
+void AsyncClient::close() noexcept {
+    for(auto& [key, host] : hosts) {
+        for(auto& connection : host->connections) connection->close();
+    }
+    hosts.clear();
+    ready.clear();
+    inFlight = 0;
+}
+
+// Request Awaiter //
+
+/**
+ * @brief Suspends the fetching coroutine and hands its request to the client.
+ * @param handle The coroutine, resumed by `run()` once the response is in.
+ */
+void AsyncClient::ResponseAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    waiter = handle;
+    client.submit(*this);
+}
+
+// Helpers //
+
+/**
+ * @brief Finds the connections to a server, creating the entry on first use.
+ * @param target The server.
+ * @return The server's entry, which lives as long as the client.
+ */
+AsyncClient::Host& AsyncClient::hostFor(const Endpoint& target) {
+    std::string key = (target.tls ? "https://" : "http://") + Resolver::formatAuthority(target.ip, target.port);
+    auto& host = hosts[key];
+    if(!host) host = std::make_unique<Host>(Host{target, {}, {}});
+    return *host;
+}
+
+/**
+ * @brief Sends a request on an idle connection to its server, opening one if the limit allows,
+ * or queues it until a connection frees up.
+ * @param awaiter The request.
+ */
+void AsyncClient::submit(ResponseAwaiter& awaiter) {
+    inFlight++;
+    Host& host = awaiter.host;
+    for(auto& connection : host.connections) {
+        if(!connection->isBusy()) {
+            dispatch(*connection, awaiter);
+            return;
+        }
+    }
+
+    if(host.connections.size() < connectionsPerHost) {
+        host.connections.push_back(std::make_unique<AsyncConnection>(loop, host.target));
+        host.connections.back()->setTimeouts(timeouts);
+        dispatch(*host.connections.back(), awaiter);
+        return;
+    }
+    host.waiting.push_back(&awaiter);
+}
+
+/**
+ * @brief Starts a request on a connection. Once it completes, the connection takes the next
+ * waiting request to the same server.
+ * @details If the request cannot even be started, it fails and the next waiting one is tried,
+ * so no request is left queued behind a connection that will never complete.
+ * @param connection The idle connection.
+ * @param awaiter The request.
+ */
+void AsyncClient::dispatch(AsyncConnection& connection, ResponseAwaiter& awaiter) {
+    for(ResponseAwaiter* current = &awaiter; current; current = nextWaiting(current->host)) {
+        bool started = connection.start(std::move(current->requestData), 1, [this, current](AsyncConnection& connection, bool success) {
+            Response response;
+            if(success) {
+                HttpResponse parsed;
+                if(parsed.parse(connection.getResponse())) response = std::move(parsed);
+            }
+
+            Host& host = current->host;
+            finish(*current, std::move(response));
+            if(ResponseAwaiter* next = nextWaiting(host)) dispatch(connection, *next);
+        });
+        if(started) return;
+        finish(*current, std::nullopt);
+    }
+}
+
+/**
+ * @brief Takes the oldest request waiting for a connection to a server.
+ * @param host The server.
+ * @return The request, or `nullptr` if none is waiting.
+ */
+AsyncClient::ResponseAwaiter* AsyncClient::nextWaiting(Host& host) noexcept {
+    if(host.waiting.empty()) return nullptr;
+    ResponseAwaiter* next = host.waiting.front();
+    host.waiting.pop_front();
+    return next;
+}
+
+/**
+ * @brief Records a request's response and queues its coroutine to be resumed.
+ * @param awaiter The request.
+ * @param response The response, or `std::nullopt` if it failed.
+ */
+void AsyncClient::finish(ResponseAwaiter& awaiter, Response response) {
+    if(!response) {
+        Logger::getInstance().log("Async request to " + awaiter.host.target.ip + ":" + awaiter.host.target.port + " failed.", Logger::LogLevel::DEBUG);
+    }
+    awaiter.response = std::move(response);
+    inFlight--;
+    ready.push_back(awaiter.waiter);
+}
+
+/**
+ * @brief Waits for and dispatches one round of socket events, then checks every connection's timeout.
+ */
+void AsyncClient::step() {
+    loop.poll(POLL_INTERVAL_MS);
+    auto now = std::chrono::steady_clock::now();
+    for(auto& [key, host] : hosts) {
+        for(auto& connection : host->connections) connection->checkTimeout(now);
+    }
+}
+
+/**
+ * @brief Resumes every coroutine whose response is in, including those that become ready meanwhile.
+ */
+void AsyncClient::resumeReady() {
+    std::vector<std::coroutine_handle<>> resuming;
+    while(!ready.empty()) {
+        resuming.swap(ready);
+        for(auto handle : resuming) handle.resume();
+        resuming.clear();
+    }
+}
@@ -0,0 +1,439 @@
+/**
+ * @file async_connection.cpp
+ * @brief This file contains the definition of the AsyncConnection class.
+ * @details This class is a per-connection state machine driven by an EventLoop, so a
+ * single thread can keep many requests in flight on many sockets.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "async_connection.hpp"
+#include "event_loop.hpp"
+#include "logger.hpp"
+#include "resolver.hpp"
+#include "tls_socket.hpp"
+
+#include <sys/epoll.h>
+
+#include <stdexcept>
+
+// Constructors //
+
+/**
+ * @brief Constructs a new AsyncConnection object. No socket is opened until the first request.
+ * @param loop The EventLoop that drives this connection. Must outlive the connection.
+ * @param target The server to connect to. Must outlive the connection.
+ */
+AsyncConnection::AsyncConnection(EventLoop& loop, const Endpoint& target)
+    : loop(loop), target(target),
+      state(State::DISCONNECTED), nextAddress(0), bytesSent(0), consumed(0), outstanding(0), connectionId(0), peerClosed(false), awaitingFirstByte(false)
+{}
+
+/**
+ * @brief Destroys the AsyncConnection object and unregisters its socket.
+ * @note A pending completion handler is dropped without being called.
+ */
+AsyncConnection::~AsyncConnection() noexcept {
+    close();
+}
+
+// Functions //
+
+/**
+ * @brief Starts sending serialized requests, connecting first if needed.
+ * @param requestData One or more serialized HTTP requests, back-to-back.
+ * @param responseCount The number of requests in `requestData`.
+ * @param handler Called once per response, or once if the batch fails.
+ * @return `true` if the requests were started, `false` if the connection is busy or could not be opened.
+ * @note The handler is never called when this returns `false`. After a failure,
+ * `getOutstanding()` tells how many responses were lost.
+ */
+bool AsyncConnection::start(std::string requestData, size_t responseCount, CompletionHandler handler) {
+    if(isBusy() || responseCount == 0) return false;
+    outgoing = std::move(requestData);
+    return begin(outgoing, responseCount, std::move(handler));
+}
+
+/**
+ * @brief Starts sending serialized requests straight from the caller's memory, connecting first if needed.
+ * @param requestData One or more serialized HTTP requests, back-to-back. Must stay valid until
+ * the handler has been called for the last response, or the batch has failed.
+ * @param responseCount The number of requests in `requestData`.
+ * @param handler Called once per response, or once if the batch fails.
+ * @return `true` if the requests were started, `false` if the connection is busy or could not be opened.
+ * @note As for the owning overload, the handler is never called when this returns `false`.
+ */
+bool AsyncConnection::start(std::string_view requestData, size_t responseCount, CompletionHandler handler) {
+    if(isBusy() || responseCount == 0) return false;
+    return begin(requestData, responseCount, std::move(handler));
+}
+
+/**
+ * @brief Closes the socket and unregisters it from the EventLoop.
+ */
+void AsyncConnection::close() noexcept {
+    if(socket) {
+        loop.remove(socket->get());
+        socket.reset();
+    }
+    state = State::DISCONNECTED;
+    incoming.clear();
+    consumed = 0;
+    parser.reset();
+    peerClosed = false;
+}
+
+/**
+ * @brief Enforces the deadlines: fails the in-flight request if the server has made no progress
+ * for too long, closes a connection left idle, and opens a connect deferred by the reconnect backoff.
+ * @details A connect, with its TLS handshake, has the connect timeout, and sending and receiving
+ * the configured read timeout since the last progress. Only the connect timeout adapts, to the
+ * connect times seen so far.
+ * @param now The current time.
+ */
+void AsyncConnection::checkTimeout(std::chrono::steady_clock::time_point now) {
+    if(state == State::IDLE) {
+        if(now - lastActivity > timeouts.getIdleTimeout()) {
+            Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Closing idle connection to " + target.ip + ":" + target.port + "."; });
+            close();
+        }
+        return;
+    }
+    if(!isBusy()) return;
+
+    try {
+        if(state == State::CONNECTING && !socket) {
+            if(now >= timeouts.getRetryAt()) sendOrWait(); // The backoff is over
+        }
+        else if(state == State::CONNECTING || state == State::HANDSHAKING) {
+            if(now - timing.connectStart > timeouts.getConnectTimeout()) fail("Timed out connecting to the server.");
+        }
+        else if(now - lastActivity > timeouts.getReadTimeout()) {
+            fail("Timed out waiting for the server.");
+        }
+    }
+    catch(const std::exception& e) {
+        fail(e.what());
+    }
+}
+
+// State Machine //
+
+/**
+ * @brief Starts a batch on an idle or closed connection.
+ * @param requestData The requests to send, valid until the batch ends.
+ * @param responseCount The number of requests in `requestData`.
+ * @param handler Called once per response, or once if the batch fails.
+ * @return `true` if the requests were started, `false` if the connection could not be opened.
+ */
+bool AsyncConnection::begin(std::string_view requestData, size_t responseCount, CompletionHandler handler) {
+    outstanding = responseCount;
+    sending = requestData;
+    bytesSent = 0;
+    onComplete = std::move(handler);
+    lastActivity = std::chrono::steady_clock::now();
+    timing = RequestTiming();
+    timing.start = lastActivity;
+    awaitingFirstByte = true;
+
+    // After a failed connect, `checkTimeout()` opens the next one once the backoff is over
+    if(state == State::DISCONNECTED && timeouts.getRetryAt() > lastActivity) {
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(timeouts.getRetryAt() - lastActivity);
+            return "Backing off " + std::to_string(wait.count()) + " ms before reconnecting to " + target.ip + ":" + target.port + ".";
+        });
+        state = State::CONNECTING;
+        return true;
+    }
+
+    try {
+        sendOrWait();
+        return true;
+    }
+    catch(const std::exception& e) {
+        Logger::getInstance().log("Failed to start request to " + target.ip + ":" + target.port + ": " + e.what(), Logger::LogLevel::ERROR);
+        if(state != State::SENDING) timeouts.onConnectFailed(std::chrono::steady_clock::now());
+        onComplete = nullptr;
+        close();
+        return false;
+    }
+}
+
+/**
+ * @brief Connects if there is no socket, then sends as much of the batch as the socket accepts.
+ * @throws std::runtime_error if the connect or the send fails.
+ */
+void AsyncConnection::sendOrWait() {
+    if(!socket) {
+        connect();
+        if(state == State::CONNECTING || state == State::HANDSHAKING) return; // Sending resumes once connected
+    }
+
+    state = State::SENDING;
+    if(flushWrites()) {
+        RequestTiming::mark(timing.sent);
+        state = State::RECEIVING;
+    }
+}
+
+/**
+ * @brief Resolves the target and starts connecting to its first address.
+ * @details Host names come from the Resolver's cache. If an address refuses or fails, the next
+ * one is tried in turn (see `connectNext()`).
+ * @throws std::runtime_error if the host cannot be resolved or every address fails immediately.
+ */
+void AsyncConnection::connect() {
+    timing.connectStart = RequestTiming::Clock::now();
+    addresses = Resolver::getInstance().resolve(target.ip, target.port);
+    nextAddress = 0;
+    connectNext();
+}
+
+/**
+ * @brief Starts a non-blocking connect to the next address and registers the socket with the EventLoop.
+ * @details The socket is registered once, edge-triggered, for both directions, so the
+ * state machine never has to modify its registration. A previous attempt is closed first.
+ * @throws std::runtime_error if every remaining address fails immediately.
+ */
+void AsyncConnection::connectNext() {
+    if(socket) {
+        loop.remove(socket->get());
+        socket.reset();
+    }
+
+    bool connected = false;
+    while(true) {
+        const Resolver::Address& address = (*addresses)[nextAddress++];
+        try {
+            socket = std::make_unique<Socket>(address.family(), SOCK_STREAM, 0);
+            connectionId = socket->getId();
+            connected = socket->beginConnect(address.get(), address.length);
+            break;
+        }
+        catch(const std::runtime_error&) {
+            socket.reset();
+            if(nextAddress == addresses->size()) throw;
+        }
+    }
+    if(connected && !target.tls) markConnected();
+    incoming.clear();
+    consumed = 0;
+    parser.reset();
+    peerClosed = false;
+
+    // The first EPOLLOUT edge starts the handshake of a socket that connected right away
+    loop.add(socket->get(), EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, [this](uint32_t events) {
+        handleEvents(events);
+    });
+    state = connected ? State::IDLE : State::CONNECTING;
+    if(connected && target.tls) beginTls();
+}
+
+/**
+ * @brief Wraps the connected socket in a TlsSocket, whose handshake `handleEvents()` then drives.
+ * @details The descriptor does not change, so the socket stays registered with the EventLoop.
+ * @throws std::runtime_error if the TLS connection cannot be created.
+ */
+void AsyncConnection::beginTls() {
+    int fd = socket->get();
+    try {
+        socket = std::make_unique<TlsSocket>(std::move(*socket), target.ip, target.port);
+    }
+    catch(const std::runtime_error&) {
+        loop.remove(fd); // The descriptor was closed with the failed TlsSocket
+        socket.reset();
+        throw;
+    }
+    state = State::HANDSHAKING;
+}
+
+/**
+ * @brief Marks the connection as established and feeds its connect time to the timeouts.
+ */
+void AsyncConnection::markConnected() {
+    RequestTiming::mark(timing.connected);
+    timeouts.onConnected(timing.connected - timing.connectStart);
+}
+
+/**
+ * @brief Advances the state machine when the EventLoop reports readiness.
+ * @param events The ready epoll events.
+ */
+void AsyncConnection::handleEvents(uint32_t events) {
+    lastActivity = std::chrono::steady_clock::now();
+    try {
+        if(state == State::CONNECTING) {
+            if(!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) return;
+            try {
+                socket->finishConnect();
+            }
+            catch(const std::runtime_error&) {
+                if(nextAddress == addresses->size()) throw;
+                connectNext(); // Fall back to the next address
+                if(state == State::CONNECTING) return;
+            }
+            if(target.tls) {
+                if(state != State::HANDSHAKING) beginTls(); // A fallback that connected at once has begun already
+            }
+            else {
+                markConnected();
+                state = State::SENDING;
+            }
+        }
+
+        if(state == State::HANDSHAKING) {
+            if(!static_cast<TlsSocket&>(*socket).tryHandshake()) return; // Wait for the server's reply
+            markConnected();
+            state = State::SENDING;
+        }
+
+        if(state == State::SENDING) {
+            if(!flushWrites()) return; // Wait for the next EPOLLOUT edge
+            RequestTiming::mark(timing.sent);
+            state = State::RECEIVING;
+        }
+
+        if(state == State::RECEIVING || state == State::IDLE) readResponse();
+    }
+    catch(const std::exception& e) {
+        fail(e.what());
+    }
+}
+
+/**
+ * @brief Writes as much of the pending request as the socket accepts.
+ * @return `true` once the whole request has been sent, `false` if the socket would block.
+ */
+bool AsyncConnection::flushWrites() {
+    while(bytesSent < sending.size()) {
+        ssize_t sent = socket->trySend(sending.data() + bytesSent, sending.size() - bytesSent, MSG_NOSIGNAL);
+        if(sent < 0) return false;
+        bytesSent += sent;
+    }
+    return true;
+}
+
+/**
+ * @brief Drains the socket and completes the request once a whole response has arrived.
+ * @details The socket is always read until it would block, as edge-triggered readiness does
+ * not fire again for data that is left unread.
+ */
+void AsyncConnection::readResponse() {
+    while(!peerClosed) {
+        // Read straight into the pooled buffer
+        char* space = incoming.prepare(READ_SIZE);
+        ssize_t bytesRead = socket->recv(space, incoming.writable(), 0);
+        if(bytesRead < 0) break; // Would block
+        if(bytesRead == 0) peerClosed = true;
+        else incoming.commit(bytesRead);
+    }
+
+    // Nothing is expected while idle except the server closing the connection
+    if(state == State::IDLE) {
+        if(peerClosed) close();
+        else {
+            // The last response was already handed out, so drop it with whatever arrived after it
+            incoming.clear();
+            consumed = 0;
+            parser.reset();
+        }
+        return;
+    }
+
+    // Pipelined responses may arrive in the same read, so handle every complete one
+    while(state == State::RECEIVING) {
+        // Drop the previous response before parsing the next
+        if(consumed > 0) {
+            incoming.consume(consumed);
+            consumed = 0;
+            parser.reset();
+            timing.clearResponse();
+        }
+        if(!incoming.empty()) {
+            RequestTiming::mark(timing.firstByte);
+            if(awaitingFirstByte && timing.sent != RequestTiming::Clock::time_point()) {
+                auto waited = timing.firstByte - timing.sent;
+                auto usual = timeouts.getSlowThreshold();
+                if(timeouts.onFirstByte(waited)) {
+                    Logger::getInstance().log(Logger::LogLevel::WARN, [&] {
+                        return "Slow response from " + target.ip + ":" + target.port + ": "
+                            + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(waited).count())
+                            + " ms to first byte, usually under " + std::to_string(usual.count()) + " ms.";
+                    });
+                }
+                awaitingFirstByte = false;
+            }
+        }
+
+        // Without a Content-Length the body runs until the server closes the connection
+        ResponseParser::State parsed = parser.feed(incoming);
+        parser.releaseBody(incoming); // Only drops bytes already handed to a body sink
+        if(parser.headersComplete()) RequestTiming::mark(timing.headersDone);
+        if(parsed == ResponseParser::State::BODY_UNTIL_CLOSE && peerClosed) parsed = parser.finish();
+        if(parsed == ResponseParser::State::INVALID) {
+            fail("Malformed response: " + std::string(parser.getError()));
+            return;
+        }
+        if(parsed != ResponseParser::State::COMPLETE) {
+            if(peerClosed) fail("Connection closed before the response was complete.");
+            return;
+        }
+        consumed = parser.getMessageSize();
+        RequestTiming::mark(timing.complete);
+
+        // The server may close after any response, even with more requests in flight
+        bool last = (outstanding == 1);
+        if(!last && (peerClosed || !parser.isKeepAlive())) {
+            complete(true);
+            fail("Server closed the connection with pipelined requests in flight.");
+            return;
+        }
+
+        if(last) {
+            if(peerClosed || !parser.isKeepAlive()) {
+                // Drop the socket but keep the buffer, as the handler still reads the parser
+                loop.remove(socket->get());
+                socket.reset();
+                state = State::DISCONNECTED;
+                complete(true);
+                return;
+            }
+            state = State::IDLE;
+        }
+        complete(true);
+    }
+}
+
+/**
+ * @brief Hands a result to the completion handler.
+ * @details For the last response (or a failure) the handler is moved out first, so it can
+ * start the next request on this connection.
+ * @param success `true` if a response was received, `false` otherwise.
+ */
+void AsyncConnection::complete(bool success) {
+    if(success && outstanding > 1) {
+        outstanding--;
+        if(onComplete) onComplete(*this, true);
+        timing.connectStart = timing.connected = RequestTiming::Clock::time_point(); // Only the first response waited for it
+        return;
+    }
+
+    if(success) outstanding = 0;
+    CompletionHandler handler = std::move(onComplete);
+    onComplete = nullptr;
+    if(handler) handler(*this, success);
+    if(!success && !isBusy()) outstanding = 0; // Unless the handler started a new batch
+}
+
+/**
+ * @brief Closes the connection and fails the in-flight request.
+ * @param reason The reason to log.
+ */
+void AsyncConnection::fail(const std::string& reason) {
+    Logger::getInstance().log("Request to " + target.ip + ":" + target.port + " failed: " + reason, Logger::LogLevel::ERROR);
+    if(state == State::CONNECTING || state == State::HANDSHAKING) timeouts.onConnectFailed(std::chrono::steady_clock::now());
+    close();
+    complete(false);
+}
\ No newline at end of file
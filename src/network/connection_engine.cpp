@@ -0,0 +1,550 @@
+/**
+ * @file connection_engine.cpp
+ * @brief This file contains the definition of the ConnectionEngine class.
+ * @details This class is responsible for opening several connections to one or more
+ * servers and spreading requests across them from a pool of worker threads.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "async_connection.hpp"
+#include "connection_engine.hpp"
+#include "connection_manager.hpp"
+#include "event_loop.hpp"
+#include "http_client.hpp"
+#include "http_request.hpp"
+#include "logger.hpp"
+#include "prepared_request.hpp"
+#include "request_corpus.hpp"
+#include "response_parser.hpp"
+#include "trace_ring.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+// Constructors //
+
+/**
+ * @brief Constructs a new ConnectionEngine object.
+ * @param targets The servers to connect to. Must outlive the engine.
+ * @param connections The total number of connections to open.
+ * @param threads The number of worker threads, or 0 for one thread per connection.
+ * @param pipelineDepth The number of requests written back-to-back on a connection.
+ * @throws std::invalid_argument if there are no targets or no connections.
+ */
+ConnectionEngine::ConnectionEngine(const std::vector<Endpoint>& targets, size_t connections, size_t threads, size_t pipelineDepth)
+    : targets(targets), connections(connections),
+      threads((threads == 0) ? connections : std::min(threads, connections)),
+      pipelineDepth(std::max<size_t>(pipelineDepth, 1)),
+      pinned(false), rate(0), arrival(RateScheduler::Arrival::CONSTANT), totalRequests(0), claimants(1), nextRequest(0)
+{
+    if(targets.empty()) throw std::invalid_argument("ConnectionEngine requires at least one target.");
+    if(connections == 0) throw std::invalid_argument("ConnectionEngine requires at least one connection.");
+}
+
+// Functions //
+
+/**
+ * @brief Sends the requested number of requests across every connection and waits for completion.
+ * @param totalRequests The total number of requests to send.
+ * @param factory Builds the request for a given target and request index. Called concurrently.
+ * @param onSnapshot Optional handler run on the calling thread with the live results each time
+ * `metrics_requested` is set. The metrics may still be recording while it reads them.
+ * @return The results of every worker, one per target it served, in worker order.
+ */
+std::vector<ConnectionEngine::WorkerResult> ConnectionEngine::run(size_t totalRequests, const RequestFactory& factory, const SnapshotHandler& onSnapshot) {
+    Workload workload;
+    workload.factory = &factory;
+    return runWorkload(totalRequests, workload, onSnapshot);
+}
+
+/**
+ * @brief Sends the requested number of requests from per-target templates and waits for completion.
+ * @param totalRequests The total number of requests to send.
+ * @param prepared The request template of each target, in target order.
+ * @param uriFor Gives the URI of a request index. Called concurrently, and the view must stay
+ * valid until the run ends.
+ * @param onSnapshot Optional handler run with the live results, as in the factory overload.
+ * @return The results of every worker, one per target it served, in worker order.
+ * @throws std::invalid_argument if there is not one template per target.
+ */
+std::vector<ConnectionEngine::WorkerResult> ConnectionEngine::run(
+    size_t totalRequests,
+    const std::vector<PreparedRequest>& prepared,
+    const URIFactory& uriFor,
+    const SnapshotHandler& onSnapshot
+) {
+    if(prepared.size() != targets.size()) throw std::invalid_argument("ConnectionEngine requires one prepared request per target.");
+    Workload workload;
+    workload.prepared = &prepared;
+    workload.uriFor = &uriFor;
+    return runWorkload(totalRequests, workload, onSnapshot);
+}
+
+/**
+ * @brief Replays a corpus of serialized requests in order and waits for completion.
+ * @details Every request is sent as it was recorded, Host header included, to whichever target
+ * its connection serves. The corpus is replayed from the start again once exhausted.
+ * @param totalRequests The total number of requests to send.
+ * @param corpus The requests to replay. Must stay mapped until the run ends.
+ * @param onSnapshot Optional handler run with the live results, as in the factory overload.
+ * @return The results of every worker, one per target it served, in worker order.
+ * @throws std::invalid_argument if the corpus is empty.
+ */
+std::vector<ConnectionEngine::WorkerResult> ConnectionEngine::run(size_t totalRequests, const RequestCorpus& corpus, const SnapshotHandler& onSnapshot) {
+    if(corpus.empty()) throw std::invalid_argument("ConnectionEngine requires a corpus with at least one request.");
+    Workload workload;
+    workload.corpus = &corpus;
+    return runWorkload(totalRequests, workload, onSnapshot);
+}
+
+// Workers //
+
+/**
+ * @brief Runs a workload on the workers and waits for them, taking snapshots when asked.
+ * @param totalRequests The total number of requests to send.
+ * @param workload Where the requests come from.
+ * @param onSnapshot Optional handler run with the live results.
+ * @return The results of every worker, one per target it served, in worker order.
+ */
+std::vector<ConnectionEngine::WorkerResult> ConnectionEngine::runWorkload(size_t totalRequests, const Workload& workload, const SnapshotHandler& onSnapshot) {
+    this->totalRequests = totalRequests;
+    nextRequest.store(0, std::memory_order_relaxed);
+
+    // Never open more connections than there are requests
+    size_t connectionCount = std::min(connections, totalRequests);
+    size_t workerCount = std::min(threads, connectionCount);
+    claimants = std::max<size_t>(workerCount, 1);
+
+    // Connection `i` goes to target `i % targets` (round-robin) and worker `i % workerCount`.
+    // Connections of one worker to the same target share a result.
+    std::vector<size_t> resultIndex(workerCount * targets.size(), SIZE_MAX);
+    std::vector<size_t> connectionSlots(connectionCount);
+    size_t resultCount = 0;
+    for(size_t i = 0; i < connectionCount; i++) {
+        size_t& index = resultIndex[(i % workerCount) * targets.size() + i % targets.size()];
+        if(index == SIZE_MAX) index = resultCount++;
+        connectionSlots[i] = index;
+    }
+    std::vector<WorkerResult> results(resultCount);
+    std::vector<WorkerResult*> connectionResults(connectionCount);
+    for(size_t i = 0; i < connectionCount; i++) {
+        connectionResults[i] = &results[connectionSlots[i]];
+        connectionResults[i]->targetIndex = i % targets.size();
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable workerDone;
+    size_t running = workerCount;
+    auto finished = [&] {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        running--;
+        workerDone.notify_one();
+    };
+
+    // Workers pin themselves and localize their results before any snapshot may read them
+    if(pinned) cpus = usableCpus();
+    std::latch sharded(static_cast<std::ptrdiff_t>(workerCount));
+    auto enter = [&](size_t worker) {
+        enterShard(worker, workerCount, connectionResults);
+        sharded.count_down();
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for(size_t i = 0; i < workerCount; i++) {
+        if(rate > 0) {
+            workers.emplace_back([&, i] { enter(i); runOpenLoopWorker(i, workerCount, connectionResults, workload); finished(); });
+        }
+        else if(workerCount == connectionCount) {
+            workers.emplace_back([&, i] { enter(i); runWorker(*connectionResults[i], workload); finished(); });
+        }
+        else {
+            workers.emplace_back([&, i] { enter(i); runReactorWorker(i, workerCount, connectionResults, workload); finished(); });
+        }
+    }
+
+    // Wait for the workers, taking snapshots when asked
+    sharded.wait();
+    std::unique_lock<std::mutex> lock(doneMutex);
+    while(running > 0) {
+        workerDone.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS));
+        if(metrics_requested) {
+            metrics_requested = 0;
+            if(onSnapshot) {
+                lock.unlock();
+                onSnapshot(results);
+                lock.lock();
+            }
+        }
+    }
+    lock.unlock();
+    for(auto& worker : workers) worker.join();
+
+    return results;
+}
+
+/**
+ * @brief Sends requests on a single connection until the shared request counter is exhausted.
+ * @param result The result slot owned by this worker.
+ * @param workload Where the requests come from.
+ */
+void ConnectionEngine::runWorker(WorkerResult& result, const Workload& workload) {
+    const Endpoint& target = targets[result.targetIndex];
+    ConnectionManager connMgr;
+    connMgr.setTls(target.tls);
+    connMgr.setTimeouts(timeouts);
+    HttpClient client(connMgr);
+    client.setDisplay(false);
+    client.setBodySink([](std::string_view) {}); // Bodies are never read, so do not buffer them
+    client.setMetrics(&result.metrics);
+    const PreparedRequest* prepared = workload.prepared ? &(*workload.prepared)[result.targetIndex] : nullptr;
+    const RequestCorpus* corpus = workload.corpus;
+    std::vector<std::string_view> views; // URIs or corpus requests, reused for every batch
+    Claim local;
+
+    size_t first, last;
+    while(!signal_received && claim(local, pipelineDepth, first, last)) {
+        if(pipelineDepth == 1) {
+            bool success = corpus   ? client.processRaw(corpus->get(first % corpus->size()), target.ip, target.port)
+                         : prepared ? client.processRequest(*prepared, (*workload.uriFor)(first), target.ip, target.port)
+                                    : client.processRequest((*workload.factory)(target, first), target.ip, target.port);
+            if(!success) result.failures++;
+            continue;
+        }
+
+        // Each pipelined response is timed from when the batch started
+        size_t completed = 0;
+        if(corpus) {
+            views.clear();
+            for(size_t i = first; i < last; i++) views.push_back(corpus->get(i % corpus->size()));
+            completed = client.processPipeline(views, target.ip, target.port);
+        }
+        else if(prepared) {
+            views.clear();
+            for(size_t i = first; i < last; i++) views.push_back((*workload.uriFor)(i));
+            completed = client.processPipeline(*prepared, views, target.ip, target.port);
+        }
+        else {
+            std::vector<HttpRequest> batch;
+            batch.reserve(last - first);
+            for(size_t i = first; i < last; i++) batch.push_back((*workload.factory)(target, i));
+            completed = client.processPipeline(batch, target.ip, target.port);
+        }
+        result.failures += (last - first) - completed;
+    }
+
+    connMgr.disconnect();
+}
+
+/**
+ * @brief Multiplexes this worker's share of the connections on a single EventLoop.
+ * @details Connection `i` belongs to worker `i % workerCount`, so every result slot is only
+ * touched by one thread. Each completion immediately starts the next request on that connection.
+ * @param worker The index of this worker.
+ * @param workerCount The number of workers.
+ * @param connectionResults The result slot of every connection. Only this worker's slots are written.
+ * @param workload Where the requests come from.
+ */
+void ConnectionEngine::runReactorWorker(size_t worker, size_t workerCount, const std::vector<WorkerResult*>& connectionResults, const Workload& workload) {
+    struct Slot {
+        std::unique_ptr<AsyncConnection> connection;
+        WorkerResult* result;
+    };
+
+    EventLoop loop;
+    std::vector<Slot> slots;
+    for(size_t i = worker; i < connectionResults.size(); i += workerCount) {
+        auto connection = std::make_unique<AsyncConnection>(loop, targets[connectionResults[i]->targetIndex]);
+        connection->setBodySink([](std::string_view) {}); // Bodies are never read, so do not buffer them
+        connection->setTimeouts(timeouts);
+        slots.push_back(Slot{std::move(connection), connectionResults[i]});
+    }
+
+    TraceRing& trace = TraceRing::getInstance();
+    size_t active = 0;
+    Claim local; // Shared by this worker's connections
+    std::function<bool(Slot&)> issue = [&](Slot& slot) {
+        size_t first, last;
+        while(!signal_received && claim(local, pipelineDepth, first, last)) {
+            auto handler = [&](AsyncConnection& connection, bool success) {
+                if(success) slot.result->metrics.record(connection.getTiming());
+                else slot.result->failures += connection.getOutstanding();
+                if(trace.isEnabled()) {
+                    uint16_t flags = (connection.getTarget().tls ? TraceRing::TLS : 0) | (pipelineDepth > 1 ? TraceRing::PIPELINED : 0);
+                    trace.record(connection.getTiming(), success ? &connection.getResponse() : nullptr, connection.getConnectionId(), flags);
+                }
+
+                // Start the next batch once the last response of this one is in
+                if(!success || connection.getOutstanding() == 0) {
+                    if(!issue(slot)) active--;
+                }
+            };
+
+            // Corpus requests are sent from the mapping unless the batch wraps around its end
+            std::string_view borrowed = workload.corpus ? corpusRange(*workload.corpus, first, last) : std::string_view();
+            bool started;
+            if(!borrowed.empty()) started = slot.connection->start(borrowed, last - first, std::move(handler));
+            else {
+                const Endpoint& target = slot.connection->getTarget();
+                std::string requestData;
+                if(workload.corpus) {
+                    for(size_t i = first; i < last; i++) requestData += workload.corpus->get(i % workload.corpus->size());
+                }
+                else if(workload.prepared) {
+                    const PreparedRequest& prepared = (*workload.prepared)[slot.result->targetIndex];
+                    for(size_t i = first; i < last; i++) prepared.appendTo(requestData, (*workload.uriFor)(i));
+                }
+                else {
+                    for(size_t i = first; i < last; i++) requestData += HttpClient::serializeRequest((*workload.factory)(target, i));
+                }
+                started = slot.connection->start(std::move(requestData), last - first, std::move(handler));
+            }
+            if(started) return true;
+            slot.result->failures += last - first;
+        }
+        return false;
+    };
+
+    for(auto& slot : slots) {
+        if(issue(slot)) active++;
+    }
+
+    while(active > 0 && !signal_received) {
+        loop.poll(POLL_INTERVAL_MS);
+        auto now = std::chrono::steady_clock::now();
+        for(auto& slot : slots) slot.connection->checkTimeout(now);
+    }
+
+    for(auto& slot : slots) slot.connection->close();
+}
+/**
+ * @brief Releases this worker's share of the rate on a timer and sends each arrival on the
+ * first idle connection to its target, queuing it while every connection is busy.
+ * @details Arrivals take turns over the targets this worker connects to. A connection that
+ * frees up takes up to the pipeline depth of the oldest queued arrivals in one write. Each
+ * response's total latency runs from its arrival's due time; the other phases are unchanged.
+ * @param worker The index of this worker.
+ * @param workerCount The number of workers.
+ * @param connectionResults The result slot of every connection. Only this worker's slots are written.
+ * @param workload Where the requests come from.
+ */
+void ConnectionEngine::runOpenLoopWorker(size_t worker, size_t workerCount, const std::vector<WorkerResult*>& connectionResults, const Workload& workload) {
+    using TimePoint = RateScheduler::Clock::time_point;
+    struct Arrival {
+        TimePoint due;
+        size_t index;
+    };
+    struct Slot {
+        std::unique_ptr<AsyncConnection> connection;
+        WorkerResult* result;
+        std::deque<TimePoint> due; // Of the requests in flight, in order
+    };
+    struct Lane { // The connections to one target and the arrivals waiting for them
+        size_t targetIndex;
+        std::vector<Slot*> idle;
+        std::deque<Arrival> waiting;
+    };
+
+    EventLoop loop;
+    std::deque<Slot> slots; // Never moves, as lanes and handlers point into it
+    std::vector<Lane> lanes;
+    for(size_t i = worker; i < connectionResults.size(); i += workerCount) {
+        WorkerResult* result = connectionResults[i];
+        auto connection = std::make_unique<AsyncConnection>(loop, targets[result->targetIndex]);
+        connection->setBodySink([](std::string_view) {}); // Bodies are never read, so do not buffer them
+        connection->setTimeouts(timeouts);
+        slots.push_back(Slot{std::move(connection), result, {}});
+
+        auto lane = std::find_if(lanes.begin(), lanes.end(), [&](const Lane& l) { return l.targetIndex == result->targetIndex; });
+        if(lane == lanes.end()) lane = lanes.insert(lanes.end(), Lane{result->targetIndex, {}, {}});
+        lane->idle.push_back(&slots.back());
+    }
+
+    TraceRing& trace = TraceRing::getInstance();
+    size_t inFlight = 0; // Batches written and not yet answered or failed
+    std::function<void(Lane&)> drain = [&](Lane& lane) {
+        while(!lane.waiting.empty() && !lane.idle.empty()) {
+            Slot& slot = *lane.idle.back();
+            lane.idle.pop_back();
+
+            size_t count = std::min(pipelineDepth, lane.waiting.size());
+            std::string_view borrowed;
+            std::string requestData;
+            if(workload.corpus) {
+                // Indices only grow, so arrivals whose ends are `count` apart were claimed in a row
+                size_t first = lane.waiting.front().index;
+                if(lane.waiting[count - 1].index == first + count - 1) borrowed = corpusRange(*workload.corpus, first, first + count);
+            }
+            for(size_t i = 0; i < count; i++) {
+                const Arrival& next = lane.waiting[i];
+                slot.due.push_back(next.due);
+                if(!borrowed.empty()) continue; // Sent from the mapping
+                if(workload.corpus) requestData += workload.corpus->get(next.index % workload.corpus->size());
+                else if(workload.prepared) (*workload.prepared)[lane.targetIndex].appendTo(requestData, (*workload.uriFor)(next.index));
+                else requestData += HttpClient::serializeRequest((*workload.factory)(targets[lane.targetIndex], next.index));
+            }
+            lane.waiting.erase(lane.waiting.begin(), lane.waiting.begin() + count);
+
+            auto handler = [&, &slot = slot, &lane = lane, count](AsyncConnection& connection, bool success) {
+                // Time each response from when its request was due, not from when it was written
+                RequestTiming timing = connection.getTiming();
+                if(!slot.due.empty()) timing.start = slot.due.front();
+                if(success) {
+                    slot.due.pop_front();
+                    slot.result->metrics.record(timing);
+                }
+                else {
+                    slot.result->failures += connection.getOutstanding();
+                    slot.due.clear();
+                }
+                if(trace.isEnabled()) {
+                    uint16_t flags = (connection.getTarget().tls ? TraceRing::TLS : 0) | (count > 1 ? TraceRing::PIPELINED : 0);
+                    trace.record(timing, success ? &connection.getResponse() : nullptr, connection.getConnectionId(), flags);
+                }
+
+                if(!success || connection.getOutstanding() == 0) {
+                    inFlight--;
+                    lane.idle.push_back(&slot);
+                    drain(lane);
+                }
+            };
+            bool started = borrowed.empty() ? slot.connection->start(std::move(requestData), count, std::move(handler))
+                                            : slot.connection->start(borrowed, count, std::move(handler));
+            if(started) {
+                inFlight++;
+                continue;
+            }
+            slot.result->failures += count;
+            slot.due.clear();
+            lane.idle.push_back(&slot);
+        }
+    };
+
+    // Connections are spread over the targets, so the workers' shares add up to the rate
+    RateScheduler scheduler(loop, rate / workerCount, arrival, std::random_device{}() ^ (static_cast<uint64_t>(worker) << 32));
+    size_t arrivals = 0;
+    scheduler.start([&](TimePoint due) {
+        // One index per arrival, never chunked, so no worker runs dry while others hold a backlog
+        size_t index = nextRequest.fetch_add(1, std::memory_order_relaxed);
+        if(index >= totalRequests) return false;
+        Lane& lane = lanes[arrivals++ % lanes.size()];
+        lane.waiting.push_back(Arrival{due, index});
+        drain(lane);
+        return true;
+    });
+
+    while((scheduler.isRunning() || inFlight > 0) && !signal_received) {
+        loop.poll(POLL_INTERVAL_MS);
+        auto now = std::chrono::steady_clock::now();
+        for(auto& slot : slots) slot.connection->checkTimeout(now);
+    }
+
+    for(auto& slot : slots) slot.connection->close();
+}
+
+// Helpers //
+
+/**
+ * @brief Lists the CPUs this process may run on.
+ * @return The CPU numbers in ascending order, or a single CPU 0 if the affinity mask cannot be read.
+ */
+std::vector<int> ConnectionEngine::usableCpus() {
+    std::vector<int> usable;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for(int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if(CPU_ISSET(cpu, &set)) usable.push_back(cpu);
+        }
+    }
+    if(usable.empty()) usable.push_back(0);
+    return usable;
+}
+
+/**
+ * @brief Prepares the calling thread to run as a worker: pins it to its core when pinning is
+ * on, then moves its results into memory allocated from that core.
+ * @details Everything else the worker uses is created after this returns, so the kernel's
+ * first-touch placement puts it on the same NUMA node.
+ * @param worker The index of this worker.
+ * @param workerCount The number of workers.
+ * @param connectionResults The result slot of every connection. Only this worker's slots are touched.
+ */
+void ConnectionEngine::enterShard(size_t worker, size_t workerCount, const std::vector<WorkerResult*>& connectionResults) {
+    if(!pinned) return;
+
+    int cpu = cpus[worker % cpus.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if(error != 0) {
+        Logger::getInstance().log("Failed to pin worker " + std::to_string(worker) + " to CPU " + std::to_string(cpu) + ": " + std::strerror(error), Logger::LogLevel::WARN);
+    }
+
+    // Connections of one worker to the same target share a result, so localize each once
+    std::vector<WorkerResult*> owned;
+    for(size_t i = worker; i < connectionResults.size(); i += workerCount) {
+        if(std::find(owned.begin(), owned.end(), connectionResults[i]) == owned.end()) owned.push_back(connectionResults[i]);
+    }
+    for(WorkerResult* result : owned) result->metrics.localize();
+}
+
+/**
+ * @brief Takes the next requests for a worker, refilling its claim from the shared counter in chunks.
+ * @details A chunk is a quarter of each worker's share of what is left, at most `CLAIM_CHUNK`,
+ * so chunks shrink toward the end of a run and every worker keeps getting requests however small
+ * the run is. It is never smaller than `count`, so a deep pipeline's batch is never cut short.
+ * @param local The worker's claim.
+ * @param count The most requests to take, such as a pipelined batch.
+ * @param first Receives the first request index taken.
+ * @param last Receives one past the last request index taken. The batch may be short at the end of a chunk.
+ * @return `true` if any request was taken, `false` once the workload is exhausted.
+ */
+bool ConnectionEngine::claim(Claim& local, size_t count, size_t& first, size_t& last) noexcept {
+    if(local.next >= local.end) {
+        size_t claimed = nextRequest.load(std::memory_order_relaxed);
+        size_t remaining = (claimed < totalRequests) ? totalRequests - claimed : 0;
+        size_t chunk = std::max(count, std::min(CLAIM_CHUNK, remaining / (claimants * 4)));
+        local.next = nextRequest.fetch_add(chunk, std::memory_order_relaxed);
+        if(local.next >= totalRequests) {
+            local.end = local.next;
+            return false;
+        }
+        local.end = std::min(local.next + chunk, totalRequests);
+    }
+    first = local.next;
+    last = std::min(first + count, local.end);
+    local.next = last;
+    return true;
+}
+
+/**
+ * @brief Finds the range of the mapping a run of corpus requests lies in.
+ * @param corpus The corpus being replayed.
+ * @param first The first request index of the run.
+ * @param last One past the last request index of the run.
+ * @return The requests back-to-back, or an empty view if the run wraps around the end of the corpus.
+ */
+std::string_view ConnectionEngine::corpusRange(const RequestCorpus& corpus, size_t first, size_t last) noexcept {
+    size_t begin = first % corpus.size();
+    size_t end = begin + (last - first);
+    if(end > corpus.size()) return std::string_view();
+    return corpus.span(begin, end);
+}
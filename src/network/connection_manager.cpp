@@ -11,69 +11,402 @@
 
 #include "connection_manager.hpp"
 #include "logger.hpp"
-#include "n_utils.hpp"
+#include "resolver.hpp"
 #include "socket.hpp"
+#include "tls_socket.hpp"
 
-#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 // Constructors //
 
 /**
  * @brief Constructs a new ConnectionManager object.
  */
-ConnectionManager::ConnectionManager() : connected(false) {}
+ConnectionManager::ConnectionManager()
+    : pool(loop), connected(false), reused(false), tls(false), sendTimeoutMs(SEND_TIMEOUT_MS), current(nullptr), consumed(0), readyEvents(0) {}
 
 // Getters //
 
 /**
  * @brief Checks if the ConnectionManager is connected to the server.
+ * @details No syscall is made. A hang-up or error counts once the EventLoop has reported it, so a
+ * close that arrived since the last wait is only found by the next send or receive.
  * @return `true` if connected, `false` otherwise.
  */
-bool ConnectionManager::isConnected() {
-    if(!socket) return false; // No socket exists
+bool ConnectionManager::isConnected() const noexcept {
+    return socket && connected && (readyEvents & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) == 0;
+}
+
+/**
+ * @brief Checks if the active connection is to a specific server.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return `true` if connected to that server, `false` otherwise.
+ */
+bool ConnectionManager::isConnectedTo(const std::string& ip, const std::string& port) const noexcept {
+    return isConnected() && host == ip && service == port;
+}
 
-    char buffer;
-    ssize_t result = recv(socket->get(), &buffer, 1, MSG_PEEK | MSG_DONTWAIT);
+// Setters //
 
-    if(result == 0) {
-        // Peer closed the connection
-        connected = false;
-    } 
-    else if(result < 0 && (errno != EAGAIN && errno != EWOULDBLOCK)) {
-        // Other errors mean the connection is broken
-        connected = false;
-    }
+/**
+ * @brief Sets how long a send may wait for the server to make room in the send buffer.
+ * @param timeout_ms The timeout in milliseconds, applied to the current and future connections.
+ */
+void ConnectionManager::setSendTimeout(int timeout_ms) noexcept {
+    sendTimeoutMs = timeout_ms;
+    if(socket) socket->setSendTimeout(timeout_ms);
+}
+
+/**
+ * @brief Sets the limits of the connect, read and idle timeouts.
+ * @details Every server's adaptive connect timeout is capped by them, and pooled connections are
+ * closed once idle for longer than `timeouts.idleMs`.
+ * @param timeouts The limits, applied to the current and future connections.
+ */
+void ConnectionManager::setTimeouts(const Timeouts& timeouts) {
+    limits = timeouts;
+    for(auto& [key, host] : hostTimeouts) host.setLimits(timeouts);
+    pool.setIdleTimeout(timeouts.idleMs);
+}
 
-    return connected;
+/**
+ * @brief Sets whether new connections run TLS (HTTPS).
+ * @details Changing it closes the active connection and the pooled ones, as they use the other transport.
+ * @param enable `true` for TLS, `false` for plain TCP.
+ */
+void ConnectionManager::setTls(bool enable) {
+    if(enable == tls) return;
+    disconnect();
+    pool.clear();
+    tls = enable;
 }
 
 // Helpers //
 
 /**
- * @brief Polls the socket for the specified events.
- * @param events The events to poll for (POLLIN or POLLOUT).
+ * @brief Routes the events of a registered socket to the active connection or the pool.
+ * @param fd The socket the events are for.
+ * @param events The events reported by the EventLoop.
+ */
+void ConnectionManager::onSocketEvents(int fd, uint32_t events) noexcept {
+    if(socket && socket->get() == fd) readyEvents |= events;
+    else pool.notify(fd, events);
+}
+
+/**
+ * @brief Gives up the active connection, parking it in the pool if it can be reused.
+ * @details Only a connection whose last response was complete and kept alive, with no pipelined
+ * bytes after it, is parked. Any other connection is closed.
+ */
+void ConnectionManager::release() {
+    bool idle = isConnected() && parser.isComplete() && parser.isKeepAlive() && buffer.size() == consumed;
+    if(!idle) {
+        disconnect();
+        return;
+    }
+
+    pool.release(host, service, std::move(socket));
+    disconnect(); // Resets the state of the parked connection, which no longer owns a socket
+}
+
+/**
+ * @brief Connects to the first address that accepts, racing them as Happy Eyeballs does.
+ * @details The first address is tried alone. Each `ATTEMPT_DELAY_MS` without a connection, or
+ * as soon as an attempt fails, the next address is tried alongside the ones still pending. The
+ * first to connect wins and the others are closed (RFC 8305, section 5).
+ * @param addresses The addresses to try, in order.
+ * @param timeout How long to wait for any of them.
+ * @return The connected socket, in non-blocking mode.
+ * @throws std::runtime_error if every address fails or nothing connects within `timeout`.
+ */
+std::unique_ptr<Socket> ConnectionManager::raceConnect(const Resolver::AddressList& addresses, std::chrono::milliseconds timeout) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::unique_ptr<Socket>> attempts;
+    std::vector<struct pollfd> fds;
+    std::string lastError = "No addresses to connect to";
+    size_t next = 0;
+
+    // Starts the next address, returning its socket if it connected right away
+    auto startNext = [&]() -> std::unique_ptr<Socket> {
+        while(next < addresses.size()) {
+            const Resolver::Address& address = addresses[next++];
+            try {
+                auto attempt = std::make_unique<Socket>(address.family(), SOCK_STREAM, 0);
+                if(attempt->beginConnect(address.get(), address.length)) return attempt;
+                fds.push_back({attempt->get(), POLLOUT, 0});
+                attempts.push_back(std::move(attempt));
+                return nullptr;
+            }
+            catch(const std::runtime_error& e) {
+                lastError = e.what(); // E.g. no route for this family, move on at once
+            }
+        }
+        return nullptr;
+    };
+
+    const auto deadline = Clock::now() + timeout;
+    auto nextStart = Clock::now();
+    while(true) {
+        auto now = Clock::now();
+        if(next < addresses.size() && (attempts.empty() || now >= nextStart)) {
+            if(auto socket = startNext()) return socket;
+            nextStart = now + std::chrono::milliseconds(ATTEMPT_DELAY_MS);
+            continue;
+        }
+        if(attempts.empty()) break; // Every address failed
+        if(now >= deadline) {
+            lastError = "Connection timed out";
+            break;
+        }
+
+        auto until = (next < addresses.size()) ? std::min(deadline, nextStart) : deadline;
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count() + 1;
+        int ready = poll(fds.data(), fds.size(), static_cast<int>(wait));
+        if(ready < 0) {
+            if(errno == EINTR) continue;
+            lastError = "Poll error during connect: " + std::string(std::strerror(errno));
+            break;
+        }
+
+        for(size_t i = 0; i < fds.size() && ready > 0; ) {
+            if(fds[i].revents == 0) {
+                i++;
+                continue;
+            }
+            ready--;
+            try {
+                attempts[i]->finishConnect();
+                return std::move(attempts[i]); // The losers close as they go out of scope
+            }
+            catch(const std::runtime_error& e) {
+                lastError = e.what();
+                attempts.erase(attempts.begin() + i);
+                fds.erase(fds.begin() + i);
+                nextStart = Clock::now(); // A failure starts the next address right away
+            }
+        }
+    }
+    throw std::runtime_error(lastError);
+}
+
+/**
+ * @brief Waits for the socket to become ready for the specified events.
+ * @details The socket is registered with the EventLoop once, edge-triggered, when it connects.
+ * Events that already arrived are consumed without a syscall, and `epoll_wait()` is only
+ * entered when nothing is pending. Errors and hang-ups count as ready so the next
+ * `recv()`/`send()` reports them.
+ * @param events The events to wait for (EPOLLIN or EPOLLOUT).
  * @param timeout_ms The timeout in milliseconds.
  * @return `true` if the socket is ready for the specified events, `false` otherwise.
  */
-bool ConnectionManager::pollSocket(short events, int timeout_ms) const {
+bool ConnectionManager::pollSocket(uint32_t events, int timeout_ms) {
     if(!socket) return false; // No socket to poll
 
-    // Configure pollfd struct
-    struct pollfd pfd;
-    pfd.fd = socket->get();
-    pfd.events = events;
+    const uint32_t wanted = events | EPOLLERR | EPOLLHUP | ((events & EPOLLIN) ? EPOLLRDHUP : 0);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
 
-    // Poll the socket
-    int poll_ret = poll(&pfd, 1, timeout_ms);
-    if(poll_ret <= 0) {
-        std::string eventStr = (events == POLLOUT) ? "writing" : "reading";
-        Logger::getInstance().log("Socket not ready for " + eventStr + ".", Logger::LogLevel::DEBUG);
+    // Other edges (e.g. EPOLLOUT while waiting to read) can wake the loop early
+    while((readyEvents & wanted) == 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if(remaining.count() <= 0) break;
+        loop.poll(static_cast<int>(remaining.count()));
+    }
+
+    if((readyEvents & wanted) == 0) {
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] {
+            return std::string("Socket not ready for ") + ((events == EPOLLOUT) ? "writing" : "reading") + ".";
+        });
         return false;
     }
+    readyEvents &= ~events; // The next wait needs a new edge
+    return true;
+}
+
+/**
+ * @brief Gets the timeouts of a server, creating them on its first connect.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return The server's timeouts, which live as long as the ConnectionManager.
+ */
+HostTimeouts& ConnectionManager::timeoutsFor(const std::string& ip, const std::string& port) {
+    return hostTimeouts.try_emplace(ip + ":" + port, limits).first->second;
+}
+
+/**
+ * @brief Reads available data, waiting for readability only when the socket has none.
+ * @param buffer The buffer to read into.
+ * @param len The length of the buffer.
+ * @return The number of bytes read, `0` if the peer closed, or `-1` if no data arrived in time.
+ */
+ssize_t ConnectionManager::recvWhenReady(char* buffer, size_t len) {
+    while(true) {
+        ssize_t bytesRead = socket->recv(buffer, len, 0);
+        if(bytesRead >= 0) return bytesRead;
+        if(!isReadable()) return -1; // Would block and nothing arrived before the timeout
+    }
+}
+
+/**
+ * @brief Drops the previous response and prepares the parser for the next one.
+ * @param sink The body sink to use for the next response, if any.
+ */
+void ConnectionManager::beginResponse(const ResponseParser::BodySink& sink) {
+    // Keep any pipelined bytes that followed the previous response
+    buffer.consume(consumed);
+    consumed = 0;
+    parser.reset();
+    parser.setBodySink(sink);
+
+    // A pipelined response may have arrived with the previous one
+    timing.clearResponse();
+    if(!buffer.empty()) RequestTiming::mark(timing.firstByte);
+    waitingSince = buffer.empty() ? RequestTiming::Clock::now() : RequestTiming::Clock::time_point();
+}
+
+/**
+ * @brief Feeds the parser from the socket until the response is complete.
+ * @param stopAfterHeaders Return as soon as the headers are parsed.
+ * @return `true` if the response (or its headers) was parsed, `false` otherwise. The connection
+ * is closed on failure.
+ */
+bool ConnectionManager::readResponse(bool stopAfterHeaders) {
+    if(!socket && buffer.empty()) return false;
+
+    while(parser.feed(buffer) != ResponseParser::State::COMPLETE) {
+        parser.releaseBody(buffer); // Only drops bytes already handed to the sink
+        if(parser.headersComplete()) RequestTiming::mark(timing.headersDone);
+        if(parser.hasError()) {
+            Logger::getInstance().log("Malformed response: " + std::string(parser.getError()), Logger::LogLevel::ERROR);
+            disconnect();
+            return false;
+        }
+        if(stopAfterHeaders && parser.headersComplete()) return true;
+
+        // Read straight into the pooled buffer
+        char* space = buffer.prepare(READ_SIZE);
+        ssize_t bytesRead = socket ? recvWhenReady(space, buffer.writable()) : 0;
+        if(bytesRead <= 0) {
+            // A body without a Content-Length only ends when the server closes, a timeout truncates it
+            if(bytesRead == 0 && parser.getState() == ResponseParser::State::BODY_UNTIL_CLOSE) {
+                if(parser.finish() == ResponseParser::State::INVALID) {
+                    Logger::getInstance().log("Malformed response: " + std::string(parser.getError()), Logger::LogLevel::ERROR);
+                    disconnect();
+                    return false;
+                }
+                RequestTiming::mark(timing.complete);
+                return true;
+            }
+            if(bytesRead == 0) {
+                Logger::getInstance().log(parser.headersComplete()
+                    ? "Connection closed before the response was complete."
+                    : "Failed to read headers.", Logger::LogLevel::ERROR);
+            }
+            else Logger::getInstance().log("Timed out waiting for the response.", Logger::LogLevel::ERROR);
+            disconnect(); // Leftover bytes would be mistaken for the next response
+            return false;
+        }
+
+        buffer.commit(bytesRead);
+        RequestTiming::mark(timing.firstByte);
+        if(current && waitingSince != RequestTiming::Clock::time_point()) {
+            auto waited = timing.firstByte - waitingSince;
+            auto usual = current->getSlowThreshold();
+            if(current->onFirstByte(waited)) {
+                Logger::getInstance().log(Logger::LogLevel::WARN, [&] {
+                    return "Slow response from " + host + ":" + service + ": "
+                        + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(waited).count())
+                        + " ms to first byte, usually under " + std::to_string(usual.count()) + " ms.";
+                });
+            }
+            waitingSince = RequestTiming::Clock::time_point();
+        }
+    }
+    RequestTiming::mark(timing.headersDone);
+    RequestTiming::mark(timing.complete);
+    return true;
+}
+
+/**
+ * @brief Splices a body from the socket to a file descriptor through a pipe.
+ * @param fd The file descriptor to write to.
+ * @param length The number of bytes to move, ignored if `untilClose` is set.
+ * @param untilClose Move everything until the server closes the connection.
+ * @return The number of bytes moved if successful, `std::nullopt` otherwise.
+ */
+std::optional<size_t> ConnectionManager::spliceBody(int fd, size_t length, bool untilClose) {
+    int pipe_fds[2];
+    if(pipe2(pipe_fds, O_CLOEXEC) < 0) {
+        Logger::getInstance().log("Failed to create pipe: " + std::string(std::strerror(errno)), Logger::LogLevel::ERROR);
+        return std::nullopt;
+    }
+    Socket pipeRead(pipe_fds[0]), pipeWrite(pipe_fds[1]); // Closed on every return
+
+    size_t moved = 0;
+    try {
+        while(untilClose || moved < length) {
+            size_t request = untilClose ? SPLICE_SIZE : std::min(length - moved, SPLICE_SIZE);
+            ssize_t inPipe = socket->trySplice(pipeWrite.get(), request);
+            if(inPipe == 0) {
+                if(untilClose) break;
+                Logger::getInstance().log("Connection closed before the response was complete.", Logger::LogLevel::ERROR);
+                return std::nullopt;
+            }
+            if(inPipe < 0) {
+                if(!pollSocket(EPOLLIN, limits.readMs)) {
+                    Logger::getInstance().log("Timed out waiting for the response body.", Logger::LogLevel::ERROR);
+                    return std::nullopt;
+                }
+                continue;
+            }
+
+            // Drain the pipe into the file before reading more from the socket
+            while(inPipe > 0) {
+                ssize_t out = splice(pipeRead.get(), nullptr, fd, nullptr, inPipe, SPLICE_F_MOVE);
+                if(out <= 0) {
+                    if(out < 0 && errno == EINTR) continue;
+                    Logger::getInstance().log("Failed to write response body: " + std::string(std::strerror(errno)), Logger::LogLevel::ERROR);
+                    return std::nullopt;
+                }
+                inPipe -= out;
+                moved += out;
+            }
+        }
+    }
+    catch(const std::exception& e) {
+        Logger::getInstance().log("Failed to splice response body: " + std::string(e.what()), Logger::LogLevel::ERROR);
+        return std::nullopt;
+    }
+    return moved;
+}
+
+/**
+ * @brief Writes the whole buffer to a file descriptor.
+ * @param fd The file descriptor to write to.
+ * @param data The data to write.
+ * @return `true` if everything was written, `false` otherwise.
+ */
+bool ConnectionManager::writeAll(int fd, std::string_view data) noexcept {
+    while(!data.empty()) {
+        ssize_t out = write(fd, data.data(), data.size());
+        if(out < 0) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+        data.remove_prefix(out);
+    }
     return true;
 }
 
@@ -81,37 +414,80 @@ bool ConnectionManager::pollSocket(short events, int timeout_ms) const {
 
 /**
  * @brief Connects to the server with the specified IP address and port.
+ * @details An open connection to the same server is kept, after one non-blocking `poll()` if it
+ * has been idle for longer than `IDLE_CHECK_MS`. Otherwise the active connection is
+ * released to the pool, and an idle connection to the server is reused if the pool has one.
+ * A new connection is only opened when neither exists, and with TLS its handshake counts
+ * toward the connect time. It waits within the server's adaptive connect timeout, and after
+ * a failed connect not before the server's jittered reconnect delay has passed.
  * @param ip The IP address of the server.
  * @param port The port number of the server.
  * @return `true` if the connection was successful, `false` otherwise.
  */
 bool ConnectionManager::connect(const std::string& ip, const std::string& port) {
     if(ip.empty() || port.empty()) return false; // Invalid IP or port
+    if(isConnectedTo(ip, port)) {
+        // Back-to-back requests skip the check, a connection left idle collects what the loop missed
+        if(RequestTiming::Clock::now() - timing.complete < std::chrono::milliseconds(IDLE_CHECK_MS)) return true;
+        loop.poll(0);
+        if(isConnected()) return true;
+        Logger::getInstance().log("Connection to " + ip + ":" + port + " was closed while idle.", Logger::LogLevel::DEBUG);
+    }
 
-    if(socket) disconnect(); // Disconnect from previous connection
-
-    // Setup socket and address
-    socket = std::make_unique<Socket>(AF_INET, SOCK_STREAM, 0);
-    struct sockaddr_in addr;
-    std::memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(std::stoi(port));
+    if(socket) release(); // Pool or close the previous connection
+    host = ip;
+    service = port;
+    current = &timeoutsFor(ip, port);
 
-    // Convert IP address to network byte order
-    if(inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) <= 0) {
-        Logger::getInstance().log("Invalid IP address: " + ip, Logger::LogLevel::ERROR);
-        return false;
+    // Reuse a warm connection, which is still registered with the loop
+    if(auto pooled = pool.acquire(ip, port)) {
+        socket = std::move(pooled);
+        socket->setSendTimeout(sendTimeoutMs);
+        timing.connectStart = timing.connected = RequestTiming::Clock::time_point();
+        readyEvents = EPOLLOUT; // Idle with nothing in flight, so its send buffer has room
+        reused = true;
+        connected = true;
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Reusing pooled connection to " + ip + ":" + port + "."; });
+        return true;
     }
 
-    // Connect to the server
+    // Resolve and connect, racing the addresses if there are several
+    auto retryAt = current->getRetryAt();
+    if(retryAt > RequestTiming::Clock::now()) {
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(retryAt - RequestTiming::Clock::now());
+            return "Backing off " + std::to_string(wait.count()) + " ms before reconnecting to " + ip + ":" + port + ".";
+        });
+        std::this_thread::sleep_until(retryAt);
+    }
     Logger::getInstance().log("Attempting to connect to " + ip + ":" + port + "...", Logger::LogLevel::INFO);
     try {
-        socket->connect((struct sockaddr*)&addr, sizeof(addr), TIMEOUT_MS);
+        timing.connectStart = RequestTiming::Clock::now();
+        Resolver::Result addresses = Resolver::getInstance().resolve(ip, port);
+        const auto connectTimeout = current->getConnectTimeout();
+        socket = raceConnect(*addresses, connectTimeout);
+        if(tls) {
+            // Registered after the handshake, which waits with its own poll()
+            auto secure = std::make_unique<TlsSocket>(std::move(*socket), ip, port);
+            secure->handshake(static_cast<int>(connectTimeout.count()));
+            socket = std::move(secure);
+        }
+        socket->setSendTimeout(sendTimeoutMs);
+        timing.connected = RequestTiming::Clock::now();
+        current->onConnected(timing.connected - timing.connectStart);
+        readyEvents = 0;
+        int fd = socket->get();
+        loop.add(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, [this, fd](uint32_t events) {
+            onSocketEvents(fd, events);
+        });
+        reused = false;
         Logger::getInstance().log("Connection successful.", Logger::LogLevel::INFO);
         connected = true;
         return true;
     }
     catch(const std::runtime_error& e) {
+        socket.reset(); // Emptied by a failed handshake
+        current->onConnectFailed(RequestTiming::Clock::now());
         Logger::getInstance().log("Connection failed: " + std::string(e.what()), Logger::LogLevel::ERROR);
         return false;
     }
@@ -120,9 +496,14 @@ bool ConnectionManager::connect(const std::string& ip, const std::string& port)
 /**
  * @brief Disconnects from the server by resetting the socket 
  * and setting the connected flag to `false`.
+ * @note Idle connections in the pool are kept. Use `getPool().clear()` to close them too.
  */
 void ConnectionManager::disconnect() {
+    if(socket) loop.remove(socket->get());
     socket.reset();
+    buffer.clear();
+    consumed = 0;
+    parser.reset();
     connected = false;
 }
 
@@ -139,52 +520,99 @@ bool ConnectionManager::send(const std::string& data) const {
 }
 
 /**
- * @brief Receives the HTTP response data from the server.
- * @details This function reads headers until "\r\n\r\n" is encountered, then reads the body if Content-Length is present.
- * @return The received data if successful, `std::nullopt` otherwise.
+ * @brief Sends several buffers to the server as one write, without joining them first.
+ * @param iov The buffers to send, in order. Entries are advanced as they are sent.
+ * @param iovcnt The number of buffers.
+ * @return `true` if the data was sent successfully, `false` otherwise.
  */
-std::optional<std::string> ConnectionManager::receive() {
-    if(!socket) return std::nullopt;
+bool ConnectionManager::sendv(struct iovec* iov, int iovcnt) const {
+    if(!socket) return false; // No socket to send data
 
-    char buffer[BUFFER_SIZE] = {0};
-    std::string data;
+    size_t total = 0;
+    for(int i = 0; i < iovcnt; i++) total += iov[i].iov_len;
+    return socket->sendv(iov, iovcnt, MSG_NOSIGNAL) == total;
+}
 
-    // Read headers until "\r\n\r\n" is encountered
-    while(data.find("\r\n\r\n") == std::string::npos) {
-        if(!isReadable()) return std::nullopt;
-        ssize_t bytesRead = socket->recv(buffer, BUFFER_SIZE, 0);
-        if(bytesRead <= 0) {
-            Logger::getInstance().log("Failed to read headers.", Logger::LogLevel::ERROR);
-            return std::nullopt;
-        }
-        data.append(buffer, bytesRead);
-    }
+/**
+ * @brief Sends part of a file to the server without reading it into memory.
+ * @param fd The file to send.
+ * @param count The number of bytes to send.
+ * @param offset The offset in the file to start at.
+ * @return `true` if all `count` bytes were sent, `false` otherwise.
+ */
+bool ConnectionManager::sendFile(int fd, size_t count, off_t offset) const {
+    if(!socket) return false; // No socket to send data
+    return socket->sendFile(fd, offset, count) == count;
+}
 
-    // Split headers and body
-    size_t headerEnd = data.find("\r\n\r\n");
-    auto headersStr = data.substr(0, headerEnd);
-    std::string body = data.substr(headerEnd + 4);
+/**
+ * @brief Receives the next HTTP response from the server.
+ * @details Data is read until the parser has one complete response. Any bytes past that response
+ * belong to the next pipelined response and are kept for the next call. Responses without a
+ * Content-Length run until the server closes the connection; one that times out first fails.
+ * @param sink Optional callback handed each piece of the body as it arrives. The body is then
+ * not buffered, so the memory used stays flat however large the response is.
+ * @return A view of the raw response if successful, `std::nullopt` otherwise. The view and
+ * `getResponse()` stay valid until the next call to `receive()` or `disconnect()`. With a sink,
+ * the body is missing from both.
+ */
+std::optional<std::string_view> ConnectionManager::receive(const ResponseParser::BodySink& sink) {
+    beginResponse(sink);
+    if(!readResponse(false)) return std::nullopt;
 
-    // If headers include Content-Length, read the rest
-    size_t contentLength = 0;
-    std::string lowerKey = n_utils::str_manip::toLower("Content-Length");
-    if(auto contentLengthStr = n_utils::str_manip::parseHeaderValue(headersStr, lowerKey)) {
-        try {
-            contentLength = std::stoul(*contentLengthStr);
-        }
-        catch(const std::invalid_argument& e) {
-            contentLength = 0;
-        }
+    // Hand out the first response and keep the rest for the next call
+    consumed = parser.getMessageSize();
+    reused = true;
+    return buffer.view().substr(0, consumed);
+}
+
+/**
+ * @brief Receives the next HTTP response from the server and writes its body to a file descriptor.
+ * @details Once the headers are parsed, the rest of a Content-Length or close-delimited body is
+ * spliced from the socket to the file through a pipe, so it never passes through user space.
+ * Chunked or compressed bodies, outputs that cannot be spliced into (like a terminal), and TLS
+ * connections without kTLS are decoded and written as they arrive instead. Either way the memory used stays flat.
+ * @param fd The file descriptor to write the body to.
+ * @return The number of body bytes written if successful, `std::nullopt` otherwise.
+ * `getResponse()` holds the headers until the next call to `receive()` or `disconnect()`.
+ */
+std::optional<size_t> ConnectionManager::receiveTo(int fd) {
+    size_t written = 0;
+    bool writeFailed = false;
+    beginResponse([&](std::string_view data) {
+        if(writeFailed) return;
+        if(writeAll(fd, data)) written += data.size();
+        else writeFailed = true;
+    });
+    if(!readResponse(true) || writeFailed) {
+        if(writeFailed) Logger::getInstance().log("Failed to write response body: " + std::string(std::strerror(errno)), Logger::LogLevel::ERROR);
+        disconnect();
+        return std::nullopt;
     }
 
-    // Read remaining bytes if the body is shorter than Content-Length header
-    while(contentLength > 0 && body.size() < contentLength) {
-        if(!isReadable()) return std::nullopt;
-        ssize_t bytesRead = socket->recv(buffer, BUFFER_SIZE, 0);
-        if(bytesRead <= 0) break;
-        body.append(buffer, bytesRead);
+    // Whatever arrived with the headers has been written, so the socket holds only body bytes
+    struct stat info;
+    bool spliceable = socket && socket->canSplice() && !parser.isDecoded() && fstat(fd, &info) == 0 && (S_ISREG(info.st_mode) || S_ISFIFO(info.st_mode));
+    auto state = parser.getState();
+    if(spliceable && (state == ResponseParser::State::BODY || state == ResponseParser::State::BODY_UNTIL_CLOSE)) {
+        bool untilClose = (state == ResponseParser::State::BODY_UNTIL_CLOSE);
+        auto spliced = spliceBody(fd, parser.getBodyRemaining(), untilClose);
+        if(!spliced) {
+            disconnect();
+            return std::nullopt;
+        }
+        written += *spliced;
+        parser.skipBody(*spliced);
+        if(untilClose) parser.finish();
+    }
+    else if(!parser.isComplete() && (!readResponse(false) || writeFailed)) {
+        if(writeFailed) Logger::getInstance().log("Failed to write response body: " + std::string(std::strerror(errno)), Logger::LogLevel::ERROR);
+        disconnect();
+        return std::nullopt;
     }
 
-    // Combine headers and body back
-    return headersStr + "\r\n\r\n" + body;
-}
\ No newline at end of file
+    RequestTiming::mark(timing.complete);
+    consumed = parser.getMessageSize();
+    reused = true;
+    return written;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file connection_pool.cpp
+ * @brief This file contains the definition of the ConnectionPool class.
+ * @details It is responsible for parking, reusing and reaping idle keep-alive connections.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "connection_pool.hpp"
+#include "event_loop.hpp"
+#include "logger.hpp"
+
+#include <stdexcept>
+
+// Constructors //
+
+/**
+ * @brief Constructs an empty pool.
+ * @param loop The EventLoop the pooled sockets are registered with.
+ */
+ConnectionPool::ConnectionPool(EventLoop& loop)
+    : loop(loop), idleCount(0), maxIdlePerHost(MAX_IDLE_PER_HOST), idleTimeout(IDLE_TIMEOUT_MS) {}
+
+/**
+ * @brief Closes every idle connection.
+ */
+ConnectionPool::~ConnectionPool() noexcept {
+    clear();
+}
+
+// Setters //
+
+/**
+ * @brief Sets how many idle connections are kept for each server.
+ * @param max The limit, at least 1. Servers over the new limit lose their oldest connections.
+ * @throw std::invalid_argument if `max` is 0.
+ */
+void ConnectionPool::setMaxIdlePerHost(size_t max) {
+    if(max == 0) throw std::invalid_argument("The pool must keep at least one connection per host.");
+    maxIdlePerHost = max;
+    for(auto& [key, list] : hosts) {
+        while(list.size() > maxIdlePerHost) close(list, 0);
+    }
+}
+
+// Functions //
+
+/**
+ * @brief Parks an idle connection for later reuse.
+ * @details The socket must still be registered with the EventLoop and must have no response
+ * in flight. If the server already has `maxIdlePerHost` idle connections, its oldest is closed.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param socket The connected socket.
+ */
+void ConnectionPool::release(const std::string& ip, const std::string& port, std::unique_ptr<Socket> socket) {
+    if(!socket) return;
+
+    auto now = Clock::now();
+    evictExpired(now);
+    IdleList& list = hosts[keyOf(ip, port)];
+    if(list.size() >= maxIdlePerHost) close(list, 0);
+    list.push_back({std::move(socket), now});
+    idleCount++;
+    Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] {
+        return "Pooled connection to " + ip + ":" + port + " (" + std::to_string(idleCount) + " idle).";
+    });
+}
+
+/**
+ * @brief Takes the most recently used idle connection to a server.
+ * @details Pending events are dispatched first with one non-blocking `poll()`, so connections
+ * the server closed since the last wait are reaped before one is picked. Nothing is polled
+ * when the server has no idle connections.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return The socket, still registered with the EventLoop, or `nullptr` if there is none.
+ */
+std::unique_ptr<Socket> ConnectionPool::acquire(const std::string& ip, const std::string& port) {
+    if(idleCount == 0) return nullptr;
+
+    auto it = hosts.find(keyOf(ip, port));
+    if(it == hosts.end() || it->second.empty()) return nullptr;
+
+    loop.poll(0);
+    evictExpired(Clock::now());
+    IdleList& list = it->second; // Emptied lists stay in the map
+    if(list.empty()) return nullptr;
+
+    std::unique_ptr<Socket> socket = std::move(list.back().socket);
+    list.pop_back();
+    idleCount--;
+    return socket;
+}
+
+/**
+ * @brief Handles events for a pooled socket.
+ * @details Only write readiness is expected while idle. Anything else closes the connection.
+ * @param fd The socket the events are for. Unknown descriptors are ignored.
+ * @param events The events reported by the EventLoop.
+ */
+void ConnectionPool::notify(int fd, uint32_t events) noexcept {
+    if((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) == 0) return;
+
+    for(auto& [key, list] : hosts) {
+        for(size_t i = 0; i < list.size(); i++) {
+            if(list[i].socket->get() != fd) continue;
+            Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Idle connection to " + key + " was closed by the server."; });
+            close(list, i);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Closes every idle connection to a server.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ */
+void ConnectionPool::clear(const std::string& ip, const std::string& port) noexcept {
+    auto it = hosts.find(keyOf(ip, port));
+    if(it == hosts.end()) return;
+    while(!it->second.empty()) close(it->second, 0);
+}
+
+/**
+ * @brief Closes every idle connection.
+ */
+void ConnectionPool::clear() noexcept {
+    for(auto& [key, list] : hosts) {
+        while(!list.empty()) close(list, 0);
+    }
+    hosts.clear();
+}
+
+// Helpers //
+
+/**
+ * @brief Builds the key a server's connections are kept under.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return The key, "ip:port".
+ */
+std::string ConnectionPool::keyOf(const std::string& ip, const std::string& port) {
+    std::string key;
+    key.reserve(ip.size() + port.size() + 1);
+    key += ip;
+    key += ':';
+    key += port;
+    return key;
+}
+
+/**
+ * @brief Unregisters and closes one idle connection.
+ * @param list The list holding the connection.
+ * @param index The position of the connection in the list.
+ */
+void ConnectionPool::close(IdleList& list, size_t index) noexcept {
+    loop.remove(list[index].socket->get());
+    list.erase(list.begin() + index);
+    idleCount--;
+}
+
+/**
+ * @brief Closes the connections that have been idle for longer than the idle timeout.
+ * @param now The current time.
+ */
+void ConnectionPool::evictExpired(Clock::time_point now) noexcept {
+    if(idleCount == 0) return;
+
+    const auto cutoff = now - idleTimeout;
+    for(auto& [key, list] : hosts) {
+        // The oldest are first, so only a prefix can have expired
+        size_t expired = 0;
+        while(expired < list.size() && list[expired].since <= cutoff) expired++;
+        while(expired-- > 0) close(list, 0);
+    }
+}
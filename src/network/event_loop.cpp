@@ -0,0 +1,162 @@
+/**
+ * @file event_loop.cpp
+ * @brief This file contains the definition of the EventLoop class.
+ * @details The EventLoop class is an epoll based reactor that owns the readiness
+ * registrations of non-blocking sockets and dispatches their events to callbacks.
+ *
+ * @author Noah Nickles
+ * @date 2/16/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "event_loop.hpp"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+// Constructors //
+
+/**
+ * @brief Constructs a new EventLoop object with its own epoll instance.
+ * @throws std::system_error if the epoll instance cannot be created.
+ */
+EventLoop::EventLoop()
+    : epoll_fd(-1), running(false), registered(0), nextGeneration(0), readyEvents(MAX_EVENTS)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd < 0) {
+        throw std::system_error(std::error_code(errno, std::system_category()), "Failed to create epoll instance");
+    }
+}
+
+/**
+ * @brief Destroys the EventLoop object and closes the epoll instance.
+ * @note Registered file descriptors are not closed, they are owned by their sockets.
+ */
+EventLoop::~EventLoop() noexcept {
+    if(epoll_fd >= 0) close(epoll_fd);
+}
+
+// Getters //
+
+/**
+ * @brief Checks if a file descriptor is registered with the loop.
+ * @param fd The file descriptor to check.
+ * @return `true` if registered, `false` otherwise.
+ */
+bool EventLoop::contains(int fd) const noexcept {
+    return fd >= 0 && static_cast<size_t>(fd) < registrations.size() && registrations[fd] != nullptr;
+}
+
+// Registration //
+
+/**
+ * @brief Registers a file descriptor with the loop.
+ * @param fd The file descriptor to watch.
+ * @param events The epoll events to watch for (EPOLLIN, EPOLLOUT, EPOLLET, ...).
+ * @param callback The callback to run with the ready events.
+ * @throws std::invalid_argument if the file descriptor is invalid or already registered.
+ * @throws std::system_error if `epoll_ctl()` fails.
+ */
+void EventLoop::add(int fd, uint32_t events, Callback callback) {
+    if(fd < 0) throw std::invalid_argument("Cannot register an invalid file descriptor");
+    if(contains(fd)) throw std::invalid_argument("File descriptor is already registered");
+
+    // The generation lets dispatch skip stale events for a reused fd number
+    uint32_t generation = ++nextGeneration;
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(fd);
+
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        throw std::system_error(std::error_code(errno, std::system_category()), "Failed to register fd with epoll");
+    }
+
+    if(static_cast<size_t>(fd) >= registrations.size()) registrations.resize(fd + 1);
+    registrations[fd] = std::make_unique<Registration>(Registration{std::move(callback), generation});
+    registered++;
+}
+
+/**
+ * @brief Changes the events a registered file descriptor is watched for.
+ * @param fd The registered file descriptor.
+ * @param events The new epoll events.
+ * @throws std::invalid_argument if the file descriptor is not registered.
+ * @throws std::system_error if `epoll_ctl()` fails.
+ */
+void EventLoop::modify(int fd, uint32_t events) {
+    if(!contains(fd)) throw std::invalid_argument("File descriptor is not registered");
+
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = (static_cast<uint64_t>(registrations[fd]->generation) << 32) | static_cast<uint32_t>(fd);
+
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        throw std::system_error(std::error_code(errno, std::system_category()), "Failed to modify fd in epoll");
+    }
+}
+
+/**
+ * @brief Unregisters a file descriptor from the loop.
+ * @details The callback is kept alive until the current dispatch finishes, so a
+ * callback can safely remove its own registration.
+ * @param fd The file descriptor to remove. Unknown descriptors are ignored.
+ */
+void EventLoop::remove(int fd) noexcept {
+    if(!contains(fd)) return;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    retired.push_back(std::move(registrations[fd]));
+    registered--;
+}
+
+// Dispatch //
+
+/**
+ * @brief Waits for events once and dispatches them to their callbacks.
+ * @param timeout_ms The maximum time to wait, or -1 to wait indefinitely.
+ * @return The number of callbacks that were run.
+ * @throws std::system_error if `epoll_wait()` fails for a reason other than a signal.
+ */
+int EventLoop::poll(int timeout_ms) {
+    int count = epoll_wait(epoll_fd, readyEvents.data(), static_cast<int>(readyEvents.size()), timeout_ms);
+    if(count < 0) {
+        if(errno == EINTR) return 0;
+        throw std::system_error(std::error_code(errno, std::system_category()), "epoll_wait failed");
+    }
+
+    int dispatched = 0;
+    for(int i = 0; i < count; i++) {
+        int fd = static_cast<int>(readyEvents[i].data.u64 & 0xFFFFFFFFu);
+        uint32_t generation = static_cast<uint32_t>(readyEvents[i].data.u64 >> 32);
+
+        // Skip descriptors removed (or replaced) by an earlier callback in this batch
+        if(!contains(fd) || registrations[fd]->generation != generation) continue;
+
+        Registration* registration = registrations[fd].get();
+        registration->callback(readyEvents[i].events);
+        dispatched++;
+    }
+
+    retired.clear();
+    return dispatched;
+}
+
+/**
+ * @brief Dispatches events until `stop()` is called or nothing is registered.
+ * @param timeout_ms The timeout of each wait, or -1 to wait indefinitely.
+ */
+void EventLoop::run(int timeout_ms) {
+    running = true;
+    while(running && registered > 0) {
+        poll(timeout_ms);
+    }
+    running = false;
+}
\ No newline at end of file
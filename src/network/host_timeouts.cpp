@@ -0,0 +1,105 @@
+/**
+ * @file host_timeouts.cpp
+ * @brief This file contains the definitions of the RttEstimator and HostTimeouts classes.
+ * @details It is responsible for smoothing round trip samples and for spacing out reconnects.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "host_timeouts.hpp"
+
+#include <algorithm>
+
+// RttEstimator //
+
+/**
+ * @brief Constructs an estimator without samples, whose timeout is the limit it is given.
+ */
+RttEstimator::RttEstimator() noexcept
+    : smoothed(0), variation(0), backoffShift(0), samples(0) {}
+
+/**
+ * @brief Adds a round trip, and ends any backoff.
+ * @details The first sample sets SRTT and half of it as RTTVAR. Later ones move RTTVAR a quarter
+ * of the way to their deviation from SRTT, then SRTT an eighth of the way to them.
+ * @param rtt The round trip time.
+ */
+void RttEstimator::sample(Duration rtt) noexcept {
+    if(rtt < Duration::zero()) return;
+    if(samples++ == 0) {
+        smoothed = rtt;
+        variation = rtt / 2;
+    }
+    else {
+        Duration deviation = (smoothed > rtt) ? smoothed - rtt : rtt - smoothed;
+        variation = (3 * variation + deviation) / 4;
+        smoothed = (7 * smoothed + rtt) / 8;
+    }
+    backoffShift = 0;
+}
+
+/**
+ * @brief Doubles the timeout until the next sample, after a wait ran out.
+ */
+void RttEstimator::backoff() noexcept {
+    backoffShift = std::min(backoffShift + 1, MAX_BACKOFF_SHIFT);
+}
+
+/**
+ * @brief Computes how long to wait before giving up.
+ * @param limit The configured timeout, which is never exceeded.
+ * @return SRTT + 4 * RTTVAR, at least `MIN_TIMEOUT` and doubled per backoff, or the limit
+ * without samples.
+ */
+std::chrono::milliseconds RttEstimator::timeout(std::chrono::milliseconds limit) const noexcept {
+    if(samples == 0) return limit;
+    auto estimate = std::chrono::ceil<std::chrono::milliseconds>(smoothed + 4 * variation);
+    estimate = std::max(estimate, std::chrono::milliseconds(MIN_TIMEOUT)) * (1 << backoffShift);
+    return std::min(estimate, limit);
+}
+
+// HostTimeouts //
+
+/**
+ * @brief Constructs the deadlines of a server nothing has been sent to yet.
+ * @param limits The configured timeouts.
+ */
+HostTimeouts::HostTimeouts(const Timeouts& limits)
+    : limits(limits), failures(0), random(std::random_device{}()) {}
+
+/**
+ * @brief Records a connect that succeeded, which ends any reconnect backoff.
+ * @param took The time from starting the connect to having the connection, including any handshake.
+ */
+void HostTimeouts::onConnected(RttEstimator::Duration took) noexcept {
+    connect.sample(took);
+    failures = 0;
+    retryAt = Clock::time_point();
+}
+
+/**
+ * @brief Records a connect that failed, and holds off the next one.
+ * @details The delay is drawn between half and all of `RECONNECT_BASE_MS` doubled per failure
+ * in a row, capped at `RECONNECT_MAX_MS`.
+ * @param now When the connect failed.
+ */
+void HostTimeouts::onConnectFailed(Clock::time_point now) noexcept {
+    connect.backoff();
+    unsigned doublings = std::min(failures++, 16u);
+    int64_t ceiling = std::min<int64_t>(static_cast<int64_t>(RECONNECT_BASE_MS) << doublings, RECONNECT_MAX_MS);
+    std::uniform_int_distribution<int64_t> jitter(ceiling / 2, ceiling);
+    retryAt = now + std::chrono::milliseconds(jitter(random));
+}
+
+/**
+ * @brief Records how long a response took to start arriving.
+ * @param waited The time from sending, or from the previous response, to the first byte.
+ * @return `true` if it took longer than the server's usual times to first byte allow, `false` otherwise.
+ */
+bool HostTimeouts::onFirstByte(RttEstimator::Duration waited) noexcept {
+    bool slow = response.hasSamples() && waited > getSlowThreshold();
+    response.sample(waited);
+    return slow;
+}
@@ -11,14 +11,26 @@
 
 #include "connection_manager.hpp"
 #include "http_client.hpp"
+#include "http_method.hpp"
 #include "http_request.hpp"
 #include "http_response.hpp"
 #include "logger.hpp"
+#include "prepared_request.hpp"
+#include "request_metrics.hpp"
+#include "response_cache.hpp"
+#include "response_parser.hpp"
+#include "trace_ring.hpp"
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
-#include <sstream>
+#include <system_error>
 
 // Constructors //
 
@@ -27,91 +39,617 @@
  * @param connMgr The ConnectionManager object to use for sending and receiving data.
  * @note The ConnectionManager is not owned by the HttpClient, so it is passed by reference.
  */
-HttpClient::HttpClient(ConnectionManager& connMgr) : connMgr(connMgr) {}
+HttpClient::HttpClient(ConnectionManager& connMgr) : connMgr(connMgr), displayEnabled(false), metrics(nullptr), cache(nullptr) {}
 
 // Functions //
 
 /**
- * @brief Processes an HTTP request by serializing and sending it to the server then receiving the response.
- * @param request The HttpRequest object to process.
+ * @brief Sends a request and receives the first response, retrying once if the connection was stale.
+ * @details A reused keep-alive connection may have been closed by the server since its last
+ * response, which only shows once the request fails. If it fails that way before any of the
+ * response arrives, and the request is idempotent, the server's idle connections are dropped
+ * and the request is sent once more on a new connection.
  * @param ip The IP address of the server.
  * @param port The port number of the server.
+ * @param send Sends the request on the connection, returning `true` if it was all written.
+ * @param receive Receives the first response, returning `true` if it was received.
+ * @param idempotent Whether the request may be sent again.
+ * @param sent Set to when the request was written.
+ * @return `true` if the first response was received, `false` otherwise.
  */
-void HttpClient::processRequest(const HttpRequest& request, const std::string& ip, const std::string& port) {
-    try {
-        // Connect to the server if not already connected
-        if(!connMgr.isConnected() && !connMgr.connect(ip, port)) {
-            Logger::getInstance().log("Failed to connect to " + ip + ":" + port, Logger::LogLevel::ERROR);
-            return;
+template<typename SendFunc, typename ReceiveFunc>
+bool HttpClient::sendAndReceive(
+    const std::string& ip,
+    const std::string& port,
+    SendFunc&& send,
+    ReceiveFunc&& receive,
+    bool idempotent,
+    std::chrono::steady_clock::time_point& sent
+) {
+    for(bool retry = idempotent; ; retry = false) {
+        if(!ensureConnected(ip, port)) return false;
+        const bool mayBeStale = retry && connMgr.isReused();
+
+        bool written = false;
+        try {
+            written = send();
+        }
+        catch(const std::system_error&) {
+            if(!mayBeStale) throw;
+        }
+        if(written) {
+            sent = std::chrono::steady_clock::now();
+            try {
+                if(receive()) return true;
+            }
+            catch(const std::system_error&) {
+                if(!mayBeStale) throw;
+            }
         }
-        Logger::getInstance().log("Connected to " + ip + ":" + port, Logger::LogLevel::INFO);
 
-        // Serialize the request and send it
-        std::string requestData = serializeRequest(request);
-        Logger::getInstance().log("Serialized request.", Logger::LogLevel::DEBUG);
-        if(!connMgr.send(requestData)) {
-            Logger::getInstance().log("Failed to send request to " + ip + ":" + port, Logger::LogLevel::ERROR);
-            return;
+        // Once part of the response arrived, the server did see the request
+        bool answered = written && connMgr.getTiming().firstByte != RequestTiming::Clock::time_point();
+        if(!mayBeStale || answered) {
+            Logger::getInstance().log((written ? "Failed to receive response from " : "Failed to send request to ") + ip + ":" + port, Logger::LogLevel::ERROR);
+            return false;
         }
-        request.display(); // Display the formatted request
+        Logger::getInstance().log("Connection to " + ip + ":" + port + " was closed while idle, retrying on a new one.", Logger::LogLevel::INFO);
+        connMgr.disconnect();
+        connMgr.getPool().clear(ip, port); // Idle for longer, so likely closed too
+    }
+}
 
-        // Receive the response and parse it
-        auto responseData = connMgr.receive();
-        if(!responseData.has_value()) {
-            Logger::getInstance().log("Failed to receive response from " + ip + ":" + port, Logger::LogLevel::ERROR);
-            return;
+/**
+ * @brief Sends one request then receives, records and handles its response.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param send Sends the request on the connection, returning `true` if it was all written.
+ * @param request The request to display, or `nullptr` if it was sent from a template.
+ * @param idempotent Whether the request may be sent again on a stale connection.
+ * @param handle Displays or otherwise uses the response, before the connection is released.
+ * @return `true` if a valid response was received, `false` otherwise.
+ */
+template<typename SendFunc, typename HandleFunc>
+bool HttpClient::exchange(
+    const std::string& ip,
+    const std::string& port,
+    SendFunc&& send,
+    const HttpRequest* request,
+    bool idempotent,
+    HandleFunc&& handle
+) {
+    // Connect to the server if not already connected, then send and receive
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point sent;
+    try {
+        if(!sendAndReceive(ip, port, send, [this] { return connMgr.receive(bodySink).has_value(); }, idempotent, sent)) {
+            recordTiming(start, sent, true, false);
+            return false;
         }
-        Logger::getInstance().log("Raw response received. Parsing....", Logger::LogLevel::DEBUG);
-        HttpResponse response = parseResponse(responseData.value());
-        response.display(); // Display the formatted response
+        if(displayEnabled && request) request->display(); // Display the formatted request
+
+        Logger::getInstance().log("Raw response received.", Logger::LogLevel::DEBUG);
+        recordTiming(start, sent, true);
+        const ResponseParser& parser = connMgr.getResponse();
+        handle(parser);
 
         // Reset the connection if the response is not keep-alive
-        if(!response.isKeepAlive()) {
+        if(!parser.isKeepAlive()) {
             Logger::getInstance().log("Connection not kept alive. Disconnecting.", Logger::LogLevel::INFO);
             connMgr.disconnect();
         }
+        return true;
     }
     catch(const std::exception& e) {
         Logger::getInstance().log("Failed to process request: " + std::string(e.what()), Logger::LogLevel::ERROR);
+        recordTiming(start, sent, true, false);
+        return false;
+    }
+}
+
+/**
+ * @brief Processes an HTTP request by serializing and sending it to the server then receiving the response.
+ * @param request The HttpRequest object to process.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return `true` if a valid response was received, `false` otherwise.
+ */
+bool HttpClient::processRequest(const HttpRequest& request, const std::string& ip, const std::string& port) {
+    if(cache && !bodySink && ResponseCache::isCacheable(request)) return processCached(request, ip, port);
+
+    http::method::Method method = http::method::fromString(request.getMethod());
+    auto display = [this](const ResponseParser& parser) { displayResponse(parser); };
+    bool success = exchange(ip, port, [&] { return sendRequest(request); }, &request, http::method::isIdempotent(method), display);
+
+    // A request that may have changed the resource makes its stored response outdated
+    if(success && cache && !http::method::isSafe(method)) cache->remove(ResponseCache::keyOf(ip, port, request.getURI()));
+    return success;
+}
+
+/**
+ * @brief Processes a request built from a template, sending its pieces in one `sendmsg()`
+ * without serializing anything.
+ * @param prepared The request template.
+ * @param uri The URI to request.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return `true` if a valid response was received, `false` otherwise.
+ */
+bool HttpClient::processRequest(const PreparedRequest& prepared, std::string_view uri, const std::string& ip, const std::string& port) {
+    return exchange(ip, port, [&] {
+        struct iovec iov[PreparedRequest::MAX_IOV];
+        int count = prepared.fill(iov, uri);
+        return connMgr.sendv(iov, count);
+    }, nullptr, prepared.isIdempotent(), [this](const ResponseParser& parser) { displayResponse(parser); });
+}
+
+/**
+ * @brief Processes a request that is already serialized, sending it from where it lies.
+ * @details Nothing is copied or parsed but the method, which decides whether the request may
+ * be sent again on a stale connection.
+ * @param request The request's wire bytes, such as a request of a RequestCorpus.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return `true` if a valid response was received, `false` otherwise.
+ */
+bool HttpClient::processRaw(std::string_view request, const std::string& ip, const std::string& port) {
+    bool idempotent = http::method::isIdempotent(http::method::fromString(methodOf(request)));
+    return exchange(ip, port, [&] {
+        struct iovec iov = {const_cast<char*>(request.data()), request.size()};
+        return connMgr.sendv(&iov, 1);
+    }, nullptr, idempotent, [this](const ResponseParser& parser) { displayResponse(parser); });
+}
+
+/**
+ * @brief Sends a request and writes the response body straight to a file.
+ * @details The body is spliced from the socket into the file, so memory use stays flat
+ * whatever the size of the response. Only the headers are displayed. An idempotent request on a
+ * stale keep-alive connection is sent again on a new one, as in `processRequest()`.
+ * @param request The HttpRequest object to process.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param path The file to write the body to. It is created or truncated.
+ * @return `true` if the whole body was written, `false` otherwise.
+ */
+bool HttpClient::downloadToFile(const HttpRequest& request, const std::string& ip, const std::string& port, const std::string& path) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        Logger::getInstance().log("Failed to open " + path + ": " + std::strerror(errno), Logger::LogLevel::ERROR);
+        return false;
+    }
+
+    bool success = false;
+    try {
+        // Nothing is written to the file before the headers arrive, so a retry starts it afresh
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point sent;
+        size_t written = 0;
+        auto receive = [&] {
+            auto bytes = connMgr.receiveTo(fd);
+            if(bytes) written = *bytes;
+            return bytes.has_value();
+        };
+        bool idempotent = http::method::isIdempotent(http::method::fromString(request.getMethod()));
+        if(sendAndReceive(ip, port, [&] { return sendRequest(request); }, receive, idempotent, sent)) {
+            recordTiming(start, sent, true);
+            if(displayEnabled) request.display();
+            const ResponseParser& parser = connMgr.getResponse();
+            if(displayEnabled) parseResponse(parser).display(); // Headers only, the body is in the file
+            Logger::getInstance().log("Saved " + std::to_string(written) + " bytes to " + path, Logger::LogLevel::INFO);
+            if(!parser.isKeepAlive()) connMgr.disconnect();
+            success = true;
+        }
+    }
+    catch(const std::exception& e) {
+        Logger::getInstance().log("Failed to process download: " + std::string(e.what()), Logger::LogLevel::ERROR);
+    }
+
+    close(fd);
+    return success;
+}
+
+/**
+ * @brief Writes a batch of serialized requests in one send, then reads their responses in order.
+ * @param count The number of requests in the batch.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param send Writes every request of the batch, returning `true` if it was all written. It is
+ * called again if the batch is retried on a new connection.
+ * @param requests The requests to display, or `nullptr` if they were sent from a template.
+ * @param onResponse Optional callback run with each response as it is parsed.
+ * @return The number of responses received.
+ */
+template<typename SendFunc>
+size_t HttpClient::pipeline(
+    size_t count,
+    const std::string& ip,
+    const std::string& port,
+    SendFunc&& send,
+    const std::vector<HttpRequest>* requests,
+    const ResponseHandler& onResponse
+) {
+    size_t completed = 0;
+    try {
+        // Every response is timed from the start of the batch
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point sent;
+
+        // Write every request before reading any response. Only GETs are pipelined, so a
+        // batch sent on a stale connection can be sent again whole.
+        if(!sendAndReceive(ip, port, send, [this] { return connMgr.receive(bodySink).has_value(); }, true, sent)) return 0;
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Pipelined " + std::to_string(count) + " requests."; });
+
+        // Responses arrive in request order
+        while(true) {
+            recordTiming(start, sent, completed == 0, true, TraceRing::PIPELINED); // Only the first response waited for the connect
+            const ResponseParser& parser = connMgr.getResponse();
+            if(displayEnabled) {
+                if(requests) (*requests)[completed].display();
+                parseResponse(parser).display();
+            }
+            if(onResponse) onResponse(completed, parser);
+            completed++;
+
+            if(!parser.isKeepAlive()) {
+                Logger::getInstance().log("Connection not kept alive. Disconnecting.", Logger::LogLevel::INFO);
+                connMgr.disconnect();
+                break;
+            }
+            if(completed == count) break;
+
+            if(!connMgr.receive(bodySink).has_value()) {
+                Logger::getInstance().log("Failed to receive pipelined response from " + ip + ":" + port, Logger::LogLevel::ERROR);
+                connMgr.disconnect(); // Unread responses would be mistaken for later ones
+                break;
+            }
+        }
+    }
+    catch(const std::exception& e) {
+        Logger::getInstance().log("Failed to process pipeline: " + std::string(e.what()), Logger::LogLevel::ERROR);
+        connMgr.disconnect();
+    }
+    return completed;
+}
+
+/**
+ * @brief Sends a batch of requests back-to-back on one keep-alive connection, then reads
+ * the responses in order as they arrive (HTTP/1.1 pipelining).
+ * @details Only GET requests are pipelined. If any request is not, the
+ * batch is processed one request at a time instead. If the server closes the connection
+ * part way through, the remaining requests are left unanswered.
+ * @param requests The requests to send, in order.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param onResponse Optional callback run with each response as it is parsed. The parser
+ * it receives is only valid during the call.
+ * @return The number of responses received, which is the number of leading requests that succeeded.
+ */
+size_t HttpClient::processPipeline(
+    const std::vector<HttpRequest>& requests,
+    const std::string& ip,
+    const std::string& port,
+    const ResponseHandler& onResponse
+) {
+    if(requests.empty()) return 0;
+    if(!std::all_of(requests.begin(), requests.end(), isPipelinable)) {
+        Logger::getInstance().log("Batch contains non-GET requests, sending sequentially.", Logger::LogLevel::DEBUG);
+        size_t completed = 0;
+        while(completed < requests.size() && processRequest(requests[completed], ip, port)) completed++;
+        return completed;
+    }
+
+    headBuffer.clear();
+    for(const auto& request : requests) {
+        serializeHead(request, headBuffer);
+        headBuffer += request.getBody();
     }
+    return pipeline(requests.size(), ip, port, [this] { return connMgr.send(headBuffer); }, &requests, onResponse);
+}
+
+/**
+ * @brief Pipelines requests built from one template, as `processPipeline()` does for requests.
+ * @details The batch is sent one request at a time if the template is not a GET.
+ * @param prepared The request template.
+ * @param uris The URI of each request, in order.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param onResponse Optional callback run with each response as it is parsed.
+ * @return The number of responses received, which is the number of leading requests that succeeded.
+ */
+size_t HttpClient::processPipeline(
+    const PreparedRequest& prepared,
+    const std::vector<std::string_view>& uris,
+    const std::string& ip,
+    const std::string& port,
+    const ResponseHandler& onResponse
+) {
+    if(uris.empty()) return 0;
+    if(!prepared.isPipelinable()) {
+        size_t completed = 0;
+        while(completed < uris.size() && processRequest(prepared, uris[completed], ip, port)) completed++;
+        return completed;
+    }
+
+    headBuffer.clear();
+    for(std::string_view uri : uris) prepared.appendTo(headBuffer, uri);
+    return pipeline(uris.size(), ip, port, [this] { return connMgr.send(headBuffer); }, nullptr, onResponse);
+}
+
+/**
+ * @brief Pipelines requests that are already serialized, as `processPipeline()` does for requests.
+ * @details Requests that lie back-to-back in memory, as runs of a RequestCorpus do, go out as one
+ * iovec, so the batch is written without copying. It is sent one request at a time if any
+ * request is not a GET.
+ * @param rawRequests The wire bytes of each request, in order.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @param onResponse Optional callback run with each response as it is parsed.
+ * @return The number of responses received, which is the number of leading requests that succeeded.
+ */
+size_t HttpClient::processPipeline(
+    const std::vector<std::string_view>& rawRequests,
+    const std::string& ip,
+    const std::string& port,
+    const ResponseHandler& onResponse
+) {
+    if(rawRequests.empty()) return 0;
+    auto isGet = [](std::string_view request) { return http::method::fromString(methodOf(request)) == http::method::Method::GET; };
+    if(!std::all_of(rawRequests.begin(), rawRequests.end(), isGet)) {
+        Logger::getInstance().log("Batch contains non-GET requests, sending sequentially.", Logger::LogLevel::DEBUG);
+        size_t completed = 0;
+        while(completed < rawRequests.size() && processRaw(rawRequests[completed], ip, port)) completed++;
+        return completed;
+    }
+
+    return pipeline(rawRequests.size(), ip, port, [&] {
+        // Rebuilt for every send, as sending consumes the iovecs
+        rawIov.clear();
+        for(std::string_view request : rawRequests) {
+            if(!rawIov.empty() && static_cast<const char*>(rawIov.back().iov_base) + rawIov.back().iov_len == request.data()) {
+                rawIov.back().iov_len += request.size();
+            }
+            else rawIov.push_back({const_cast<char*>(request.data()), request.size()});
+        }
+        return connMgr.sendv(rawIov.data(), static_cast<int>(rawIov.size()));
+    }, nullptr, onResponse);
 }
 
 // Helpers //
 
+/**
+ * @brief Answers a GET from the cache while the stored response is fresh, or fetches it otherwise.
+ * @details A stale response with validators is revalidated with a conditional request. A 304
+ * refreshes it and it is displayed as if it had been sent again. Any other response replaces it.
+ * @param request The GET request.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return `true` if the request was answered, `false` otherwise.
+ */
+bool HttpClient::processCached(const HttpRequest& request, const std::string& ip, const std::string& port) {
+    std::string key = ResponseCache::keyOf(ip, port, request.getURI());
+    const ResponseCache::Entry* entry = cache->lookup(key);
+    if(entry && entry->isFresh(ResponseCache::Clock::now())) {
+        Logger::getInstance().log("Served " + std::string(request.getURI()) + " from cache.", Logger::LogLevel::INFO);
+        if(displayEnabled) {
+            request.display();
+            entry->response.display();
+        }
+        return true;
+    }
+
+    // Stale, so ask the server whether it changed
+    HttpRequest conditional;
+    const HttpRequest* sent = &request;
+    if(entry && entry->hasValidators()) {
+        conditional = request;
+        ResponseCache::addValidators(*entry, conditional);
+        sent = &conditional;
+    }
+
+    return exchange(ip, port, [&] { return sendRequest(*sent); }, sent, true, [&](const ResponseParser& parser) {
+        auto now = ResponseCache::Clock::now();
+        HttpResponse response = parseResponse(parser);
+        if(sent == &conditional && response.getStatus() == http::status::Code::NOT_MODIFIED) {
+            entry = cache->freshen(key, response, now);
+            Logger::getInstance().log("Revalidated " + std::string(request.getURI()) + " in cache.", Logger::LogLevel::INFO);
+            if(displayEnabled) entry->response.display();
+            return;
+        }
+
+        if(displayEnabled) response.display();
+        if(!cache->store(key, std::move(response), now)) cache->remove(key); // Never serve the older one
+    });
+}
+
+/**
+ * @brief Displays a received response if display is enabled.
+ * @param parser The parser holding the received response.
+ */
+void HttpClient::displayResponse(const ResponseParser& parser) const {
+    if(displayEnabled) parseResponse(parser).display(); // Display the formatted response
+}
+
 /**
  * @brief Composes an HTTP request string from an HttpRequest object.
  * @param request The HttpRequest object to compose.
  * @return The serialized HTTP request string.
+ * @note A body file is not included. `sendRequest()` sends requests without this copy.
+ */
+std::string HttpClient::serializeRequest(const HttpRequest& request) {
+    std::string requestData;
+    requestData.reserve(headSize(request) + request.getBody().size());
+    serializeHead(request, requestData);
+    requestData += request.getBody();
+    return requestData;
+}
+
+/**
+ * @brief Appends the request line and headers of a request to a buffer.
+ * @param request The HttpRequest object to compose.
+ * @param out The buffer to append to.
+ * @param bodyLength The length of a body sent separately, added as the Content-Length if the
+ * request does not set one.
  */
-std::string HttpClient::serializeRequest(const HttpRequest& request) const {
+void HttpClient::serializeHead(const HttpRequest& request, std::string& out, std::optional<size_t> bodyLength) {
     // Serialize the request line
-    std::ostringstream requestStream;
-    requestStream << request.getStatusLine() << "\r\n";
+    out += request.getStatusLine();
+    out += "\r\n";
 
     // Serialize the headers
     for(const auto& [key, value] : request.getAllHeaders()) {
-        requestStream << key << ": " << value << "\r\n";
+        out += key;
+        out += ": ";
+        out += value;
+        out += "\r\n";
+    }
+    if(bodyLength && !request.getHeader("Content-Length")) {
+        out += "Content-Length: ";
+        out += std::to_string(*bodyLength);
+        out += "\r\n";
+    }
+    out += "\r\n"; // Blank line between headers and body
+}
+
+/**
+ * @brief Computes the size of a serialized request head, so its buffer can be allocated once.
+ * @param request The HttpRequest object to measure.
+ * @return The size of the request line, headers and blank line.
+ */
+size_t HttpClient::headSize(const HttpRequest& request) noexcept {
+    size_t size = request.getStatusLine().size() + 4; // Both CRLFs
+    for(const auto& [key, value] : request.getAllHeaders()) size += key.size() + value.size() + 4;
+    return size;
+}
+
+/**
+ * @brief Sends a request without copying its body.
+ * @details The head is serialized into a buffer reused across requests. An in-memory body is
+ * sent with it in one `sendmsg()`, and a body file is sent after it with `sendfile()`.
+ * @param request The HttpRequest object to send.
+ * @return `true` if the whole request was sent, `false` otherwise.
+ */
+bool HttpClient::sendRequest(const HttpRequest& request) {
+    headBuffer.clear();
+
+    // In-memory body, sent together with the head
+    const std::string& bodyFile = request.getBodyFile();
+    if(bodyFile.empty()) {
+        serializeHead(request, headBuffer);
+        std::string_view body = request.getBody();
+        struct iovec iov[2] = {
+            {headBuffer.data(), headBuffer.size()},
+            {const_cast<char*>(body.data()), body.size()}
+        };
+        Logger::getInstance().log("Serialized request.", Logger::LogLevel::DEBUG);
+        return connMgr.sendv(iov, body.empty() ? 1 : 2);
     }
-    requestStream << "\r\n"; // Blank line between headers and body
 
-    // Serialize the body if it exists
-    if(!request.getBody().empty()) {
-        requestStream << request.getBody();
+    // File body, sent straight from the page cache
+    int fd = open(bodyFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        Logger::getInstance().log("Failed to open " + bodyFile + ": " + std::strerror(errno), Logger::LogLevel::ERROR);
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+        Logger::getInstance().log("Cannot send " + bodyFile + " as a request body.", Logger::LogLevel::ERROR);
+        close(fd);
+        return false;
     }
 
-    // Return the serialized request
-    return requestStream.str();
+    size_t length = static_cast<size_t>(info.st_size);
+    serializeHead(request, headBuffer, length);
+    Logger::getInstance().log("Serialized request.", Logger::LogLevel::DEBUG);
+    bool sent = false;
+    try {
+        sent = connMgr.send(headBuffer) && connMgr.sendFile(fd, length);
+    }
+    catch(...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+    return sent;
 }
 
 /**
- * @brief Parses an HTTP response string into an HttpResponse object.
- * @param responseData The HTTP response string to parse.
+ * @brief Records the phases of the response just received, if metrics are set, and traces
+ * the request if tracing is on.
+ * @param start When the request started.
+ * @param sent When the request was written.
+ * @param includeConnect Count a connect that happened after `start` toward this request.
+ * @param received Whether a response was received. Failed requests are only traced.
+ * @param traceFlags TraceRing flags known to the caller.
+ */
+void HttpClient::recordTiming(
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point sent,
+    bool includeConnect,
+    bool received,
+    uint16_t traceFlags
+) noexcept {
+    TraceRing& trace = TraceRing::getInstance();
+    if(!metrics && !trace.isEnabled()) return;
+
+    RequestTiming timing = connMgr.getTiming(); // Connect and response points
+    if(!includeConnect || timing.connectStart < start) {
+        timing.connectStart = timing.connected = RequestTiming::Clock::time_point(); // Reused connection
+    }
+    if(!received) timing.clearResponse(); // Any response points are partial or left from an earlier response
+    timing.start = start;
+    timing.sent = sent;
+    if(metrics && received) metrics->record(timing);
+
+    if(trace.isEnabled()) {
+        if(connMgr.isTls()) traceFlags |= TraceRing::TLS;
+        trace.record(timing, received ? &connMgr.getResponse() : nullptr, connMgr.getConnectionId(), traceFlags);
+    }
+}
+
+/**
+ * @brief Connects to the server unless a connection to it is already open or pooled.
+ * @param ip The IP address of the server.
+ * @param port The port number of the server.
+ * @return `true` if connected, `false` otherwise.
+ */
+bool HttpClient::ensureConnected(const std::string& ip, const std::string& port) {
+    if(!connMgr.connect(ip, port)) {
+        Logger::getInstance().log("Failed to connect to " + ip + ":" + port, Logger::LogLevel::ERROR);
+        return false;
+    }
+    Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Connected to " + ip + ":" + port; });
+    return true;
+}
+
+/**
+ * @brief Copies a parsed response into an HttpResponse object for display.
+ * @param parser The parser holding the received response.
  * @return The parsed HttpResponse object.
  */
-HttpResponse HttpClient::parseResponse(const std::string& responseData) const {
+HttpResponse HttpClient::parseResponse(const ResponseParser& parser) const {
     HttpResponse response;
-    if(!response.parse(responseData)) {
+    if(!response.parse(parser)) {
         throw std::runtime_error("Failed to parse HTTP response.");
     }
     return response;
+}
+
+/**
+ * @brief Checks if a request is safe to pipeline.
+ * @param request The request to check.
+ * @return `true` for GET requests, `false` otherwise.
+ * @note HEAD is idempotent too, but its responses carry a Content-Length without a body,
+ * so they cannot be framed without knowing which request they answer.
+ */
+bool HttpClient::isPipelinable(const HttpRequest& request) noexcept {
+    return http::method::fromString(request.getMethod()) == http::method::Method::GET;
+}
+
+/**
+ * @brief Gets the method of a serialized request without parsing the rest of it.
+ * @param rawRequest The request's wire bytes.
+ * @return The request line up to its first space.
+ */
+std::string_view HttpClient::methodOf(std::string_view rawRequest) noexcept {
+    return rawRequest.substr(0, rawRequest.find(' '));
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+/**
+ * @file rate_scheduler.cpp
+ * @brief This file contains the definition of the RateScheduler class.
+ * @details It is responsible for laying out the arrival times and keeping a timerfd armed for the next one.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "event_loop.hpp"
+#include "rate_scheduler.hpp"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+// Constructors //
+
+/**
+ * @brief Constructs a stopped scheduler and registers its timer with the loop.
+ * @param loop The EventLoop that runs the timer. Must outlive the scheduler.
+ * @param rate The mean number of arrivals per second.
+ * @param arrival How arrivals are spaced.
+ * @param seed Seeds the Poisson gaps, so each scheduler of a run should get its own.
+ * @throws std::invalid_argument if the rate is not positive.
+ * @throws std::system_error if the timer cannot be created or registered.
+ */
+RateScheduler::RateScheduler(EventLoop& loop, double rate, Arrival arrival, uint64_t seed)
+    : loop(loop), timer_fd(-1), arrival(arrival), intervalNs(0), random(seed), gaps(1.0), offsetNs(0), running(false)
+{
+    if(!(rate > 0)) throw std::invalid_argument("RateScheduler requires a positive rate.");
+    intervalNs = 1e9 / rate;
+
+    // steady_clock is CLOCK_MONOTONIC, so due times can be armed as they are
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(timer_fd < 0) {
+        throw std::system_error(std::error_code(errno, std::system_category()), "Failed to create timerfd");
+    }
+    try {
+        loop.add(timer_fd, EPOLLIN, [this](uint32_t) { onTimer(); });
+    }
+    catch(...) {
+        close(timer_fd);
+        throw;
+    }
+}
+
+/**
+ * @brief Unregisters and closes the timer.
+ */
+RateScheduler::~RateScheduler() noexcept {
+    loop.remove(timer_fd);
+    close(timer_fd);
+}
+
+// Functions //
+
+/**
+ * @brief Starts the schedule. The first arrival is due now, and is released by the loop's next poll.
+ * @param handler Called with the due time of each arrival, from inside `EventLoop::poll()`.
+ * Returning `false` stops the schedule.
+ */
+void RateScheduler::start(ArrivalHandler handler) {
+    onArrival = std::move(handler);
+    origin = next = Clock::now();
+    offsetNs = 0;
+    running = true;
+    arm();
+}
+
+/**
+ * @brief Stops the schedule. No further arrivals are released.
+ */
+void RateScheduler::stop() noexcept {
+    running = false;
+    struct itimerspec disarmed;
+    std::memset(&disarmed, 0, sizeof(disarmed));
+    timerfd_settime(timer_fd, 0, &disarmed, nullptr);
+}
+
+// Helpers //
+
+/**
+ * @brief Gets the name of an arrival process, as used in reports.
+ * @param arrival The arrival process.
+ * @return The name.
+ */
+const char* RateScheduler::toString(Arrival arrival) noexcept {
+    switch(arrival) {
+        case Arrival::CONSTANT: return "constant";
+        case Arrival::POISSON:  return "poisson";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Releases every arrival that is due, then arms the timer for the next one.
+ */
+void RateScheduler::onTimer() {
+    uint64_t expirations;
+    while(read(timer_fd, &expirations, sizeof(expirations)) > 0) {} // Clears the readiness
+
+    Clock::time_point now = Clock::now();
+    while(running && next <= now) {
+        Clock::time_point due = next;
+        advance();
+        if(!onArrival(due)) {
+            stop();
+            return;
+        }
+    }
+    if(running) arm();
+}
+
+/**
+ * @brief Moves on to the next arrival.
+ */
+void RateScheduler::advance() {
+    offsetNs += (arrival == Arrival::POISSON) ? gaps(random) * intervalNs : intervalNs;
+    next = origin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::nano>(offsetNs));
+}
+
+/**
+ * @brief Arms the timer for the next arrival. One already due fires on the next poll.
+ * @throws std::system_error if the timer cannot be set.
+ */
+void RateScheduler::arm() {
+    auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(next.time_since_epoch()).count();
+    struct itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = since / 1000000000;
+    spec.it_value.tv_nsec = since % 1000000000;
+    if(spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) spec.it_value.tv_nsec = 1; // Zero would disarm it
+
+    if(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+        throw std::system_error(std::error_code(errno, std::system_category()), "Failed to arm timerfd");
+    }
+}
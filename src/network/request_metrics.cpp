@@ -0,0 +1,66 @@
+/**
+ * @file request_metrics.cpp
+ * @brief This file contains the definition of the RequestMetrics class.
+ * @details It collects the phase durations of many requests into latency histograms.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "request_metrics.hpp"
+
+// Functions //
+
+/**
+ * @brief Records the phases of one completed request.
+ * @details A phase is only recorded when both of its points are set, so a reused
+ * connection adds nothing to the connect histogram.
+ * @param timing The timestamps of the request.
+ */
+void RequestMetrics::record(const RequestTiming& timing) noexcept {
+    const RequestTiming::Clock::time_point unset;
+    auto recordPhase = [&](Phase phase, RequestTiming::Clock::time_point from, RequestTiming::Clock::time_point to) {
+        if(from != unset && to != unset) histograms[static_cast<size_t>(phase)].record(to - from);
+    };
+
+    recordPhase(Phase::CONNECT, timing.connectStart, timing.connected);
+    recordPhase(Phase::TTFB, timing.sent, timing.firstByte);
+    recordPhase(Phase::HEADERS, timing.firstByte, timing.headersDone);
+    recordPhase(Phase::BODY, timing.headersDone, timing.complete);
+    recordPhase(Phase::TOTAL, timing.start, timing.complete);
+}
+
+/**
+ * @brief Adds every phase recorded by another RequestMetrics object to this one.
+ * @param other The metrics to add. They may still be recording.
+ */
+void RequestMetrics::merge(const RequestMetrics& other) noexcept {
+    for(size_t i = 0; i < PHASE_COUNT; i++) histograms[i].merge(other.histograms[i]);
+}
+
+/**
+ * @brief Moves every histogram into memory local to the calling thread (see `LatencyHistogram::localize()`).
+ * @note No other thread may read the metrics meanwhile.
+ */
+void RequestMetrics::localize() {
+    for(auto& histogram : histograms) histogram.localize();
+}
+
+// Helpers //
+
+/**
+ * @brief Gets the name of a phase, as used in reports and exports.
+ * @param phase The phase.
+ * @return The phase name.
+ */
+const char* RequestMetrics::toString(Phase phase) noexcept {
+    switch(phase) {
+        case Phase::CONNECT: return "connect";
+        case Phase::TTFB:    return "ttfb";
+        case Phase::HEADERS: return "headers";
+        case Phase::BODY:    return "body";
+        case Phase::TOTAL:   return "total";
+    }
+    return "unknown";
+}
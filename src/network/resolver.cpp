@@ -0,0 +1,247 @@
+/**
+ * @file resolver.cpp
+ * @brief This file contains the definition of the Resolver class.
+ * @details It is responsible for parsing address literals, running host name lookups
+ * in the background and caching their results.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "resolver.hpp"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Constructors //
+
+/**
+ * @brief Constructs the Resolver with an empty cache.
+ */
+Resolver::Resolver() : state(std::make_shared<State>()) {}
+
+// Setters //
+
+/**
+ * @brief Sets how long resolved addresses are used before they are refreshed.
+ * @param ttl_ms The TTL in milliseconds. Entries already cached keep their expiry.
+ */
+void Resolver::setTtl(int ttl_ms) noexcept {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->ttl = std::chrono::milliseconds(ttl_ms);
+}
+
+// Functions //
+
+/**
+ * @brief Resolves a host to the addresses to connect to, in the order to try them.
+ * @details Literals are returned right away. A cached host is returned without waiting, even
+ * past its TTL, in which case a refresh is started. Otherwise this waits for the lookup, which
+ * other threads asking for the same host share.
+ * @param host An IPv4 address, an IPv6 address (optionally in brackets), or a host name.
+ * @param port The port number or service name.
+ * @return The addresses, never empty.
+ * @throws std::runtime_error if the host cannot be resolved.
+ */
+Resolver::Result Resolver::resolve(const std::string& host, const std::string& port) {
+    if(auto literal = parseLiteral(host, port)) return std::make_shared<const AddressList>(1, *literal);
+
+    std::string key = formatAuthority(host, port);
+    std::shared_future<Result> pending;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        Entry& entry = state->entries[key];
+        auto now = Clock::now();
+        if(entry.addresses && now < entry.expires + state->ttl) {
+            // Past its TTL, the old addresses are served while they are refreshed
+            if(now >= entry.expires && !entry.lookup.valid()) entry.lookup = startLookup(state, key, host, port);
+            return entry.addresses;
+        }
+        if(!entry.lookup.valid()) entry.lookup = startLookup(state, key, host, port);
+        pending = entry.lookup;
+    }
+    return pending.get(); // Rethrows the lookup's error
+}
+
+/**
+ * @brief Starts resolving a host in the background, so a later `resolve()` does not wait.
+ * @param host The host to resolve.
+ * @param port The port number or service name.
+ */
+void Resolver::prefetch(const std::string& host, const std::string& port) {
+    if(parseLiteral(host, port)) return;
+
+    std::string key = formatAuthority(host, port);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    Entry& entry = state->entries[key];
+    bool fresh = entry.addresses && Clock::now() < entry.expires;
+    if(!fresh && !entry.lookup.valid()) entry.lookup = startLookup(state, key, host, port);
+}
+
+/**
+ * @brief Drops every cached host. Lookups in flight still store their results.
+ */
+void Resolver::clear() {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->entries.clear();
+}
+
+/**
+ * @brief Parses an IPv4 or IPv6 address literal with a numeric port.
+ * @param host The host, with or without brackets around an IPv6 address.
+ * @param port The port number.
+ * @return The address, or `std::nullopt` if either is not numeric.
+ */
+std::optional<Resolver::Address> Resolver::parseLiteral(const std::string& host, const std::string& port) noexcept {
+    if(port.empty() || port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos) return std::nullopt;
+    unsigned long number = std::strtoul(port.c_str(), nullptr, 10);
+    if(number > 65535) return std::nullopt;
+
+    Address address;
+    std::memset(&address, 0, sizeof(address));
+    bool bracketed = host.size() > 2 && host.front() == '[' && host.back() == ']';
+    if(!bracketed) {
+        auto* ipv4 = reinterpret_cast<struct sockaddr_in*>(&address.storage);
+        if(inet_pton(AF_INET, host.c_str(), &ipv4->sin_addr) == 1) {
+            ipv4->sin_family = AF_INET;
+            ipv4->sin_port = htons(static_cast<uint16_t>(number));
+            address.length = sizeof(struct sockaddr_in);
+            return address;
+        }
+    }
+
+    char text[INET6_ADDRSTRLEN];
+    size_t length = bracketed ? host.size() - 2 : host.size();
+    if(length >= sizeof(text)) return std::nullopt;
+    std::memcpy(text, host.data() + (bracketed ? 1 : 0), length);
+    text[length] = '\0';
+
+    auto* ipv6 = reinterpret_cast<struct sockaddr_in6*>(&address.storage);
+    if(inet_pton(AF_INET6, text, &ipv6->sin6_addr) != 1) return std::nullopt;
+    ipv6->sin6_family = AF_INET6;
+    ipv6->sin6_port = htons(static_cast<uint16_t>(number));
+    address.length = sizeof(struct sockaddr_in6);
+    return address;
+}
+
+/**
+ * @brief Formats a host and port as an HTTP authority (the Host header value).
+ * @param host The host. IPv6 addresses are put in brackets if they are not already.
+ * @param port The port.
+ * @return "host:port", or "[address]:port" for IPv6.
+ */
+std::string Resolver::formatAuthority(const std::string& host, const std::string& port) {
+    bool ipv6 = host.find(':') != std::string::npos && host.front() != '['; // Any colon means it is not empty
+    std::string authority;
+    authority.reserve(host.size() + port.size() + 3);
+    if(ipv6) authority += '[';
+    authority += host;
+    if(ipv6) authority += ']';
+    authority += ':';
+    authority += port;
+    return authority;
+}
+
+// Helpers //
+
+/**
+ * @brief Runs a lookup on a detached thread and stores its result in the cache.
+ * @details The thread holds the cache state, so a lookup still running at exit never touches
+ * a destroyed cache. Must be called with the state's mutex held.
+ * @param state The cache state.
+ * @param key The cache key of the host.
+ * @param host The host to resolve.
+ * @param port The port number or service name.
+ * @return The future result of the lookup.
+ */
+std::shared_future<Resolver::Result> Resolver::startLookup(const std::shared_ptr<State>& state, const std::string& key, const std::string& host, const std::string& port) {
+    std::promise<Result> promise;
+    std::shared_future<Result> future = promise.get_future().share();
+    std::thread([state, key, host, port, promise = std::move(promise)]() mutable {
+        try {
+            Result result = lookup(host, port);
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                Entry& entry = state->entries[key];
+                entry.addresses = result;
+                entry.expires = Clock::now() + state->ttl;
+                entry.lookup = {};
+            }
+            promise.set_value(std::move(result));
+        }
+        catch(...) {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->entries[key].lookup = {}; // A failed refresh keeps the old addresses
+            }
+            promise.set_exception(std::current_exception());
+        }
+    }).detach();
+    return future;
+}
+
+/**
+ * @brief Resolves a host name with `getaddrinfo()`, which blocks.
+ * @details The addresses keep the system's preference order within each family, and the
+ * families are interleaved starting with the preferred one (RFC 8305, section 4).
+ * @param host The host to resolve.
+ * @param port The port number or service name.
+ * @return The addresses, never empty.
+ * @throws std::runtime_error if the lookup fails or returns no addresses.
+ */
+Resolver::Result Resolver::lookup(const std::string& host, const std::string& port) {
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    struct addrinfo* results = nullptr;
+    int status = getaddrinfo(stripBrackets(host).c_str(), port.c_str(), &hints, &results);
+    if(status != 0) {
+        std::string reason = (status == EAI_SYSTEM) ? std::strerror(errno) : gai_strerror(status);
+        throw std::runtime_error("Failed to resolve " + host + ": " + reason);
+    }
+
+    // Split by family, keeping the order within each
+    AddressList preferred, other;
+    for(struct addrinfo* info = results; info; info = info->ai_next) {
+        if(info->ai_addrlen > sizeof(struct sockaddr_storage)) continue;
+        Address address;
+        std::memset(&address, 0, sizeof(address));
+        std::memcpy(&address.storage, info->ai_addr, info->ai_addrlen);
+        address.length = info->ai_addrlen;
+        bool first = preferred.empty() || preferred.front().family() == info->ai_family;
+        (first ? preferred : other).push_back(address);
+    }
+    freeaddrinfo(results);
+    if(preferred.empty()) throw std::runtime_error("Failed to resolve " + host + ": no addresses");
+
+    auto addresses = std::make_shared<AddressList>();
+    addresses->reserve(preferred.size() + other.size());
+    for(size_t i = 0; i < preferred.size() || i < other.size(); i++) {
+        if(i < preferred.size()) addresses->push_back(preferred[i]);
+        if(i < other.size()) addresses->push_back(other[i]);
+    }
+    return addresses;
+}
+
+/**
+ * @brief Removes the brackets around an IPv6 address.
+ * @param host The host.
+ * @return The host without surrounding brackets.
+ */
+std::string Resolver::stripBrackets(const std::string& host) {
+    if(host.size() > 2 && host.front() == '[' && host.back() == ']') return host.substr(1, host.size() - 2);
+    return host;
+}
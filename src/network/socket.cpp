@@ -22,7 +22,8 @@
 #include <cstring>
 #include <stdexcept>
 #include <system_error>
-#include <thread>
+
+std::atomic<uint32_t> Socket::nextId{1}; // 0 means no connection
 
 // Constructors //
 
@@ -34,7 +35,9 @@
  * @throws std::runtime_error if the socket creation fails.
  * @throws std::runtime_error if the socket options cannot be set.
  */
-Socket::Socket(int domain, int type, int protocol) : socket_fd(-1) {
+Socket::Socket(int domain, int type, int protocol)
+    : socket_fd(-1), sendTimeoutMs(DEFAULT_SEND_TIMEOUT_MS), id(nextId.fetch_add(1, std::memory_order_relaxed))
+{
     socket_fd = ::socket(domain, type, protocol);
     if(socket_fd < 0) {
         throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
@@ -52,7 +55,9 @@ Socket::Socket(int domain, int type, int protocol) : socket_fd(-1) {
  * @param socket_fd The existing socket file descriptor.
  * @throws std::runtime_error if the socket file descriptor is invalid.
  */
-Socket::Socket(int socket_fd) : socket_fd(socket_fd) {
+Socket::Socket(int socket_fd)
+    : socket_fd(socket_fd), sendTimeoutMs(DEFAULT_SEND_TIMEOUT_MS), id(nextId.fetch_add(1, std::memory_order_relaxed))
+{
     if(socket_fd < 0) {
         throw std::runtime_error("Invalid socket file descriptor");
     }
@@ -72,7 +77,7 @@ Socket::~Socket() noexcept {
  * @brief Move constructor for the Socket object.
  * @param other The other Socket object to move.
  */
-Socket::Socket(Socket&& other) noexcept : socket_fd(other.socket_fd) {
+Socket::Socket(Socket&& other) noexcept : socket_fd(other.socket_fd), sendTimeoutMs(other.sendTimeoutMs), id(other.id) {
     other.socket_fd = -1;
 }
 
@@ -84,6 +89,8 @@ Socket& Socket::operator=(Socket&& other) noexcept {
     if(this != &other) {
         if(socket_fd >= 0) close(socket_fd);
         socket_fd = other.socket_fd;
+        sendTimeoutMs = other.sendTimeoutMs;
+        id = other.id;
         other.socket_fd = -1;
     }
     return *this;
@@ -125,13 +132,7 @@ void Socket::setNonBlocking(bool enable) {
  * @throws std::runtime_error if the connection fails, times out, or is in an error state.
  */
 void Socket::connect(const struct sockaddr* server_addr, socklen_t addrlen, int timeout_ms) {
-    setNonBlocking(true);
-    
-    int result = ::connect(socket_fd, server_addr, addrlen);
-    if(result == 0) return; // If connection established immediately, keep socket non-blocking
-
-    // Check for EINPROGRESS (connection in progress)
-    if(errno != EINPROGRESS) throw std::runtime_error(std::string(strerror(errno)));
+    if(beginConnect(server_addr, addrlen)) return; // Connection established immediately
 
     // Use poll() to wait for connection or timeout
     struct pollfd pfd;
@@ -152,6 +153,34 @@ void Socket::connect(const struct sockaddr* server_addr, socklen_t addrlen, int
         throw std::runtime_error("Poll error during connect: " + std::string(strerror(errno)));
     }
 
+    finishConnect();
+}
+
+/**
+ * @brief Starts a non-blocking connect without waiting for it to complete.
+ * @details The socket is left in non-blocking mode. When this returns `false`, the caller
+ * waits for writability (with `poll()` or an EventLoop) and then calls `finishConnect()`.
+ * @param server_addr The server address to connect to.
+ * @param addrlen The length of the server address.
+ * @return `true` if the connection was established immediately, `false` if it is in progress.
+ * @throws std::runtime_error if the connection fails immediately.
+ */
+bool Socket::beginConnect(const struct sockaddr* server_addr, socklen_t addrlen) {
+    setNonBlocking(true);
+
+    int result = ::connect(socket_fd, server_addr, addrlen);
+    if(result == 0) return true; // If connection established immediately, keep socket non-blocking
+
+    // Check for EINPROGRESS (connection in progress)
+    if(errno != EINPROGRESS) throw std::runtime_error(std::string(strerror(errno)));
+    return false;
+}
+
+/**
+ * @brief Checks the result of a non-blocking connect once the socket is writable.
+ * @throws std::runtime_error if the connection failed.
+ */
+void Socket::finishConnect() const {
     // Check for completion/error
     int socket_error = 0;
     socklen_t len = sizeof(socket_error);
@@ -175,13 +204,13 @@ void Socket::connect(const struct sockaddr* server_addr, socklen_t addrlen, int
 ssize_t Socket::recv(void* buf, size_t len, int flags) const {
     ssize_t bytesRead = ::recv(socket_fd, buf, len, flags);
     if(bytesRead < 0) {
-        Logger::getInstance().log("recv() returned -1.  errno: " + std::to_string(errno), Logger::LogLevel::DEBUG);
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "recv() returned -1.  errno: " + std::to_string(errno); });
         if(errno != EAGAIN && errno != EWOULDBLOCK) {
             throw std::system_error(std::error_code(errno, std::system_category()), "Failed to receive data");
         }
     } 
     else {
-        Logger::getInstance().log("recv() returned: " + std::to_string(bytesRead), Logger::LogLevel::DEBUG);
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "recv() returned: " + std::to_string(bytesRead); });
     }
     return bytesRead;
 }
@@ -193,22 +222,192 @@ ssize_t Socket::recv(void* buf, size_t len, int flags) const {
  * @param flags The flags to use for the send operation.
  * @return The number of bytes sent.
  * @throws std::system_error if the data cannot be sent.
+ * @throws std::runtime_error if the socket stays full for longer than the send timeout.
  */
 ssize_t Socket::send(const void* buf, size_t len, int flags) const {
     size_t totalSent = 0;
     const char* data = static_cast<const char*>(buf);
     while(totalSent < len) {
         ssize_t bytesSent = ::send(socket_fd, data + totalSent, len - totalSent, flags);
-        Logger::getInstance().log("send() returned: " + std::to_string(bytesSent), Logger::LogLevel::DEBUG);
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "send() returned: " + std::to_string(bytesSent); });
+        if(bytesSent < 0) {
+            Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "send() returned -1. errno: " + std::to_string(errno); });
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                waitWritable(); // Sleep until the kernel has room in the send buffer
+                continue;
+            }
+            throw std::system_error(std::error_code(errno, std::system_category()), "Failed to send data");
+        }
+        totalSent += bytesSent;
+    }
+    return totalSent;
+}
+
+/**
+ * @brief Sends several buffers as one write using `sendmsg()`, without joining them first.
+ * @details Partial writes are resumed from where they stopped, so the entries of `iov` are
+ * advanced in place.
+ * @param iov The buffers to send, in order.
+ * @param iovcnt The number of buffers.
+ * @param flags The flags to use for the send operation.
+ * @return The number of bytes sent.
+ * @throws std::system_error if the data cannot be sent.
+ * @throws std::runtime_error if the socket stays full for longer than the send timeout.
+ */
+size_t Socket::sendv(struct iovec* iov, int iovcnt, int flags) const {
+    size_t totalSent = 0;
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    while(msg.msg_iovlen > 0) {
+        // Skip buffers that are already sent (or empty)
+        if(msg.msg_iov->iov_len == 0) {
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+            continue;
+        }
+
+        ssize_t bytesSent = ::sendmsg(socket_fd, &msg, flags);
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "sendmsg() returned: " + std::to_string(bytesSent); });
         if(bytesSent < 0) {
-            Logger::getInstance().log("send() returned -1. errno: " + std::to_string(errno), Logger::LogLevel::DEBUG);
             if(errno == EAGAIN || errno == EWOULDBLOCK) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Wait before retry
-                continue; // Retry sending for non-fatal errors
+                waitWritable(); // Sleep until the kernel has room in the send buffer
+                continue;
             }
             throw std::system_error(std::error_code(errno, std::system_category()), "Failed to send data");
         }
         totalSent += bytesSent;
+
+        // Advance past what was sent
+        size_t remaining = bytesSent;
+        while(remaining > 0 && remaining >= msg.msg_iov->iov_len) {
+            remaining -= msg.msg_iov->iov_len;
+            msg.msg_iov->iov_len = 0;
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+        }
+        if(remaining > 0) {
+            msg.msg_iov->iov_base = static_cast<char*>(msg.msg_iov->iov_base) + remaining;
+            msg.msg_iov->iov_len -= remaining;
+        }
+    }
+    return totalSent;
+}
+
+/**
+ * @brief Sends part of a file through the socket with `sendfile()`, so it is never copied to user space.
+ * @param in_fd The file to send from.
+ * @param offset The offset in the file to start at.
+ * @param count The number of bytes to send.
+ * @return The number of bytes sent, which is less than `count` only if the file is shorter.
+ * @throws std::system_error if the data cannot be sent.
+ * @throws std::runtime_error if the socket stays full for longer than the send timeout.
+ */
+size_t Socket::sendFile(int in_fd, off_t offset, size_t count) const {
+    size_t totalSent = 0;
+    while(totalSent < count) {
+        ssize_t bytesSent = ::sendfile(socket_fd, in_fd, &offset, count - totalSent);
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "sendfile() returned: " + std::to_string(bytesSent); });
+        if(bytesSent < 0) {
+            if(errno == EAGAIN || errno == EWOULDBLOCK) {
+                waitWritable(); // Sleep until the kernel has room in the send buffer
+                continue;
+            }
+            throw std::system_error(std::error_code(errno, std::system_category()), "Failed to send file");
+        }
+        if(bytesSent == 0) break; // End of file
+        totalSent += bytesSent;
     }
     return totalSent;
+}
+
+/**
+ * @brief Sends as much data as the socket accepts without waiting.
+ * @details Unlike `send()`, this makes a single `send()` call and never retries, so callers
+ * driven by an EventLoop can resume the write once the socket becomes writable again.
+ * @param buf The buffer containing the data.
+ * @param len The length of the buffer.
+ * @param flags The flags to use for the send operation.
+ * @return The number of bytes sent, or -1 if the socket would block.
+ * @throws std::system_error if the data cannot be sent.
+ */
+ssize_t Socket::trySend(const void* buf, size_t len, int flags) const {
+    ssize_t bytesSent = ::send(socket_fd, buf, len, flags);
+    if(bytesSent < 0) {
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "send() returned -1. errno: " + std::to_string(errno); });
+        if(errno != EAGAIN && errno != EWOULDBLOCK) {
+            throw std::system_error(std::error_code(errno, std::system_category()), "Failed to send data");
+        }
+    }
+    return bytesSent;
+}
+
+/**
+ * @brief Moves received data from the socket into a pipe inside the kernel, without copying it to user space.
+ * @details This makes a single `splice()` call that never waits, like `trySend()`.
+ * @param pipe_fd The write end of a pipe.
+ * @param len The maximum number of bytes to move.
+ * @return The number of bytes moved, 0 if the peer closed the connection, or -1 if the socket would block.
+ * @throws std::system_error if the data cannot be spliced.
+ */
+ssize_t Socket::trySplice(int pipe_fd, size_t len) const {
+    ssize_t bytesMoved = ::splice(socket_fd, nullptr, pipe_fd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if(bytesMoved < 0) {
+        Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "splice() returned -1. errno: " + std::to_string(errno); });
+        if(errno != EAGAIN && errno != EWOULDBLOCK) {
+            throw std::system_error(std::error_code(errno, std::system_category()), "Failed to splice data");
+        }
+    }
+    return bytesMoved;
+}
+
+// Helpers //
+
+/**
+ * @brief Waits until the socket can accept more data, using `poll()` on POLLOUT.
+ * @details Called when a send would block. The timeout restarts on every call, so it limits how
+ * long the peer may stop reading rather than how long a large transfer may take.
+ * @throws std::runtime_error if the socket is still full after the send timeout.
+ * @throws std::system_error if `poll()` fails.
+ */
+void Socket::waitWritable() const {
+    waitFor(POLLOUT);
+}
+
+/**
+ * @brief Waits until the socket has data to read, using `poll()` on POLLIN.
+ * @details Called when a send cannot go on until the peer's data is read, as in a TLS
+ * handshake. Uses the send timeout, like `waitWritable()`.
+ * @throws std::runtime_error if nothing arrives within the send timeout.
+ * @throws std::system_error if `poll()` fails.
+ */
+void Socket::waitReadable() const {
+    waitFor(POLLIN);
+}
+
+/**
+ * @brief Waits for the socket to become ready for the specified events, or the send timeout.
+ * @param events The poll events to wait for.
+ * @throws std::runtime_error if the socket is not ready after the send timeout.
+ * @throws std::system_error if `poll()` fails.
+ */
+void Socket::waitFor(short events) const {
+    struct pollfd pfd;
+    pfd.fd = socket_fd;
+    pfd.events = events;
+
+    int poll_result;
+    do {
+        poll_result = poll(&pfd, 1, sendTimeoutMs);
+    } while(poll_result < 0 && errno == EINTR);
+
+    if(poll_result == 0) {
+        throw std::runtime_error("Send timed out");
+    }
+    else if(poll_result < 0) {
+        throw std::system_error(std::error_code(errno, std::system_category()), "Poll error during send");
+    }
+    // POLLERR and POLLHUP fall through, so the next send reports the error
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+/**
+ * @file tls_context.cpp
+ * @brief This file contains the definition of the TlsContext class.
+ * @details It is responsible for configuring OpenSSL, creating TLS connections and
+ * caching the sessions servers hand out.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "logger.hpp"
+#include "resolver.hpp"
+#include "tls_context.hpp"
+
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
+#include <stdexcept>
+
+// Constructors //
+
+/**
+ * @brief Creates the shared `SSL_CTX`.
+ * @details Peer verification is on, TLS 1.2 is the oldest version offered, and the client side
+ * session cache is enabled with OpenSSL's internal store off, so every new session reaches
+ * `onNewSession()` and is kept per server instead of per context.
+ * @throws std::runtime_error if OpenSSL cannot create the context.
+ */
+TlsContext::TlsContext() : context(SSL_CTX_new(TLS_client_method())), ktls(false) {
+    if(!context) throw std::runtime_error("Failed to create TLS context: " + lastError());
+
+    SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+    SSL_CTX_set_verify(context, SSL_VERIFY_PEER, nullptr);
+    if(SSL_CTX_set_default_verify_paths(context) != 1) {
+        Logger::getInstance().log("Failed to load the system CA certificates: " + lastError(), Logger::LogLevel::WARN);
+    }
+
+    // Partial writes let non-blocking sends resume from where they stopped, like send() does.
+    // Servers that close without a close_notify end the stream like a TCP close; message framing
+    // (Content-Length or chunked) still catches a truncated response.
+    SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    SSL_CTX_set_options(context, SSL_OP_IGNORE_UNEXPECTED_EOF);
+
+    static const unsigned char alpn[] = "\x08http/1.1";
+    SSL_CTX_set_alpn_protos(context, alpn, sizeof(alpn) - 1);
+
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, &TlsContext::onNewSession);
+}
+
+/**
+ * @brief Frees the cached sessions and the `SSL_CTX`. Connections still open keep their own reference.
+ */
+TlsContext::~TlsContext() noexcept {
+    sessions.clear();
+    SSL_CTX_free(context);
+}
+
+// Setters //
+
+/**
+ * @brief Sets whether server certificates and host names are verified.
+ * @param enable `false` accepts any certificate, e.g. a self-signed one on a test server.
+ */
+void TlsContext::setVerifyPeer(bool enable) noexcept {
+    SSL_CTX_set_verify(context, enable ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+}
+
+/**
+ * @brief Sets whether the record layer is offloaded to the kernel (kTLS) when possible.
+ * @details OpenSSL enables it per direction after the handshake, only if the kernel has the `tls`
+ * module and supports the negotiated cipher. Connections fall back to user space otherwise.
+ * @param enable `true` to try kTLS on new connections.
+ */
+void TlsContext::setKtls(bool enable) noexcept {
+    ktls = enable;
+    if(enable) SSL_CTX_set_options(context, SSL_OP_ENABLE_KTLS);
+    else SSL_CTX_clear_options(context, SSL_OP_ENABLE_KTLS);
+}
+
+/**
+ * @brief Trusts the CA certificates in a PEM file, in addition to the system store.
+ * @param path The path of the PEM file.
+ * @throws std::runtime_error if the file cannot be loaded.
+ */
+void TlsContext::loadCaFile(const std::string& path) {
+    if(SSL_CTX_load_verify_locations(context, path.c_str(), nullptr) != 1) {
+        throw std::runtime_error("Failed to load CA file " + path + ": " + lastError());
+    }
+}
+
+// Functions //
+
+/**
+ * @brief Creates a TLS connection to a server, offering its cached session if there is one.
+ * @details The server name is sent with SNI and checked against the certificate. IP addresses
+ * are never sent with SNI (RFC 6066), and are checked against the certificate's IP entries.
+ * @param host The host name or IP address of the server.
+ * @param key The server's cache key ("host:port"). New sessions are stored under it, so it must
+ * outlive the connection.
+ * @return The connection, not yet bound to a socket. The caller frees it with `SSL_free()`.
+ * @throws std::runtime_error if OpenSSL cannot create the connection.
+ */
+SSL* TlsContext::newConnection(const std::string& host, const std::string* key) {
+    SSL* ssl = SSL_new(context);
+    if(!ssl) throw std::runtime_error("Failed to create TLS connection: " + lastError());
+    SSL_set_app_data(ssl, const_cast<std::string*>(key));
+
+    bool configured;
+    if(Resolver::parseLiteral(host, "0")) {
+        std::string address = (host.front() == '[') ? host.substr(1, host.size() - 2) : host;
+        configured = X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), address.c_str()) == 1;
+    }
+    else {
+        configured = SSL_set_tlsext_host_name(ssl, host.c_str()) == 1 && SSL_set1_host(ssl, host.c_str()) == 1;
+    }
+    if(!configured) {
+        SSL_free(ssl);
+        throw std::runtime_error("Failed to set the TLS server name " + host + ": " + lastError());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = sessions.find(*key);
+    if(it != sessions.end()) SSL_set_session(ssl, it->second.get()); // Takes its own reference
+    return ssl;
+}
+
+/**
+ * @brief Drops every cached session, so the next connection to each server runs a full handshake.
+ */
+void TlsContext::clearSessions() {
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions.clear();
+}
+
+/**
+ * @brief Takes the oldest error off the thread's OpenSSL error queue and clears the rest.
+ * @return The error text, or "unknown error" if the queue is empty.
+ */
+std::string TlsContext::lastError() {
+    unsigned long code = ERR_get_error();
+    ERR_clear_error();
+    if(code == 0) return "unknown error";
+
+    char text[256];
+    ERR_error_string_n(code, text, sizeof(text));
+    return text;
+}
+
+// Helpers //
+
+/**
+ * @brief Called by OpenSSL with each session a server hands out, during or after the handshake.
+ * @param ssl The connection the session belongs to.
+ * @param session The session, whose reference is taken over.
+ * @return 1, as the session is always kept or freed here.
+ */
+int TlsContext::onNewSession(SSL* ssl, SSL_SESSION* session) {
+    const auto* key = static_cast<const std::string*>(SSL_get_app_data(ssl));
+    if(!key || !SSL_SESSION_is_resumable(session)) {
+        SSL_SESSION_free(session);
+        return 1;
+    }
+    getInstance().storeSession(*key, session);
+    return 1;
+}
+
+/**
+ * @brief Keeps a session as the one to offer the server next, replacing the previous one.
+ * @details Once `MAX_SESSIONS` servers are cached, an arbitrary one is dropped to make room.
+ * @param key The server's cache key.
+ * @param session The session, whose reference is taken over.
+ */
+void TlsContext::storeSession(const std::string& key, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = sessions.find(key);
+    if(it == sessions.end()) {
+        if(sessions.size() >= MAX_SESSIONS) sessions.erase(sessions.begin());
+        sessions.emplace(key, SessionPtr(session));
+    }
+    else {
+        it->second.reset(session);
+    }
+    Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "Cached TLS session for " + key + "."; });
+}
@@ -0,0 +1,330 @@
+/**
+ * @file tls_socket.cpp
+ * @brief This file contains the definition of the TlsSocket class.
+ * @details The TlsSocket class runs TLS over a connected Socket, behind the same
+ * send and receive interface.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "logger.hpp"
+#include "resolver.hpp"
+#include "tls_context.hpp"
+#include "tls_socket.hpp"
+
+#include <openssl/err.h>
+#include <openssl/x509.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+// Constructors //
+
+/**
+ * @brief Takes over a connected socket to run TLS over it. The handshake is not started yet.
+ * @param socket The connected socket, in non-blocking mode.
+ * @param host The host name or IP address of the server, checked against its certificate.
+ * @param port The port of the server.
+ * @throws std::runtime_error if the TLS connection cannot be created.
+ */
+TlsSocket::TlsSocket(Socket&& socket, const std::string& host, const std::string& port)
+    : Socket(std::move(socket)), key(Resolver::formatAuthority(host, port)), ssl(TlsContext::getInstance().newConnection(host, &key)),
+      handshakeDone(false), wantWrite(false), ktlsSend(false), ktlsRecv(false), failed(false)
+{
+    if(SSL_set_fd(ssl, get()) != 1) {
+        SSL_free(ssl);
+        throw std::runtime_error("Failed to attach TLS to the socket: " + TlsContext::lastError());
+    }
+}
+
+/**
+ * @brief Sends a close_notify, without waiting for the server's, and frees the TLS connection.
+ */
+TlsSocket::~TlsSocket() noexcept {
+    if(handshakeDone && !failed) SSL_shutdown(ssl);
+    SSL_free(ssl);
+    ERR_clear_error(); // A failed close_notify must not be reported by the next connection
+}
+
+// Functions //
+
+/**
+ * @brief Runs the handshake to completion, waiting with `poll()`.
+ * @param timeout_ms The time the whole handshake may take, in milliseconds.
+ * @throws std::runtime_error if the handshake fails or times out.
+ */
+void TlsSocket::handshake(int timeout_ms) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while(!tryHandshake()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if(remaining.count() <= 0) throw std::runtime_error("TLS handshake timed out");
+
+        struct pollfd pfd;
+        pfd.fd = get();
+        pfd.events = wantWrite ? POLLOUT : POLLIN;
+        if(poll(&pfd, 1, static_cast<int>(remaining.count())) < 0 && errno != EINTR) {
+            throw std::runtime_error("Poll error during TLS handshake: " + std::string(std::strerror(errno)));
+        }
+    }
+}
+
+/**
+ * @brief Advances the handshake as far as it goes without waiting.
+ * @details When this returns `false`, call it again once the socket is writable if it was
+ * waiting to write, and once data has arrived otherwise. Both edges are registered anyway.
+ * @return `true` once the handshake is complete, `false` if it would block.
+ * @throws std::runtime_error if the handshake fails, e.g. the certificate is not trusted.
+ */
+bool TlsSocket::tryHandshake() {
+    if(handshakeDone) return true;
+
+    int result = SSL_connect(ssl);
+    if(result == 1) {
+        finishHandshake();
+        return true;
+    }
+
+    int error = check(result, "TLS handshake failed");
+    if(error == SSL_ERROR_ZERO_RETURN) {
+        failed = true;
+        throw std::runtime_error("TLS handshake failed: the server closed the connection");
+    }
+    wantWrite = (error == SSL_ERROR_WANT_WRITE);
+    return false;
+}
+
+/**
+ * @brief Receives and decrypts data, never waiting for it.
+ * @param buf The buffer to store the data.
+ * @param len The length of the buffer.
+ * @param flags Unused, TLS has no receive flags.
+ * @return The number of bytes received, 0 if the server closed the connection, or -1 if no
+ * data is available (`errno` is EAGAIN).
+ * @throws std::system_error if the data cannot be received.
+ */
+ssize_t TlsSocket::recv(void* buf, size_t len, int) const {
+    while(true) {
+        size_t bytesRead = 0;
+        int result = SSL_read_ex(ssl, buf, len, &bytesRead);
+        if(result == 1) {
+            Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "SSL_read() returned: " + std::to_string(bytesRead); });
+            return static_cast<ssize_t>(bytesRead);
+        }
+
+        switch(check(result, "Failed to receive data")) {
+            case SSL_ERROR_ZERO_RETURN: return 0;
+            case SSL_ERROR_WANT_WRITE:  waitWritable(); continue; // A key update needs to answer first
+            default:
+                errno = EAGAIN; // Session tickets and other records without data end here too
+                return -1;
+        }
+    }
+}
+
+/**
+ * @brief Encrypts and sends data, waiting whenever the socket is full.
+ * @param buf The buffer containing the data.
+ * @param len The length of the buffer.
+ * @param flags Unused, the process ignores SIGPIPE instead of MSG_NOSIGNAL.
+ * @return The number of bytes sent.
+ * @throws std::system_error if the data cannot be sent.
+ * @throws std::runtime_error if the socket stays full for longer than the send timeout.
+ */
+ssize_t TlsSocket::send(const void* buf, size_t len, int) const {
+    size_t totalSent = 0;
+    const char* data = static_cast<const char*>(buf);
+    while(totalSent < len) {
+        size_t bytesSent = 0;
+        int result = SSL_write_ex(ssl, data + totalSent, len - totalSent, &bytesSent);
+        if(result == 1) {
+            Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "SSL_write() returned: " + std::to_string(bytesSent); });
+            totalSent += bytesSent;
+            continue;
+        }
+
+        switch(check(result, "Failed to send data")) {
+            case SSL_ERROR_WANT_WRITE: waitWritable(); break;
+            case SSL_ERROR_WANT_READ:  waitReadable(); break;
+            default:
+                failed = true;
+                throw std::system_error(std::error_code(EPIPE, std::system_category()), "Failed to send data: the server closed the connection");
+        }
+    }
+    return totalSent;
+}
+
+/**
+ * @brief Encrypts and sends as much data as the socket accepts without waiting.
+ * @details A call that would block must be retried with the same data, as part of it may
+ * already be in an encrypted record.
+ * @param buf The buffer containing the data.
+ * @param len The length of the buffer.
+ * @param flags Unused, the process ignores SIGPIPE instead of MSG_NOSIGNAL.
+ * @return The number of bytes sent, or -1 if the socket would block.
+ * @throws std::system_error if the data cannot be sent.
+ */
+ssize_t TlsSocket::trySend(const void* buf, size_t len, int) const {
+    size_t bytesSent = 0;
+    int result = SSL_write_ex(ssl, buf, len, &bytesSent);
+    if(result == 1) return static_cast<ssize_t>(bytesSent);
+
+    if(check(result, "Failed to send data") == SSL_ERROR_ZERO_RETURN) {
+        failed = true;
+        throw std::system_error(std::error_code(EPIPE, std::system_category()), "Failed to send data: the server closed the connection");
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * @brief Sends several buffers, gathering small ones so they share TLS records.
+ * @details Each write makes at least one record, so small buffers (like a request head and its
+ * body) are copied together first. A buffer of a whole record or more is sent as it is.
+ * @param iov The buffers to send, in order. Entries are emptied as they are sent.
+ * @param iovcnt The number of buffers.
+ * @param flags Unused, the process ignores SIGPIPE instead of MSG_NOSIGNAL.
+ * @return The number of bytes sent.
+ * @throws std::system_error if the data cannot be sent.
+ * @throws std::runtime_error if the socket stays full for longer than the send timeout.
+ */
+size_t TlsSocket::sendv(struct iovec* iov, int iovcnt, int flags) const {
+    char record[RECORD_SIZE];
+    size_t filled = 0;
+    size_t totalSent = 0;
+    for(int i = 0; i < iovcnt; i++) {
+        while(iov[i].iov_len > 0) {
+            char* base = static_cast<char*>(iov[i].iov_base);
+            if(filled == 0 && iov[i].iov_len >= RECORD_SIZE) {
+                totalSent += send(base, iov[i].iov_len, flags);
+                iov[i].iov_len = 0;
+                break;
+            }
+
+            size_t length = std::min(iov[i].iov_len, RECORD_SIZE - filled);
+            std::memcpy(record + filled, base, length);
+            filled += length;
+            iov[i].iov_base = base + length;
+            iov[i].iov_len -= length;
+            if(filled == RECORD_SIZE) {
+                totalSent += send(record, filled, flags);
+                filled = 0;
+            }
+        }
+    }
+    if(filled > 0) totalSent += send(record, filled, flags);
+    return totalSent;
+}
+
+/**
+ * @brief Sends part of a file, with `SSL_sendfile()` when the kernel encrypts (kTLS).
+ * @details Without kTLS the file is read and encrypted one record at a time, so the memory used
+ * stays flat however large it is.
+ * @param in_fd The file to send from.
+ * @param offset The offset in the file to start at.
+ * @param count The number of bytes to send.
+ * @return The number of bytes sent, which is less than `count` only if the file is shorter.
+ * @throws std::system_error if the file cannot be read or sent.
+ * @throws std::runtime_error if the socket stays full for longer than the send timeout.
+ */
+size_t TlsSocket::sendFile(int in_fd, off_t offset, size_t count) const {
+    size_t totalSent = 0;
+    if(ktlsSend) {
+        while(totalSent < count) {
+            ossl_ssize_t bytesSent = SSL_sendfile(ssl, in_fd, offset + totalSent, count - totalSent, 0);
+            Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] { return "SSL_sendfile() returned: " + std::to_string(bytesSent); });
+            if(bytesSent > 0) {
+                totalSent += bytesSent;
+                continue;
+            }
+            if(bytesSent == 0) break; // End of file
+            if(check(static_cast<int>(bytesSent), "Failed to send file") != SSL_ERROR_WANT_WRITE) {
+                failed = true;
+                throw std::system_error(std::error_code(EPIPE, std::system_category()), "Failed to send file: the server closed the connection");
+            }
+            waitWritable();
+        }
+        return totalSent;
+    }
+
+    char record[RECORD_SIZE];
+    while(totalSent < count) {
+        ssize_t bytesRead = pread(in_fd, record, std::min(count - totalSent, RECORD_SIZE), offset + totalSent);
+        if(bytesRead < 0) {
+            if(errno == EINTR) continue;
+            throw std::system_error(std::error_code(errno, std::system_category()), "Failed to read file");
+        }
+        if(bytesRead == 0) break; // End of file
+        totalSent += send(record, bytesRead, 0);
+    }
+    return totalSent;
+}
+
+/**
+ * @brief Moves decrypted data from the socket into a pipe, which needs kTLS to decrypt in the kernel.
+ * @param pipe_fd The write end of a pipe.
+ * @param len The maximum number of bytes to move.
+ * @return The number of bytes moved, 0 if the peer closed the connection, or -1 if the socket would block.
+ * @throws std::system_error if the data cannot be spliced, or `canSplice()` is `false`.
+ */
+ssize_t TlsSocket::trySplice(int pipe_fd, size_t len) const {
+    if(!canSplice()) {
+        throw std::system_error(std::error_code(EOPNOTSUPP, std::system_category()), "Cannot splice TLS data without kTLS");
+    }
+    return Socket::trySplice(pipe_fd, len);
+}
+
+// Helpers //
+
+/**
+ * @brief Classifies the result of a failed OpenSSL call.
+ * @param result The value the call returned.
+ * @param what The message of a thrown error.
+ * @return SSL_ERROR_WANT_READ or SSL_ERROR_WANT_WRITE if the call should be retried once the
+ * socket is ready, or SSL_ERROR_ZERO_RETURN if the server closed the connection.
+ * @throws std::system_error if the call failed. Socket errors keep their `errno`, TLS errors
+ * (like an untrusted certificate) are reported as EPROTO.
+ */
+int TlsSocket::check(int result, const char* what) const {
+    int savedErrno = errno;
+    int error = SSL_get_error(ssl, result);
+    switch(error) {
+        case SSL_ERROR_WANT_READ:
+        case SSL_ERROR_WANT_WRITE:
+        case SSL_ERROR_ZERO_RETURN:
+            return error;
+        case SSL_ERROR_SYSCALL:
+            ERR_clear_error();
+            if(savedErrno == 0) return SSL_ERROR_ZERO_RETURN; // EOF without a close_notify
+            failed = true;
+            throw std::system_error(std::error_code(savedErrno, std::system_category()), what);
+        default: {
+            failed = true;
+            std::string reason = TlsContext::lastError();
+            long verify = SSL_get_verify_result(ssl);
+            if(verify != X509_V_OK) reason = X509_verify_cert_error_string(verify);
+            throw std::system_error(std::error_code(EPROTO, std::system_category()), std::string(what) + ": " + reason);
+        }
+    }
+}
+
+/**
+ * @brief Records what the handshake negotiated.
+ */
+void TlsSocket::finishHandshake() {
+    handshakeDone = true;
+    ktlsSend = BIO_get_ktls_send(SSL_get_wbio(ssl)) == 1;
+    ktlsRecv = BIO_get_ktls_recv(SSL_get_rbio(ssl)) == 1;
+    Logger::getInstance().log(Logger::LogLevel::DEBUG, [&] {
+        std::string kernel = ktlsSend ? (ktlsRecv ? "send and receive" : "send") : (ktlsRecv ? "receive" : "off");
+        return "TLS handshake with " + key + " done: " + SSL_get_version(ssl) + ", " + SSL_get_cipher_name(ssl) +
+               (isResumed() ? ", resumed" : ", full handshake") + ", kTLS " + kernel + ".";
+    });
+}
@@ -0,0 +1,206 @@
+/**
+ * @file trace_ring.cpp
+ * @brief This file contains the definition of the TraceRing class.
+ * @details It is responsible for filling ring slots without locks, and for writing and reading dumps.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "logger.hpp"
+#include "n_utils.hpp"
+#include "response_parser.hpp"
+#include "trace_ring.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+// Constructors //
+
+/**
+ * @brief Constructs a disabled ring with no slots.
+ */
+TraceRing::TraceRing() noexcept
+    : enabled(false), mask(0), next(0), wallOffsetNs(0) {}
+
+// Functions //
+
+/**
+ * @brief Allocates the ring and starts recording.
+ * @param path Where `dump()` writes.
+ * @param capacity The number of records kept, rounded up to a power of two.
+ * @note Must be called before any thread records, and only once.
+ */
+void TraceRing::enable(const std::string& path, size_t capacity) {
+    size_t size = 2;
+    while(size < capacity) size <<= 1;
+    slots = std::make_unique<Slot[]>(size);
+    mask = size - 1;
+    next.store(0, std::memory_order_relaxed);
+
+    auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+    auto steady = std::chrono::duration_cast<std::chrono::nanoseconds>(RequestTiming::Clock::now().time_since_epoch());
+    wallOffsetNs = wall.count() - steady.count();
+
+    this->path = path;
+    enabled.store(true, std::memory_order_release);
+    Logger::getInstance().log("Tracing the last " + std::to_string(size) + " requests to " + path, Logger::LogLevel::DEBUG);
+}
+
+/**
+ * @brief Records a finished or failed request.
+ * @param timing The request's timestamps. An unset `complete` means now.
+ * @param response The parsed response, or `nullptr` if the request failed.
+ * @param connectionId The connection it was sent on, 0 if none was open.
+ * @param flags Flag bits known to the caller, such as TLS or PIPELINED. REUSED, FAILED and
+ * DECODED are worked out here.
+ */
+void TraceRing::record(const RequestTiming& timing, const ResponseParser* response, uint32_t connectionId, uint16_t flags) noexcept {
+    if(!enabled.load(std::memory_order_acquire)) return;
+
+    using TimePoint = RequestTiming::Clock::time_point;
+    auto micros = [](TimePoint from, TimePoint to) -> uint32_t {
+        if(from == TimePoint() || to == TimePoint() || to < from) return 0;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+        return static_cast<uint32_t>(std::min<int64_t>(us, std::numeric_limits<uint32_t>::max()));
+    };
+    TimePoint end = (timing.complete != TimePoint()) ? timing.complete : RequestTiming::Clock::now();
+
+    Record entry{};
+    entry.startNs = toWallNs(timing.start);
+    entry.connectUs = micros(timing.connectStart, timing.connected);
+    entry.firstByteUs = micros(timing.sent, timing.firstByte);
+    entry.totalUs = micros(timing.start, end);
+    entry.connectionId = connectionId;
+    if(timing.connectStart == TimePoint()) flags |= REUSED;
+    if(response) {
+        entry.status = static_cast<uint16_t>(response->getStatus());
+        entry.headerBytes = static_cast<uint32_t>(response->getHeaderSize());
+        entry.bodyBytes = response->getBodyBytes();
+        entry.headerHash = hashHeaders(*response);
+        if(response->isDecoded()) flags |= DECODED;
+    }
+    else flags |= FAILED;
+    entry.flags = flags;
+
+    // Mark the slot busy before touching the record, so a concurrent dump skips it
+    uint64_t sequence = next.fetch_add(1, std::memory_order_relaxed);
+    entry.sequence = sequence;
+    Slot& slot = slots[sequence & mask];
+    slot.stamp.store(BUSY, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = entry;
+    slot.stamp.store(sequence + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Writes the records in the ring to the trace file, oldest first.
+ * @details Safe to call while other threads record. The file is written next to its final
+ * path and renamed over it, so a reader never sees a half written dump.
+ * @return `true` if the file was written, `false` if tracing is off or the write failed.
+ */
+bool TraceRing::dump() const {
+    if(!enabled.load(std::memory_order_acquire)) return false;
+
+    std::vector<Record> records;
+    records.reserve(mask + 1);
+    for(size_t i = 0; i <= mask; i++) {
+        const Slot& slot = slots[i];
+        uint64_t before = slot.stamp.load(std::memory_order_acquire);
+        if(before == 0 || before == BUSY) continue;
+        Record copy = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(slot.stamp.load(std::memory_order_relaxed) != before) continue; // Rewritten while copying
+        records.push_back(copy);
+    }
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.sequence < b.sequence; });
+
+    FileHeader header{};
+    std::memcpy(header.magic, "HTRC", sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.recordSize = sizeof(Record);
+    header.capacity = static_cast<uint32_t>(mask + 1);
+    header.count = static_cast<uint32_t>(records.size());
+    header.written = next.load(std::memory_order_relaxed);
+    header.dumpedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+        if(!file || !file.flush()) {
+            Logger::getInstance().log("Failed to write trace to " + temporary, Logger::LogLevel::WARN);
+            unlink(temporary.c_str());
+            return false;
+        }
+    }
+    if(std::rename(temporary.c_str(), path.c_str()) != 0) {
+        Logger::getInstance().log("Failed to write trace to " + path + ": " + std::strerror(errno), Logger::LogLevel::WARN);
+        unlink(temporary.c_str());
+        return false;
+    }
+    Logger::getInstance().log("Wrote " + std::to_string(records.size()) + " trace records to " + path, Logger::LogLevel::INFO);
+    return true;
+}
+
+/**
+ * @brief Reads a dump back.
+ * @param path The dump file.
+ * @param header Receives the file header.
+ * @param records Receives the records, oldest first.
+ * @return `true` if the file is a complete dump of this format version, `false` otherwise.
+ */
+bool TraceRing::load(const std::string& path, FileHeader& header, std::vector<Record>& records) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if(std::memcmp(header.magic, "HTRC", sizeof(header.magic)) != 0) return false;
+    if(header.version != FORMAT_VERSION || header.recordSize != sizeof(Record)) return false;
+
+    records.resize(header.count);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record))));
+}
+
+/**
+ * @brief Hashes a response's headers, so responses that differ only in their body hash the same.
+ * @details Names are lowercased and Date and Age are skipped, as they change on every response.
+ * @param response The parsed response.
+ * @return The FNV-1a hash of each `name:value\n`, in the order received.
+ */
+uint32_t TraceRing::hashHeaders(const ResponseParser& response) noexcept {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](char c) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    };
+
+    for(size_t i = 0; i < response.getHeaderCount(); i++) {
+        std::string_view name = response.getHeaderName(i);
+        if(n_utils::str_manip::iequals(name, "date") || n_utils::str_manip::iequals(name, "age")) continue;
+        for(char c : name) mix(static_cast<char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c));
+        mix(':');
+        for(char c : response.getHeaderValue(i)) mix(c);
+        mix('\n');
+    }
+    return hash;
+}
+
+// Helpers //
+
+/**
+ * @brief Converts a steady clock time to wall clock nanoseconds since the epoch.
+ * @param point The time, or unset.
+ * @return The wall clock time, or 0 if the time is unset.
+ */
+int64_t TraceRing::toWallNs(RequestTiming::Clock::time_point point) const noexcept {
+    if(point == RequestTiming::Clock::time_point()) return 0;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(point.time_since_epoch()).count() + wallOffsetNs;
+}
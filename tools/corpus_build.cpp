@@ -0,0 +1,173 @@
+/**
+ * @file corpus_build.cpp
+ * @brief This file contains the converter from access logs to request corpora.
+ * @details It reads an access log in the Common or Combined Log Format, or a plain list of
+ * URIs, and writes each request serialized as the client would send it to a corpus for
+ * `client --replay`. Usage: `corpus_build --host <authority> <access.log|-> <corpus>`.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "http_client.hpp"
+#include "http_method.hpp"
+#include "http_request.hpp"
+#include "request_corpus.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Globals the linked objects expect from main.cpp
+volatile std::sig_atomic_t signal_received = 0;
+volatile std::sig_atomic_t metrics_requested = 0;
+
+namespace {
+    // Constants //
+    constexpr const char* DEFAULT_USER_AGENT = "HTTP Client/1.1";
+
+    /**
+     * @brief A request recovered from one log line.
+     */
+    struct LoggedRequest {
+        http::method::Method method = http::method::Method::GET;
+        std::string uri;
+        std::string userAgent;
+    };
+
+    /**
+     * @brief Splits out the double quoted fields of a log line, with backslash escapes removed.
+     * @param line The log line.
+     * @return The contents of each quoted field, in order.
+     */
+    std::vector<std::string> quotedFields(std::string_view line) {
+        std::vector<std::string> fields;
+        bool quoted = false;
+        for(size_t i = 0; i < line.size(); i++) {
+            char c = line[i];
+            if(!quoted) {
+                if(c == '"') {
+                    quoted = true;
+                    fields.emplace_back();
+                }
+                continue;
+            }
+            if(c == '\\' && i + 1 < line.size()) fields.back() += line[++i];
+            else if(c == '"') quoted = false;
+            else fields.back() += c;
+        }
+        return fields;
+    }
+
+    /**
+     * @brief Checks that a logged value can be sent as is, so a damaged line cannot split a request.
+     * @param value The value.
+     * @param allowSpaces Whether spaces may appear, as they may in a header but not in a URI.
+     * @return `true` if it holds no control characters, `false` otherwise.
+     */
+    bool isSendable(std::string_view value, bool allowSpaces) {
+        return std::all_of(value.begin(), value.end(), [allowSpaces](char c) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            return byte >= 0x20 && byte != 0x7f && (allowSpaces || byte != ' ');
+        });
+    }
+
+    /**
+     * @brief Recovers the request of a log line.
+     * @details A line starting with '/' is a URI to GET. Otherwise the first quoted field is the
+     * request line ("GET /index.html HTTP/1.1"), and in the Combined Log Format the third is the
+     * User-Agent. A "-" request line, as logged for connections that sent nothing, is skipped.
+     * @param line The log line.
+     * @param request Receives the request.
+     * @return `true` if the line holds a request with a known method and an origin-form URI, `false` otherwise.
+     */
+    bool parseLine(std::string_view line, LoggedRequest& request) {
+        while(!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+        if(line.empty() || line[0] == '#') return false;
+
+        request = LoggedRequest();
+        if(line[0] == '/') {
+            request.uri = std::string(line.substr(0, line.find(' ')));
+            return isSendable(request.uri, false);
+        }
+
+        std::vector<std::string> fields = quotedFields(line);
+        if(fields.empty()) return false;
+        std::string_view requestLine = fields[0];
+        size_t methodEnd = requestLine.find(' ');
+        if(methodEnd == std::string_view::npos) return false;
+        size_t uriEnd = requestLine.find(' ', methodEnd + 1);
+
+        request.method = http::method::fromString(requestLine.substr(0, methodEnd));
+        request.uri = std::string(requestLine.substr(methodEnd + 1, uriEnd - methodEnd - 1));
+        if(fields.size() >= 3 && fields[2] != "-") request.userAgent = fields[2];
+        return http::method::isValid(request.method) && !request.uri.empty() && request.uri[0] == '/'
+            && isSendable(request.uri, false) && isSendable(request.userAgent, true);
+    }
+}
+
+/**
+ * @brief Converts an access log to a request corpus.
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments: `--host <authority> <access.log|-> <corpus>`.
+ */
+int main(int argc, char* argv[]) {
+    const char* host = nullptr;
+    std::vector<const char*> paths;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) host = argv[++i];
+        else paths.push_back(argv[i]);
+    }
+    if(!host || paths.size() != 2) {
+        std::fprintf(stderr, "Usage: %s --host <authority> <access.log|-> <corpus>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file;
+    std::istream* in = &std::cin;
+    if(std::strcmp(paths[0], "-") != 0) {
+        file.open(paths[0]);
+        if(!file) {
+            std::fprintf(stderr, "Failed to open %s\n", paths[0]);
+            return EXIT_FAILURE;
+        }
+        in = &file;
+    }
+
+    // Every request carries the same headers as a batch run's, so only the logged parts differ
+    RequestCorpus::Writer writer(paths[1]);
+    size_t skipped = 0;
+    std::string line;
+    LoggedRequest logged;
+    while(std::getline(*in, line)) {
+        if(!parseLine(line, logged)) {
+            if(!line.empty() && line[0] != '#') skipped++;
+            continue;
+        }
+
+        HttpRequest request;
+        request.setMethod(logged.method)
+               .setURI(logged.uri)
+               .setHeader("Host", host)
+               .setHeader("User-Agent", logged.userAgent.empty() ? DEFAULT_USER_AGENT : logged.userAgent)
+               .setHeader("Accept", "*/*")
+               .setHeader("Connection", "keep-alive");
+        if(!writer.add(HttpClient::serializeRequest(request))) {
+            std::fprintf(stderr, "Failed to write %s\n", paths[1]);
+            return EXIT_FAILURE;
+        }
+    }
+    size_t written = writer.size();
+    if(!writer.finish()) return EXIT_FAILURE;
+
+    std::printf("Wrote %zu requests to %s, skipped %zu lines.\n", written, paths[1], skipped);
+    return EXIT_SUCCESS;
+}
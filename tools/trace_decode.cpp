@@ -0,0 +1,129 @@
+/**
+ * @file trace_decode.cpp
+ * @brief This file contains the decoder for trace ring dumps.
+ * @details It prints the header of a dump written by `client --trace`, then one line per
+ * request, oldest first. Usage: `trace_decode [--csv] <dump>`.
+ *
+ * @author Noah Nickles
+ * @date 2/23/2025
+ * COP4635 Sys & Net II - Project 2
+ */
+
+#include "trace_ring.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Globals the linked objects expect from main.cpp
+volatile std::sig_atomic_t signal_received = 0;
+volatile std::sig_atomic_t metrics_requested = 0;
+
+namespace {
+    /**
+     * @brief Formats a wall clock time as UTC ISO 8601 with microseconds.
+     * @param ns Nanoseconds since the epoch, or 0.
+     * @return The time, or "-" if it is unset.
+     */
+    std::string formatTime(int64_t ns) {
+        if(ns == 0) return "-";
+        std::time_t seconds = static_cast<std::time_t>(ns / 1000000000);
+        std::tm utc;
+        gmtime_r(&seconds, &utc);
+
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &utc);
+        char out[48];
+        std::snprintf(out, sizeof(out), "%s.%06lldZ", date, static_cast<long long>((ns % 1000000000) / 1000));
+        return out;
+    }
+
+    /**
+     * @brief Spells out a record's flags.
+     * @param flags The flag bits.
+     * @param separator Placed between flag names.
+     * @return The names of the set flags, or "-" if none is set.
+     */
+    std::string formatFlags(uint16_t flags, char separator) {
+        static const struct { uint16_t bit; const char* name; } names[] = {
+            {TraceRing::FAILED, "failed"},
+            {TraceRing::TLS, "tls"},
+            {TraceRing::REUSED, "reused"},
+            {TraceRing::PIPELINED, "pipelined"},
+            {TraceRing::DECODED, "decoded"}
+        };
+
+        std::string out;
+        for(const auto& flag : names) {
+            if(!(flags & flag.bit)) continue;
+            if(!out.empty()) out += separator;
+            out += flag.name;
+        }
+        return out.empty() ? "-" : out;
+    }
+
+    /**
+     * @brief Prints the dump as an aligned table under a summary line.
+     * @param header The file header.
+     * @param records The records, oldest first.
+     */
+    void printText(const TraceRing::FileHeader& header, const std::vector<TraceRing::Record>& records) {
+        std::printf("# dumped %s, %u of %llu records written, capacity %u\n",
+            formatTime(header.dumpedNs).c_str(), header.count, static_cast<unsigned long long>(header.written), header.capacity);
+        std::printf("%-10s %-27s %8s %6s %10s %8s %10s %10s %10s %-8s %s\n",
+            "seq", "start", "conn", "status", "body", "headers", "connect_us", "ttfb_us", "total_us", "hash", "flags");
+        for(const auto& record : records) {
+            std::printf("%-10llu %-27s %8u %6u %10llu %8u %10u %10u %10u %08x %s\n",
+                static_cast<unsigned long long>(record.sequence), formatTime(record.startNs).c_str(), record.connectionId,
+                record.status, static_cast<unsigned long long>(record.bodyBytes), record.headerBytes,
+                record.connectUs, record.firstByteUs, record.totalUs, record.headerHash, formatFlags(record.flags, ',').c_str());
+        }
+    }
+
+    /**
+     * @brief Prints the records as CSV, with raw times for further processing.
+     * @param records The records, oldest first.
+     */
+    void printCsv(const std::vector<TraceRing::Record>& records) {
+        std::printf("sequence,start_ns,connection,status,body_bytes,header_bytes,connect_us,ttfb_us,total_us,header_hash,flags\n");
+        for(const auto& record : records) {
+            std::printf("%llu,%lld,%u,%u,%llu,%u,%u,%u,%u,%08x,%s\n",
+                static_cast<unsigned long long>(record.sequence), static_cast<long long>(record.startNs), record.connectionId,
+                record.status, static_cast<unsigned long long>(record.bodyBytes), record.headerBytes,
+                record.connectUs, record.firstByteUs, record.totalUs, record.headerHash, formatFlags(record.flags, '|').c_str());
+        }
+    }
+}
+
+/**
+ * @brief Decodes a trace dump to standard output.
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments: `[--csv] <dump>`.
+ */
+int main(int argc, char* argv[]) {
+    bool csv = false;
+    const char* path = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--csv") == 0) csv = true;
+        else path = argv[i];
+    }
+    if(!path) {
+        std::fprintf(stderr, "Usage: %s [--csv] <dump>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    TraceRing::FileHeader header;
+    std::vector<TraceRing::Record> records;
+    if(!TraceRing::load(path, header, records)) {
+        std::fprintf(stderr, "%s is not a trace dump of version %u.\n", path, TraceRing::FORMAT_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    if(csv) printCsv(records);
+    else printText(header, records);
+    return EXIT_SUCCESS;
+}